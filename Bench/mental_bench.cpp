@@ -0,0 +1,829 @@
+#include "sdk.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+// Reproducible rendering benchmark. Every scene is generated from a fixed seed with assets
+// written by the benchmark itself, rendered headless for a fixed frame count, and reported
+// as JSON so runs can be diffed across releases.
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+using ObjectList = std::vector<std::shared_ptr<mentalsdk::CMentalObject>>;
+
+const char* const SCENE_NAMES[] = { "triangles", "scripted", "textured", "hierarchy", "materials" };
+const int BENCH_MATERIAL_COUNT = 16; // Distinct images in the materials scene
+
+struct BenchOptions {
+    std::string scene = "all";
+    size_t count = 1000;
+    uint64_t frames = 300;
+    uint64_t warmup = 30;
+    int workers = -1; // -1 picks the hardware default, 0 disables the job system
+    size_t depth = 32; // Chain length of the hierarchy scene
+    uint32_t seed = 1337;
+    bool meshArena = false; // Share vertex/index pools instead of per-object buffers
+    bool batch = false;     // Batched submission, implies the mesh arena
+    bool gpuCulling = false; // Compute frustum and Hi-Z culling, implies batching
+    bool atlas = false;      // Materials scene samples one texture array instead of separate textures
+    size_t sceneLoad = 0;    // Objects in the timed scene file load, 0 skips it
+    int width = mentalsdk::DEFAULT_WINDOW_WIDTH;
+    int height = mentalsdk::DEFAULT_WINDOW_HEIGHT;
+    std::string assets = "mental_bench_assets";
+    std::string output;
+};
+
+struct TimingSummary {
+    double min = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+};
+
+struct SceneResult {
+    std::string name;
+    size_t objects = 0;
+    double setupMs = 0.0;
+    TimingSummary cpuMs;   // World simulate + submit
+    TimingSummary frameMs; // Start of one frame to the start of the next
+    double drawCalls = 0.0;
+    double triangles = 0.0;
+    double stateChanges = 0.0;
+    double savedBinds = 0.0;
+    double culledObjects = 0.0;
+    std::array<int64_t, mentalsdk::GPU_RESOURCE_TYPE_COUNT> gpuMemory{};
+    uint64_t residentBytes = 0;
+};
+
+struct SceneLoadResult {
+    size_t objects = 0;
+    double openMs = 0.0;        // CMentalSceneView::open
+    double instantiateMs = 0.0; // CMentalScene::instantiate, objects in the world and loads requested
+    double finishMs = 0.0;      // Asset manager until every mesh, texture and shader is finalized
+};
+
+double elapsedMs(Clock::time_point start, Clock::time_point end)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Nearest-rank percentiles over the measured frames
+TimingSummary summarize(std::vector<double> samples)
+{
+    TimingSummary summary;
+    if (samples.empty()) {
+        return summary;
+    }
+    std::sort(samples.begin(), samples.end());
+    const auto percentile = [&samples](double fraction) {
+        const size_t rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(samples.size())));
+        return samples[std::min(samples.size() - 1, rank > 0 ? rank - 1 : 0)];
+    };
+    double sum = 0.0;
+    for (const double sample : samples) {
+        sum += sample;
+    }
+    summary.min = samples.front();
+    summary.p50 = percentile(0.50);
+    summary.p90 = percentile(0.90);
+    summary.p99 = percentile(0.99);
+    summary.max = samples.back();
+    summary.mean = sum / static_cast<double>(samples.size());
+    return summary;
+}
+
+uint64_t residentBytes()
+{
+#if defined(__linux__)
+    std::ifstream statm("/proc/self/statm");
+    uint64_t pages = 0;
+    uint64_t resident = 0;
+    if (statm >> pages >> resident) {
+        return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+    return 0;
+}
+
+uint64_t peakResidentBytes()
+{
+#if defined(__linux__) || defined(__APPLE__)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+        return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024U;
+#endif
+    }
+#endif
+    return 0;
+}
+
+bool writeFile(const std::filesystem::path& path, const std::string& contents)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not write benchmark asset: " << path << "\n";
+        return false;
+    }
+    file << contents;
+    return file.good();
+}
+
+// UV sphere with normals and texture coordinates, large enough to show vertex cost
+std::string makeSphereObj(int rings, int segments)
+{
+    const float pi = 3.14159265358979F;
+    std::ostringstream obj;
+    for (int ring = 0; ring <= rings; ++ring) {
+        const float phi = pi * static_cast<float>(ring) / static_cast<float>(rings);
+        for (int segment = 0; segment <= segments; ++segment) {
+            const float theta = 2.0F * pi * static_cast<float>(segment) / static_cast<float>(segments);
+            const float x = std::sin(phi) * std::cos(theta);
+            const float y = std::cos(phi);
+            const float z = std::sin(phi) * std::sin(theta);
+            obj << "v " << x << " " << y << " " << z << "\n";
+            obj << "vn " << x << " " << y << " " << z << "\n";
+            obj << "vt " << static_cast<float>(segment) / static_cast<float>(segments) << " "
+                << 1.0F - static_cast<float>(ring) / static_cast<float>(rings) << "\n";
+        }
+    }
+    for (int ring = 0; ring < rings; ++ring) {
+        for (int segment = 0; segment < segments; ++segment) {
+            const int first = ring * (segments + 1) + segment + 1;
+            const int second = first + segments + 1;
+            obj << "f " << first << "/" << first << "/" << first << " "
+                << second << "/" << second << "/" << second << " "
+                << first + 1 << "/" << first + 1 << "/" << first + 1 << "\n";
+            obj << "f " << second << "/" << second << "/" << second << " "
+                << second + 1 << "/" << second + 1 << "/" << second + 1 << " "
+                << first + 1 << "/" << first + 1 << "/" << first + 1 << "\n";
+        }
+    }
+    return obj.str();
+}
+
+std::string makeCheckerPpm(int size, int cell)
+{
+    std::string image = "P6\n" + std::to_string(size) + " " + std::to_string(size) + "\n255\n";
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            const bool light = ((x / cell) + (y / cell)) % 2 == 0;
+            image.push_back(static_cast<char>(light ? 230 : 40));
+            image.push_back(static_cast<char>(light ? 230 : 90));
+            image.push_back(static_cast<char>(light ? 230 : 160));
+        }
+    }
+    return image;
+}
+
+std::filesystem::path materialPath(const std::filesystem::path& directory, int material)
+{
+    return directory / ("bench_material_" + std::to_string(material) + ".ppm");
+}
+
+bool writeMaterials(const std::filesystem::path& directory)
+{
+    for (int material = 0; material < BENCH_MATERIAL_COUNT; ++material) {
+        if (!writeFile(materialPath(directory, material), makeCheckerPpm(64, 2 + material))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool writeAssets(const std::filesystem::path& directory)
+{
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        std::cerr << "Error: Could not create benchmark asset directory: " << directory << "\n";
+        return false;
+    }
+
+    const std::string vertexShader =
+        "#version 330 core\n"
+        "layout (location = 0) in vec3 aPos;\n"
+        "layout (location = 1) in vec3 aNormal;\n"
+        "layout (location = 2) in vec2 aTexCoord;\n"
+        "uniform mat4 model;\n"
+        "uniform mat4 view;\n"
+        "uniform mat4 projection;\n"
+        "out vec3 normal;\n"
+        "out vec2 texCoord;\n"
+        "void main() {\n"
+        "    normal = mat3(model) * aNormal;\n"
+        "    texCoord = aTexCoord;\n"
+        "    gl_Position = projection * view * model * vec4(aPos, 1.0);\n"
+        "}\n";
+    const std::string instancedVertexShader =
+        "#version 330 core\n"
+        "layout (location = 0) in vec3 aPos;\n"
+        "layout (location = 1) in vec3 aNormal;\n"
+        "layout (location = 2) in vec2 aTexCoord;\n"
+        "layout (location = 3) in mat4 aInstanceModel;\n"
+        "uniform mat4 view;\n"
+        "uniform mat4 projection;\n"
+        "out vec3 normal;\n"
+        "out vec2 texCoord;\n"
+        "void main() {\n"
+        "    normal = mat3(aInstanceModel) * aNormal;\n"
+        "    texCoord = aTexCoord;\n"
+        "    gl_Position = projection * view * aInstanceModel * vec4(aPos, 1.0);\n"
+        "}\n";
+    const std::string colorShader =
+        "#version 330 core\n"
+        "in vec3 normal;\n"
+        "in vec2 texCoord;\n"
+        "out vec4 FragColor;\n"
+        "void main() {\n"
+        "    FragColor = vec4(normalize(normal) * 0.5 + 0.5, 1.0);\n"
+        "}\n";
+    const std::string textureShader =
+        "#version 330 core\n"
+        "in vec3 normal;\n"
+        "in vec2 texCoord;\n"
+        "out vec4 FragColor;\n"
+        "uniform sampler2D texture1;\n"
+        "void main() {\n"
+        "    float light = max(dot(normalize(normal), normalize(vec3(0.3, 0.8, 0.5))), 0.2);\n"
+        "    FragColor = vec4(texture(texture1, texCoord).rgb * light, 1.0);\n"
+        "}\n";
+    const std::string atlasVertexShader =
+        "#version 330 core\n"
+        "layout (location = 0) in vec3 aPos;\n"
+        "layout (location = 1) in vec3 aNormal;\n"
+        "layout (location = 2) in vec2 aTexCoord;\n"
+        "layout (location = 7) in vec4 aInstanceAtlas;\n"
+        "layout (location = 8) in float aInstanceLayer;\n"
+        "uniform mat4 model;\n"
+        "uniform mat4 view;\n"
+        "uniform mat4 projection;\n"
+        "out vec3 normal;\n"
+        "out vec2 texCoord;\n"
+        "flat out vec4 atlasRect;\n"
+        "flat out float atlasLayer;\n"
+        "void main() {\n"
+        "    normal = mat3(model) * aNormal;\n"
+        "    texCoord = aTexCoord;\n"
+        "    atlasRect = aInstanceAtlas;\n"
+        "    atlasLayer = aInstanceLayer;\n"
+        "    gl_Position = projection * view * model * vec4(aPos, 1.0);\n"
+        "}\n";
+    const std::string atlasInstancedVertexShader =
+        "#version 330 core\n"
+        "layout (location = 0) in vec3 aPos;\n"
+        "layout (location = 1) in vec3 aNormal;\n"
+        "layout (location = 2) in vec2 aTexCoord;\n"
+        "layout (location = 3) in mat4 aInstanceModel;\n"
+        "layout (location = 7) in vec4 aInstanceAtlas;\n"
+        "layout (location = 8) in float aInstanceLayer;\n"
+        "uniform mat4 view;\n"
+        "uniform mat4 projection;\n"
+        "out vec3 normal;\n"
+        "out vec2 texCoord;\n"
+        "flat out vec4 atlasRect;\n"
+        "flat out float atlasLayer;\n"
+        "void main() {\n"
+        "    normal = mat3(aInstanceModel) * aNormal;\n"
+        "    texCoord = aTexCoord;\n"
+        "    atlasRect = aInstanceAtlas;\n"
+        "    atlasLayer = aInstanceLayer;\n"
+        "    gl_Position = projection * view * aInstanceModel * vec4(aPos, 1.0);\n"
+        "}\n";
+    const std::string atlasShader =
+        "#version 330 core\n"
+        "in vec3 normal;\n"
+        "in vec2 texCoord;\n"
+        "flat in vec4 atlasRect;\n"
+        "flat in float atlasLayer;\n"
+        "out vec4 FragColor;\n"
+        "uniform sampler2DArray texture1;\n"
+        "void main() {\n"
+        "    float light = max(dot(normalize(normal), normalize(vec3(0.3, 0.8, 0.5))), 0.2);\n"
+        "    vec2 uv = fract(texCoord) * atlasRect.zw + atlasRect.xy;\n"
+        "    FragColor = vec4(textureGrad(texture1, vec3(uv, atlasLayer), dFdx(texCoord) * atlasRect.zw,\n"
+        "                                 dFdy(texCoord) * atlasRect.zw).rgb * light, 1.0);\n"
+        "}\n";
+    const std::string rotateScript =
+        "local angle = 0.0\n"
+        "function init()\n"
+        "    angle = (position.x + position.y) * 0.5\n"
+        "end\n"
+        "function update()\n"
+        "    angle = angle + 0.02\n"
+        "end\n"
+        "function getRotation()\n"
+        "    return angle\n"
+        "end\n";
+
+    return writeFile(directory / "bench_vertex.glsl", vertexShader) &&
+           writeFile(directory / "bench_instanced_vertex.glsl", instancedVertexShader) &&
+           writeFile(directory / "bench_color.glsl", colorShader) &&
+           writeFile(directory / "bench_texture.glsl", textureShader) &&
+           writeFile(directory / "bench_atlas_vertex.glsl", atlasVertexShader) &&
+           writeFile(directory / "bench_atlas_instanced_vertex.glsl", atlasInstancedVertexShader) &&
+           writeFile(directory / "bench_atlas.glsl", atlasShader) &&
+           writeFile(directory / "bench_rotate.lua", rotateScript) &&
+           writeFile(directory / "bench_sphere.obj", makeSphereObj(24, 48)) &&
+           writeFile(directory / "bench_checker.ppm", makeCheckerPpm(256, 32)) &&
+           writeMaterials(directory);
+}
+
+// Spreads objects over a slab in front of the default camera so most of them are visible
+glm::vec3 randomPosition(std::mt19937& random)
+{
+    std::uniform_real_distribution<float> lateral(-1.0F, 1.0F);
+    std::uniform_real_distribution<float> depth(-20.0F, -1.0F);
+    const float z = depth(random);
+    const float reach = (3.0F - z) * 0.4F;
+    return { lateral(random) * reach * 1.3F, lateral(random) * reach, z };
+}
+
+ObjectList buildScene(const std::string& scene, const BenchOptions& options, const std::filesystem::path& assets,
+                      const std::shared_ptr<mentalsdk::CMentalMeshArena>& meshArena, mentalsdk::CMentalWorld& world)
+{
+    std::mt19937 random(options.seed);
+    const bool batch = options.batch || options.gpuCulling;
+    const std::string vertex = (assets / (batch ? "bench_instanced_vertex.glsl" : "bench_vertex.glsl")).string();
+    const bool spheres = scene == "textured" || scene == "materials";
+    ObjectList objects;
+    objects.reserve(options.count);
+
+    // Every object shares one program, mesh and texture per kind, loaded in parallel
+    mentalsdk::CMentalAssetManager assetManager(world.getJobSystem());
+    const auto colorShader = assetManager.load<mentalsdk::CMentalShader>(vertex, { (assets / "bench_color.glsl").string() });
+    const auto textureShader = assetManager.load<mentalsdk::CMentalShader>(vertex, { (assets / "bench_texture.glsl").string() });
+    mentalsdk::CMentalAssetHandle<mentalsdk::CMentalShader> atlasShader;
+    mentalsdk::CMentalAssetHandle<mentalsdk::CMentalMeshData> sphere;
+    mentalsdk::CMentalAssetHandle<mentalsdk::CMentalTexture> checker;
+    if (scene == "materials" && options.atlas) {
+        atlasShader = assetManager.load<mentalsdk::CMentalShader>(
+            (assets / (batch ? "bench_atlas_instanced_vertex.glsl" : "bench_atlas_vertex.glsl")).string(), { (assets / "bench_atlas.glsl").string() });
+    }
+    if (spheres) {
+        sphere = assetManager.load<mentalsdk::CMentalMeshData>((assets / "bench_sphere.obj").string());
+    }
+    if (scene == "textured") {
+        checker = assetManager.load<mentalsdk::CMentalTexture>((assets / "bench_checker.ppm").string());
+    }
+    std::vector<mentalsdk::CMentalAssetHandle<mentalsdk::CMentalTexture>> materials;
+    if (scene == "materials" && !options.atlas) {
+        for (int material = 0; material < BENCH_MATERIAL_COUNT; ++material) {
+            materials.push_back(assetManager.load<mentalsdk::CMentalTexture>(materialPath(assets, material).string()));
+        }
+    }
+    assetManager.finish();
+
+    // Materials scene with --atlas: every image in one texture array, so the scene stays one batch
+    std::shared_ptr<mentalsdk::CMentalTextureAtlas> atlas = nullptr;
+    std::vector<mentalsdk::CMentalAtlasRegion> regions;
+    if (scene == "materials" && options.atlas) {
+        atlas = std::make_shared<mentalsdk::CMentalTextureAtlas>();
+        if (atlas->create(false, mentalsdk::TEXTURE_ATLAS_PAGE_SIZE, 1)) {
+            for (int material = 0; material < BENCH_MATERIAL_COUNT; ++material) {
+                regions.push_back(atlas->addFile(materialPath(assets, material).string()));
+            }
+        }
+    }
+
+    for (size_t index = 0; index < options.count; ++index) {
+        std::shared_ptr<mentalsdk::CMentalObject> object;
+        if (spheres) {
+            object = std::make_shared<mentalsdk::CMentalObject>("Sphere", mentalsdk::CMentalObjectType::ObjModel);
+            if (const auto mesh = sphere.get()) {
+                object->setMesh(*mesh);
+            }
+        } else {
+            object = mentalsdk::CMentalObject::createTriangle("Triangle");
+        }
+
+        if (scene == "textured") {
+            object->setShader(textureShader.get());
+            object->setTexture(checker.get());
+        } else if (scene == "materials") {
+            const auto material = static_cast<size_t>(index % BENCH_MATERIAL_COUNT);
+            if (atlas) {
+                object->setShader(atlasShader.get());
+                object->setAtlasTexture(atlas, regions[material]);
+            } else {
+                object->setShader(textureShader.get());
+                object->setTexture(materials[material].get());
+            }
+        } else {
+            object->setShader(colorShader.get());
+        }
+        if (meshArena) {
+            object->setMeshArena(meshArena);
+        }
+        if (scene == "scripted") {
+            object->connectScript((assets / "bench_rotate.lua").string());
+        }
+
+        object->setPosition(randomPosition(random));
+        object->setScale(glm::vec3(spheres ? 0.15F : 0.1F));
+        object->setStatic(scene == "triangles" || spheres);
+
+        // Hierarchy scene: chains of `depth` nodes linked through setNext. Only the roots are
+        // world nodes; the world reaches and draws the rest through the links
+        if (scene == "hierarchy" && index % std::max<size_t>(options.depth, 1) != 0) {
+            objects.back()->setNext(object);
+        } else {
+            world.setNode("bench_" + std::to_string(index), object);
+        }
+        objects.push_back(object);
+    }
+    return objects;
+}
+
+SceneResult runScene(const std::string& scene, const BenchOptions& options, const std::filesystem::path& assets,
+                     mentalsdk::CMentalWindow<mentalsdk::CMentalRenderer>& window,
+                     const std::shared_ptr<mentalsdk::CMentalJobSystem>& jobSystem)
+{
+    SceneResult result;
+    result.name = scene;
+
+    const auto setupStart = Clock::now();
+    auto world = std::make_shared<mentalsdk::CMentalWorld>();
+    world->setJobSystem(jobSystem);
+    auto environment = std::make_shared<mentalsdk::CMentalEnvironment>();
+    environment->setColor(0.1F, 0.1F, 0.12F, 1.0F);
+    world->setEnvironment(environment);
+
+    const bool batch = options.batch || options.gpuCulling;
+    auto meshArena = options.meshArena || batch ? std::make_shared<mentalsdk::CMentalMeshArena>() : nullptr;
+    std::shared_ptr<mentalsdk::CMentalBatchRenderer> batchRenderer = nullptr;
+    if (batch) {
+        batchRenderer = std::make_shared<mentalsdk::CMentalBatchRenderer>();
+        batchRenderer->initialize(std::max<size_t>(options.count, mentalsdk::BATCH_INSTANCE_BUDGET));
+        batchRenderer->setGpuCulling(options.gpuCulling);
+        world->setBatchRenderer(batchRenderer);
+    }
+    ObjectList objects = buildScene(scene, options, assets, meshArena, *world);
+    result.objects = objects.size();
+    result.setupMs = elapsedMs(setupStart, Clock::now());
+
+    std::vector<double> cpuSamples;
+    std::vector<double> frameSamples;
+    cpuSamples.reserve(options.frames);
+    frameSamples.reserve(options.frames);
+    uint64_t frame = 0;
+    Clock::time_point previousStart;
+    double previousCpuMs = 0.0;
+    mentalsdk::CMentalStats& stats = mentalsdk::CMentalStats::instance();
+
+    auto renderer = std::make_shared<mentalsdk::CMentalRenderer>();
+    renderer->addCommandToPool([&]() {
+        // Every series describes the previous frame: its counters were snapshotted when it was
+        // presented and its frame time ends here, so all of them cover the same frames
+        if (frame > options.warmup) {
+            const mentalsdk::CMentalFrameStats last = stats.getLastFrame();
+            result.drawCalls += static_cast<double>(last.drawCalls);
+            result.triangles += static_cast<double>(last.triangles);
+            result.stateChanges += static_cast<double>(last.stateChanges);
+            result.savedBinds += static_cast<double>(last.savedBinds);
+            result.culledObjects += static_cast<double>(last.culledObjects);
+        }
+
+        const auto start = Clock::now();
+        if (frame > options.warmup) {
+            frameSamples.push_back(elapsedMs(previousStart, start));
+            cpuSamples.push_back(previousCpuMs);
+        }
+        previousStart = start;
+
+        world->render();
+
+        previousCpuMs = elapsedMs(start, Clock::now());
+        ++frame;
+    });
+    window.setRenderPool(renderer);
+    window.setFrameLimit(options.warmup + options.frames + 1); // The last frame only closes the one before it
+    window.run();
+    glFinish();
+
+    const auto counted = static_cast<double>(std::max<size_t>(frameSamples.size(), 1));
+    result.drawCalls /= counted;
+    result.triangles /= counted;
+    result.stateChanges /= counted;
+    result.savedBinds /= counted;
+    result.culledObjects /= counted;
+    result.cpuMs = summarize(cpuSamples);
+    result.frameMs = summarize(frameSamples);
+    for (size_t resource = 0; resource < mentalsdk::GPU_RESOURCE_TYPE_COUNT; ++resource) {
+        result.gpuMemory[resource] = stats.getGpuMemory(static_cast<mentalsdk::MentalGpuResource>(resource));
+    }
+    result.residentBytes = residentBytes();
+
+    window.setRenderPool(nullptr);
+    for (const auto& object : objects) {
+        object->cleanup();
+    }
+    if (batchRenderer) {
+        batchRenderer->destroy();
+    }
+    if (meshArena) {
+        meshArena->destroy();
+    }
+    return result;
+}
+
+// Writes a scene file of static spheres over the generated assets, then times opening it,
+// instantiating it into a world that is never rendered and finishing its asset loads
+SceneLoadResult runSceneLoad(const BenchOptions& options, const std::filesystem::path& assets,
+                             const std::shared_ptr<mentalsdk::CMentalJobSystem>& jobSystem)
+{
+    const std::filesystem::path path = assets / "bench_scene.mscn";
+    {
+        mentalsdk::CMentalSceneWriter writer;
+        const uint32_t shader = writer.addResource(mentalsdk::SceneShader, (assets / "bench_vertex.glsl").string(),
+                                                   (assets / "bench_texture.glsl").string());
+        const uint32_t mesh = writer.addResource(mentalsdk::SceneMesh, (assets / "bench_sphere.obj").string());
+        std::mt19937 random(options.seed);
+        for (size_t index = 0; index < options.sceneLoad; ++index) {
+            mentalsdk::CMentalSceneObject object;
+            object.name = writer.addString("Object" + std::to_string(index));
+            object.node = object.name;
+            object.type = mentalsdk::ObjModel;
+            object.flags = mentalsdk::SCENE_OBJECT_STATIC;
+            const glm::vec3 position = randomPosition(random);
+            std::copy(&position.x, &position.x + 3, object.position);
+            std::fill(object.scale, object.scale + 3, 0.05F);
+            object.mesh = mesh;
+            object.texture = writer.addResource(mentalsdk::SceneTexture,
+                                                materialPath(assets, static_cast<int>(index % BENCH_MATERIAL_COUNT)).string(), {},
+                                                GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+            object.shader = shader;
+            writer.addObject(object);
+        }
+        if (!writer.write(path.string())) {
+            throw std::runtime_error("could not write " + path.string());
+        }
+    }
+
+    SceneLoadResult result;
+    const auto openStart = Clock::now();
+    mentalsdk::CMentalSceneView view;
+    if (!view.open(path.string())) {
+        throw std::runtime_error("could not open " + path.string());
+    }
+    const auto instantiateStart = Clock::now();
+    mentalsdk::CMentalWorld world;
+    mentalsdk::CMentalAssetManager assetManager(jobSystem);
+    mentalsdk::CMentalSceneInstance instance;
+    mentalsdk::CMentalScene::instantiate(view, world, assetManager, instance, 0, false);
+    world.applyNodeChanges(); // What the next frame boundary would do
+    const auto finishStart = Clock::now();
+    assetManager.finish();
+    const auto end = Clock::now();
+
+    result.objects = instance.objects.size();
+    result.openMs = elapsedMs(openStart, instantiateStart);
+    result.instantiateMs = elapsedMs(instantiateStart, finishStart);
+    result.finishMs = elapsedMs(finishStart, end);
+    for (const auto& object : instance.objects) {
+        object->cleanup();
+    }
+    mentalsdk::CMentalScene::remove(world, instance);
+    return result;
+}
+
+void writeSummary(std::ostream& stream, const char* name, const TimingSummary& summary)
+{
+    stream << "\"" << name << "\": {\"min\": " << summary.min << ", \"p50\": " << summary.p50
+           << ", \"p90\": " << summary.p90 << ", \"p99\": " << summary.p99
+           << ", \"max\": " << summary.max << ", \"mean\": " << summary.mean << "}";
+}
+
+void writeReport(std::ostream& stream, const BenchOptions& options, size_t workers, const std::vector<SceneResult>& results,
+                 const SceneLoadResult& sceneLoad)
+{
+    const auto* glRenderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    const auto* glVersion = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    stream << "{\n";
+    stream << "  \"frames\": " << options.frames << ",\n";
+    stream << "  \"warmup\": " << options.warmup << ",\n";
+    stream << "  \"count\": " << options.count << ",\n";
+    stream << "  \"seed\": " << options.seed << ",\n";
+    stream << "  \"resolution\": [" << options.width << ", " << options.height << "],\n";
+    stream << "  \"threads\": " << workers << ",\n";
+    const bool batch = options.batch || options.gpuCulling;
+    stream << "  \"mesh_arena\": " << (options.meshArena || batch ? "true" : "false") << ",\n";
+    stream << "  \"batch\": " << (batch ? "true" : "false") << ",\n";
+    stream << "  \"atlas\": " << (options.atlas ? "true" : "false") << ",\n";
+    stream << "  \"gpu_culling\": " << (options.gpuCulling && mentalsdk::CMentalGpuCuller::isSupported() ? "true" : "false") << ",\n";
+    stream << "  \"multi_draw_indirect\": " << (GLEW_VERSION_4_3 || (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance) ? "true" : "false") << ",\n";
+    stream << "  \"gl_renderer\": \"" << (glRenderer != nullptr ? glRenderer : "unknown") << "\",\n";
+    stream << "  \"gl_version\": \"" << (glVersion != nullptr ? glVersion : "unknown") << "\",\n";
+    stream << "  \"peak_resident_bytes\": " << peakResidentBytes() << ",\n";
+    if (options.sceneLoad > 0) {
+        stream << "  \"scene_load\": {\"objects\": " << sceneLoad.objects << ", \"open_ms\": " << sceneLoad.openMs
+               << ", \"instantiate_ms\": " << sceneLoad.instantiateMs << ", \"finish_ms\": " << sceneLoad.finishMs << "},\n";
+    }
+    stream << "  \"scenes\": [\n";
+    for (size_t index = 0; index < results.size(); ++index) {
+        const SceneResult& result = results[index];
+        stream << "    {\n";
+        stream << "      \"name\": \"" << result.name << "\",\n";
+        stream << "      \"objects\": " << result.objects << ",\n";
+        stream << "      \"setup_ms\": " << result.setupMs << ",\n";
+        stream << "      ";
+        writeSummary(stream, "cpu_ms", result.cpuMs);
+        stream << ",\n      ";
+        writeSummary(stream, "frame_ms", result.frameMs);
+        stream << ",\n";
+        stream << "      \"draw_calls\": " << result.drawCalls << ",\n";
+        stream << "      \"triangles\": " << result.triangles << ",\n";
+        stream << "      \"state_changes\": " << result.stateChanges << ",\n";
+        stream << "      \"saved_binds\": " << result.savedBinds << ",\n";
+        stream << "      \"culled_objects\": " << result.culledObjects << ",\n";
+        stream << "      \"resident_bytes\": " << result.residentBytes << ",\n";
+        stream << "      \"gpu_bytes\": {";
+        for (size_t resource = 0; resource < mentalsdk::GPU_RESOURCE_TYPE_COUNT; ++resource) {
+            stream << (resource == 0 ? "" : ", ") << "\""
+                   << mentalsdk::gpuResourceName(static_cast<mentalsdk::MentalGpuResource>(resource)) << "\": "
+                   << result.gpuMemory[resource];
+        }
+        stream << "}\n";
+        stream << "    }" << (index + 1 < results.size() ? "," : "") << "\n";
+    }
+    stream << "  ]\n}\n";
+}
+
+void printUsage()
+{
+    std::cout << "Usage: mental_bench [options]\n"
+                 "  --scene NAME     triangles, scripted, textured, hierarchy, materials or all (default all)\n"
+                 "  --count N        objects per scene (default 1000)\n"
+                 "  --frames N       measured frames (default 300)\n"
+                 "  --warmup N       unmeasured frames before measuring (default 30)\n"
+                 "  --workers N      job system workers, 0 runs single-threaded (default hardware)\n"
+                 "  --depth N        chain length for the hierarchy scene (default 32)\n"
+                 "  --seed N         scene layout seed (default 1337)\n"
+                 "  --arena 0|1      draw from the shared mesh arena (default 0)\n"
+                 "  --batch 0|1      batched submission through the mesh arena (default 0)\n"
+                 "  --atlas 0|1      materials scene samples one texture array (default 0)\n"
+                 "  --gpu-cull 0|1   compute frustum and Hi-Z occlusion culling, implies --batch (default 0)\n"
+                 "  --scene-load N   also time opening and instantiating a scene file of N objects (default 0)\n"
+                 "  --size WxH       offscreen resolution (default 800x600)\n"
+                 "  --assets DIR     where generated assets are written (default mental_bench_assets)\n"
+                 "  --output FILE    write the JSON report to FILE instead of stdout\n";
+}
+
+bool parseOptions(int argc, char** argv, BenchOptions& options)
+{
+    for (int index = 1; index < argc; ++index) {
+        const std::string argument = argv[index];
+        const bool hasValue = index + 1 < argc;
+        if (argument == "--help" || argument == "-h") {
+            printUsage();
+            return false;
+        }
+        if (!hasValue) {
+            std::cerr << "Error: Missing value for " << argument << "\n";
+            return false;
+        }
+        const std::string value = argv[++index];
+        if (argument == "--scene") {
+            options.scene = value;
+        } else if (argument == "--count") {
+            options.count = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (argument == "--frames") {
+            options.frames = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (argument == "--warmup") {
+            options.warmup = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (argument == "--workers") {
+            options.workers = std::atoi(value.c_str());
+        } else if (argument == "--depth") {
+            options.depth = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (argument == "--seed") {
+            options.seed = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (argument == "--arena") {
+            options.meshArena = std::atoi(value.c_str()) != 0;
+        } else if (argument == "--gpu-cull") {
+            options.gpuCulling = std::atoi(value.c_str()) != 0;
+        } else if (argument == "--atlas") {
+            options.atlas = std::atoi(value.c_str()) != 0;
+        } else if (argument == "--scene-load") {
+            options.sceneLoad = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (argument == "--batch") {
+            options.batch = std::atoi(value.c_str()) != 0;
+        } else if (argument == "--size") {
+            if (std::sscanf(value.c_str(), "%dx%d", &options.width, &options.height) != 2 ||
+                options.width <= 0 || options.height <= 0) {
+                std::cerr << "Error: Invalid size " << value << "\n";
+                return false;
+            }
+        } else if (argument == "--assets") {
+            options.assets = value;
+        } else if (argument == "--output") {
+            options.output = value;
+        } else {
+            std::cerr << "Error: Unknown option " << argument << "\n";
+            printUsage();
+            return false;
+        }
+    }
+    if (options.frames == 0) {
+        std::cerr << "Error: --frames must be positive\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    std::vector<std::string> scenes;
+    for (const char* name : SCENE_NAMES) {
+        if (options.scene == "all" || options.scene == name) {
+            scenes.emplace_back(name);
+        }
+    }
+    if (scenes.empty()) {
+        std::cerr << "Error: Unknown scene " << options.scene << "\n";
+        return 1;
+    }
+
+    const std::filesystem::path assets(options.assets);
+    if (!writeAssets(assets)) {
+        return 1;
+    }
+
+    try {
+        mentalsdk::CMentalWindow<mentalsdk::CMentalRenderer> window(mentalsdk::MentalWindowMode::Headless,
+                                                                    options.width, options.height);
+        mentalsdk::CMentalProfiler::instance().setEnabled(false);
+
+        std::shared_ptr<mentalsdk::CMentalJobSystem> jobSystem = nullptr;
+        if (options.workers != 0) {
+            jobSystem = std::make_shared<mentalsdk::CMentalJobSystem>(options.workers > 0 ? static_cast<size_t>(options.workers) : 0);
+        }
+
+        // Engine logging goes to stderr while running so stdout carries only the report
+        std::vector<SceneResult> results;
+        SceneLoadResult sceneLoad;
+        std::streambuf* standardOutput = std::cout.rdbuf(std::cerr.rdbuf());
+        try {
+            if (options.sceneLoad > 0) {
+                std::cerr << "Loading a scene file with " << options.sceneLoad << " objects\n";
+                sceneLoad = runSceneLoad(options, assets, jobSystem);
+            }
+            for (const std::string& scene : scenes) {
+                std::cerr << "Running scene '" << scene << "' with " << options.count << " objects\n";
+                results.push_back(runScene(scene, options, assets, window, jobSystem));
+            }
+        } catch (...) {
+            std::cout.rdbuf(standardOutput);
+            throw;
+        }
+        std::cout.rdbuf(standardOutput);
+
+        const size_t threads = jobSystem ? jobSystem->getThreadCount() : 1;
+        if (options.output.empty()) {
+            writeReport(std::cout, options, threads, results, sceneLoad);
+        } else {
+            std::ofstream file(options.output);
+            if (!file.is_open()) {
+                std::cerr << "Error: Could not write benchmark report: " << options.output << "\n";
+                return 1;
+            }
+            writeReport(file, options, threads, results, sceneLoad);
+            std::cerr << "Benchmark report written: " << options.output << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
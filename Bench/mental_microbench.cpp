@@ -0,0 +1,248 @@
+#include "sdk.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Isolated hot-path benchmarks. Everything here runs on the CPU only, except the shader
+// uniform case which needs a headless context; draws are never issued, so GPU time does
+// not leak into the numbers.
+
+namespace
+{
+
+using ObjectList = std::vector<std::shared_ptr<mentalsdk::CMentalObject>>;
+
+const uint32_t MICROBENCH_SEED = 1337;
+
+// Plain objects without GL buffers, transforms spread so every matrix is different
+ObjectList makeObjects(size_t count)
+{
+    std::mt19937 random(MICROBENCH_SEED);
+    std::uniform_real_distribution<float> position(-50.0F, 50.0F);
+    std::uniform_real_distribution<float> angle(-3.14F, 3.14F);
+    std::uniform_real_distribution<float> scale(0.5F, 2.0F);
+
+    ObjectList objects;
+    objects.reserve(count);
+    for (size_t index = 0; index < count; ++index) {
+        auto object = std::make_shared<mentalsdk::CMentalObject>("Node " + std::to_string(index));
+        object->setPosition(glm::vec3(position(random), position(random), position(random)));
+        object->setRotation(glm::vec3(angle(random), angle(random), angle(random)));
+        object->setScale(glm::vec3(scale(random)));
+        objects.push_back(std::move(object));
+    }
+    return objects;
+}
+
+std::string writeRotateScript()
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "mental_microbench_rotate.lua";
+    std::ofstream file(path);
+    file << "local angle = 0.0\n"
+            "function update()\n"
+            "    angle = angle + 0.01\n"
+            "end\n"
+            "function getRotation()\n"
+            "    return angle\n"
+            "end\n";
+    return path.string();
+}
+
+// One headless context shared by every benchmark that needs GL, created on first use
+bool ensureGlContext()
+{
+    static std::unique_ptr<mentalsdk::CMentalWindow<mentalsdk::CMentalRenderer>> window;
+    static bool attempted = false;
+    if (!attempted) {
+        attempted = true;
+        try {
+            window = std::make_unique<mentalsdk::CMentalWindow<mentalsdk::CMentalRenderer>>(mentalsdk::MentalWindowMode::Headless);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+        }
+    }
+    return window != nullptr;
+}
+
+void BM_ScriptUpdate(benchmark::State& state)
+{
+    const std::string scriptPath = writeRotateScript();
+    ObjectList objects = makeObjects(static_cast<size_t>(state.range(0)));
+    for (const auto& object : objects) {
+        object->connectScript(scriptPath);
+    }
+
+    for (auto _ : state) {
+        for (const auto& object : objects) {
+            object->update();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ScriptUpdate)->Arg(1000);
+
+void BM_TransformMatrix(benchmark::State& state)
+{
+    ObjectList objects = makeObjects(1024);
+    size_t index = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(objects[index & 1023U]->getTransformMatrix());
+        ++index;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TransformMatrix);
+
+// The generic glm chain getTransformMatrix used to be, kept as a baseline
+void BM_TransformMatrixGlmChain(benchmark::State& state)
+{
+    ObjectList objects = makeObjects(1024);
+    size_t index = 0;
+    for (auto _ : state) {
+        const mentalsdk::CMentalObject& object = *objects[index & 1023U];
+        glm::mat4 model = glm::translate(glm::mat4(1.0F), object.getPosition());
+        model = glm::rotate(model, object.getRotation().x, glm::vec3(1.0F, 0.0F, 0.0F));
+        model = glm::rotate(model, object.getRotation().y, glm::vec3(0.0F, 1.0F, 0.0F));
+        model = glm::rotate(model, object.getRotation().z, glm::vec3(0.0F, 0.0F, 1.0F));
+        model = glm::scale(model, object.getScale());
+        benchmark::DoNotOptimize(model);
+        ++index;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TransformMatrixGlmChain);
+
+void BM_ShaderSetMat4(benchmark::State& state)
+{
+    if (!ensureGlContext()) {
+        state.SkipWithError("No headless GL context available");
+        return;
+    }
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::ofstream(directory / "mental_microbench_vertex.glsl")
+        << "#version 330 core\nlayout (location = 0) in vec3 aPos;\nuniform mat4 model;\nuniform mat4 view;\n"
+           "uniform mat4 projection;\nvoid main() { gl_Position = projection * view * model * vec4(aPos, 1.0); }\n";
+    std::ofstream(directory / "mental_microbench_fragment.glsl")
+        << "#version 330 core\nout vec4 FragColor;\nvoid main() { FragColor = vec4(1.0); }\n";
+    mentalsdk::CMentalShader shader((directory / "mental_microbench_vertex.glsl").string(),
+                                    (directory / "mental_microbench_fragment.glsl").string());
+    if (!shader.isValid()) {
+        state.SkipWithError("Benchmark shader failed to compile");
+        return;
+    }
+    shader.use();
+
+    const glm::mat4 matrix(1.0F);
+    for (auto _ : state) {
+        shader.setMat4("model", matrix);
+    }
+    glFinish();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ShaderSetMat4);
+
+void BM_WorldInsert(benchmark::State& state)
+{
+    const auto count = static_cast<size_t>(state.range(0));
+    ObjectList objects = makeObjects(count);
+    std::vector<std::string> names;
+    names.reserve(count);
+    for (const auto& object : objects) {
+        names.push_back(object->getName());
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto world = std::make_unique<mentalsdk::CMentalWorld>();
+        state.ResumeTiming();
+        for (size_t index = 0; index < count; ++index) {
+            world->setNode(names[index], objects[index]);
+        }
+        world->applyNodeChanges();
+        state.PauseTiming();
+        world.reset(); // Tear-down is not part of insertion
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_WorldInsert)->Arg(1000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+void BM_WorldIterate(benchmark::State& state)
+{
+    mentalsdk::CMentalWorld world;
+    ObjectList objects = makeObjects(static_cast<size_t>(state.range(0)));
+    for (const auto& object : objects) {
+        world.setNode(object->getName(), object);
+    }
+    world.applyNodeChanges();
+
+    for (auto _ : state) {
+        float sum = 0.0F;
+        for (const auto& [name, object] : *world.getHierarchy()) {
+            sum += object->getPosition().x;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_WorldIterate)->Arg(1000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+
+// Full CPU frame (scripts, transforms, culling, command generation) without submission
+void BM_WorldSimulate(benchmark::State& state)
+{
+    mentalsdk::CMentalWorld world;
+    if (state.range(1) != 0) {
+        world.setJobSystem(std::make_shared<mentalsdk::CMentalJobSystem>());
+    }
+    ObjectList objects = makeObjects(static_cast<size_t>(state.range(0)));
+    for (const auto& object : objects) {
+        world.setNode(object->getName(), object);
+    }
+
+    mentalsdk::CMentalFramePacket packet;
+    world.simulate(packet); // Builds the spatial indices outside the measurement
+    size_t frame = 0;
+    for (auto _ : state) {
+        // Touch a slice of objects each frame so transform and index updates have work to do
+        for (size_t index = frame % 16; index < objects.size(); index += 16) {
+            objects[index]->setRotation(objects[index]->getRotation() + glm::vec3(0.0F, 0.01F, 0.0F));
+        }
+        world.simulate(packet);
+        ++frame;
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_WorldSimulate)
+    ->Args({1000, 0})->Args({100000, 0})->Args({1000000, 0})
+    ->Args({1000, 1})->Args({100000, 1})->Args({1000000, 1})
+    ->ArgNames({"nodes", "jobs"})->Unit(benchmark::kMillisecond);
+
+void BM_RendererExecuteCommands(benchmark::State& state)
+{
+    ensureGlContext(); // The renderer initializes GLEW on construction
+    mentalsdk::CMentalRenderer renderer;
+    uint64_t counter = 0;
+    for (int64_t index = 0; index < state.range(0); ++index) {
+        renderer.addCommandToPool([&counter]() { ++counter; });
+    }
+
+    for (auto _ : state) {
+        renderer.executeCommands();
+    }
+    benchmark::DoNotOptimize(counter);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RendererExecuteCommands)->Arg(1000)->Arg(100000);
+
+} // namespace
+
+BENCHMARK_MAIN();
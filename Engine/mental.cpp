@@ -1,24 +1,55 @@
 #include "../SDK/SDK.hpp"
+#include <cstdlib>
+#include <filesystem>
 #include <iostream>
 #include <memory>
+#include <string>
 
 
-int main() {
+int main(int argc, char** argv) {
     std::cout << "Hello, World!\n";
+
+    // --headless renders offscreen, --frames N stops after N frames, --capture FILE.ppm saves the last one
+    auto mode = mentalsdk::MentalWindowMode::Windowed;
+    uint64_t frameLimit = 0;
+    std::string capturePath;
+    for (int index = 1; index < argc; ++index) {
+        const std::string argument = argv[index];
+        if (argument == "--headless") {
+            mode = mentalsdk::MentalWindowMode::Headless;
+        } else if (argument == "--frames" && index + 1 < argc) {
+            frameLimit = std::strtoull(argv[++index], nullptr, 10);
+        } else if (argument == "--capture" && index + 1 < argc) {
+            capturePath = argv[++index];
+        }
+    }
     
     try {
-        mentalsdk::CMentalWindow<mentalsdk::CMentalRenderer> window;
+        mentalsdk::CMentalWindow<mentalsdk::CMentalRenderer> window(mode);
+        window.setFrameLimit(frameLimit);
+        if (!capturePath.empty()) {
+            window.setReadback(capturePath);
+        }
         
         auto renderer = std::make_shared<mentalsdk::CMentalRenderer>();
         auto world = std::make_shared<mentalsdk::CMentalWorld>();
+        auto jobSystem = std::make_shared<mentalsdk::CMentalJobSystem>();
+        world->setJobSystem(jobSystem);
+        mentalsdk::CMentalAssetManager assets(jobSystem);
+        if (std::filesystem::exists("common.mpak")) {
+            assets.mount("common.mpak"); // Packed at build time; the loose files stay as the fallback
+        }
         
         auto environment = std::make_shared<mentalsdk::CMentalEnvironment>();
         environment->setColor(0.3F, 0.2F, 0.7F, 1.0F);
         
         // Create a triangle using the new factory method
         auto triangle = mentalsdk::CMentalObject::createTriangle("MyTriangle");
-        triangle->connectShader("common/Shaders/default_vertex.glsl", "common/Shaders/default_fragment.glsl");
+        const auto shader = assets.load<mentalsdk::CMentalShader>("common/Shaders/default_vertex.glsl",
+                                                                  { "common/Shaders/default_fragment.glsl" });
         triangle->connectScript("common/Scripts/rotate_script.lua");
+        assets.finish(); // Everything requested above loads in parallel; the context is still on this thread
+        triangle->setShader(shader.get());
         
         auto camera = std::make_shared<mentalsdk::CMentalObject>("Camera", mentalsdk::CMentalObjectType::Camera);
         auto moonObject = std::make_shared<mentalsdk::CMentalObject>("Moon", mentalsdk::CMentalObjectType::ObjModel);
@@ -28,7 +59,17 @@ int main() {
         // world->setNode("Camera", camera);  // Camera doesn't need rendering yet
 
         renderer->addCommandToPool([&world]() { world->render(); });
+        renderer->setFrameStages([&world](mentalsdk::CMentalFramePacket& packet) { world->simulate(packet); },
+                                 [](const mentalsdk::CMentalFramePacket& packet) { mentalsdk::CMentalWorld::submit(packet); });
+        // GL thread at the frame boundary: finished loads land (and a world streamer would
+        // run) before the world applies node changes and reloads shaders
+        renderer->setFrameSync([&world, &assets]() {
+            assets.update();
+            assets.dispatchCallbacks();
+            world->synchronize();
+        });
         window.setRenderPool(renderer);
+        window.setThreadedRendering(true);
         window.run();
         
     } catch (const std::exception& e) {
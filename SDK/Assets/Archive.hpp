@@ -0,0 +1,437 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "../Utils/MappedFile.hpp"
+
+// Per-entry codecs are optional dependencies, found by CMake
+#ifdef MENTAL_HAVE_LZ4
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
+#ifdef MENTAL_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace mentalsdk
+{
+
+const uint32_t ARCHIVE_MAGIC = 0x4B41504DU; // "MPAK"
+const uint32_t ARCHIVE_VERSION = 1;
+const uint32_t ARCHIVE_DEFAULT_ALIGNMENT = 64;
+const size_t ARCHIVE_HEADER_SIZE = 40;
+const size_t ARCHIVE_ENTRY_SIZE = 40;
+const int ARCHIVE_ZSTD_LEVEL = 19; // Packing is offline, so favor ratio
+const int ARCHIVE_LZ4HC_LEVEL = 12;
+const uint64_t ARCHIVE_MAX_INFLATED_SIZE = 1ULL << 30; // A compressed entry never decompresses to more
+const uint64_t ARCHIVE_MAX_INFLATE_RATIO = 4096; // Nor to more than this times its stored size; LZ4 tops out near 255
+
+enum MentalArchiveCodec : uint8_t {
+    Stored = 0,
+    LZ4 = 1,
+    Zstd = 2,
+};
+
+struct CMentalArchiveEntry {
+    uint64_t hash = 0;
+    uint64_t offset = 0;
+    uint64_t storedSize = 0;
+    uint64_t size = 0;
+    uint32_t nameOffset = 0;
+    uint16_t nameLength = 0;
+    MentalArchiveCodec codec = Stored;
+};
+
+// Shared by reader and writer: names, hashing and the codecs compiled in
+class CMentalArchiveFormat
+{
+public:
+    // Archive paths use '/' and no leading "./", so "common/Shaders/a.glsl" finds itself either way
+    static std::string normalize(std::string path) {
+        std::replace(path.begin(), path.end(), '\\', '/');
+        while (path.rfind("./", 0) == 0) {
+            path.erase(0, 2);
+        }
+        return path;
+    }
+
+    // FNV-1a, 64 bit
+    static uint64_t hash(std::string_view path) {
+        uint64_t value = 0xCBF29CE484222325ULL;
+        for (const char character : path) {
+            value ^= static_cast<uint8_t>(character);
+            value *= 0x100000001B3ULL;
+        }
+        return value;
+    }
+
+    static bool isCodecAvailable(MentalArchiveCodec codec) {
+        switch (codec) {
+            case Stored: return true;
+#ifdef MENTAL_HAVE_LZ4
+            case LZ4: return true;
+#endif
+#ifdef MENTAL_HAVE_ZSTD
+            case Zstd: return true;
+#endif
+            default: return false;
+        }
+    }
+
+    static const char* getCodecName(MentalArchiveCodec codec) {
+        switch (codec) {
+            case Stored: return "stored";
+            case LZ4: return "lz4";
+            case Zstd: return "zstd";
+        }
+        return "unknown";
+    }
+
+    // Returns false when the codec is not compiled in or the output would not be smaller
+    static bool compress(MentalArchiveCodec codec, const uint8_t* data, size_t size, std::vector<uint8_t>& compressed) {
+        switch (codec) {
+#ifdef MENTAL_HAVE_LZ4
+            case LZ4: {
+                if (size > static_cast<size_t>(LZ4_MAX_INPUT_SIZE)) {
+                    return false;
+                }
+                compressed.resize(static_cast<size_t>(LZ4_compressBound(static_cast<int>(size))));
+                const int written = LZ4_compress_HC(reinterpret_cast<const char*>(data), reinterpret_cast<char*>(compressed.data()),
+                                                    static_cast<int>(size), static_cast<int>(compressed.size()), ARCHIVE_LZ4HC_LEVEL);
+                compressed.resize(written > 0 ? static_cast<size_t>(written) : 0);
+                return written > 0 && compressed.size() < size;
+            }
+#endif
+#ifdef MENTAL_HAVE_ZSTD
+            case Zstd: {
+                compressed.resize(ZSTD_compressBound(size));
+                const size_t written = ZSTD_compress(compressed.data(), compressed.size(), data, size, ARCHIVE_ZSTD_LEVEL);
+                if (ZSTD_isError(written) != 0) {
+                    return false;
+                }
+                compressed.resize(written);
+                return compressed.size() < size;
+            }
+#endif
+            default:
+                (void)data;
+                (void)size;
+                (void)compressed;
+                return false;
+        }
+    }
+
+    // Bounds what reading a compressed entry may allocate, so a corrupt table of contents
+    // cannot ask for any amount of memory. The writer stores entries outside them uncompressed
+    static bool isInflateBounded(uint64_t storedSize, uint64_t size) {
+        return size <= ARCHIVE_MAX_INFLATED_SIZE && size / ARCHIVE_MAX_INFLATE_RATIO <= storedSize;
+    }
+
+    static bool decompress(MentalArchiveCodec codec, const uint8_t* data, size_t storedSize, uint8_t* output, size_t size) {
+        switch (codec) {
+#ifdef MENTAL_HAVE_LZ4
+            case LZ4:
+                return storedSize <= static_cast<size_t>(LZ4_MAX_INPUT_SIZE) && size <= static_cast<size_t>(LZ4_MAX_INPUT_SIZE) &&
+                       LZ4_decompress_safe(reinterpret_cast<const char*>(data), reinterpret_cast<char*>(output),
+                                           static_cast<int>(storedSize), static_cast<int>(size)) == static_cast<int>(size);
+#endif
+#ifdef MENTAL_HAVE_ZSTD
+            case Zstd: {
+                const size_t written = ZSTD_decompress(output, size, data, storedSize);
+                return ZSTD_isError(written) == 0 && written == size;
+            }
+#endif
+            default:
+                (void)data;
+                (void)storedSize;
+                (void)output;
+                (void)size;
+                return false;
+        }
+    }
+};
+
+// Read side of a .mpak archive: one mapping, a table of contents sorted by path hash, and
+// entries handed out as views into the mapping. Only compressed entries are copied, into
+// the buffer they decompress to. Lookups and reads are safe from any thread.
+//
+// Layout, little endian: a 40 byte header (magic, version, entry count, alignment, TOC
+// offset, names offset, names size), entry data each starting at a multiple of the
+// alignment, then the TOC of 40 byte entries and the names they point into.
+class CMentalArchive
+{
+private:
+    std::shared_ptr<CMentalMappedFile> file_; // Shared with the bytes handed out, which may outlive the archive
+    std::vector<CMentalArchiveEntry> entries_;
+    const char* names_ = nullptr;
+    std::string path_;
+
+    template <typename T>
+    static T readValue(const uint8_t* data, size_t offset) {
+        T value{};
+        std::memcpy(&value, data + offset, sizeof(T));
+        return value;
+    }
+
+    [[nodiscard]] std::string_view getName(const CMentalArchiveEntry& entry) const {
+        return { names_ + entry.nameOffset, entry.nameLength };
+    }
+
+public:
+    CMentalArchive() = default;
+    ~CMentalArchive() = default;
+
+    CMentalArchive(const CMentalArchive&) = delete;
+    CMentalArchive& operator=(const CMentalArchive&) = delete;
+    CMentalArchive(CMentalArchive&&) = delete;
+    CMentalArchive& operator=(CMentalArchive&&) = delete;
+
+    bool open(const std::string& filePath) {
+        entries_.clear();
+        names_ = nullptr;
+        path_ = filePath;
+        file_ = std::make_shared<CMentalMappedFile>();
+        if (!file_->open(filePath)) {
+            std::cerr << "Error: Could not open archive " << filePath << "\n";
+            file_.reset();
+            return false;
+        }
+
+        const uint8_t* data = file_->getData();
+        const size_t size = file_->getSize();
+        const auto fail = [this, &filePath](const char* reason) {
+            std::cerr << "Error: Archive " << filePath << " is " << reason << "\n";
+            entries_.clear();
+            file_.reset();
+            return false;
+        };
+        if (size < ARCHIVE_HEADER_SIZE || readValue<uint32_t>(data, 0) != ARCHIVE_MAGIC) {
+            return fail("not an .mpak file");
+        }
+        if (readValue<uint32_t>(data, 4) != ARCHIVE_VERSION) {
+            return fail("from an unsupported version");
+        }
+        const uint32_t count = readValue<uint32_t>(data, 8);
+        const uint64_t tocOffset = readValue<uint64_t>(data, 16);
+        const uint64_t namesOffset = readValue<uint64_t>(data, 24);
+        const uint64_t namesSize = readValue<uint64_t>(data, 32);
+        if (tocOffset > size || static_cast<uint64_t>(count) * ARCHIVE_ENTRY_SIZE > size - tocOffset ||
+            namesOffset > size || namesSize > size - namesOffset) {
+            return fail("truncated");
+        }
+
+        entries_.resize(count);
+        for (uint32_t index = 0; index < count; ++index) {
+            const size_t record = static_cast<size_t>(tocOffset) + static_cast<size_t>(index) * ARCHIVE_ENTRY_SIZE;
+            CMentalArchiveEntry& entry = entries_[index];
+            entry.hash = readValue<uint64_t>(data, record);
+            entry.offset = readValue<uint64_t>(data, record + 8);
+            entry.storedSize = readValue<uint64_t>(data, record + 16);
+            entry.size = readValue<uint64_t>(data, record + 24);
+            entry.nameOffset = readValue<uint32_t>(data, record + 32);
+            entry.nameLength = readValue<uint16_t>(data, record + 36);
+            entry.codec = static_cast<MentalArchiveCodec>(data[record + 38]);
+            if (entry.offset > size || entry.storedSize > size - entry.offset ||
+                static_cast<uint64_t>(entry.nameOffset) + entry.nameLength > namesSize || entry.codec > Zstd ||
+                (entry.codec == Stored && entry.storedSize != entry.size) || (index > 0 && entry.hash < entries_[index - 1].hash)) {
+                return fail("corrupt");
+            }
+            if (entry.codec != Stored && !CMentalArchiveFormat::isInflateBounded(entry.storedSize, entry.size)) {
+                return fail("corrupt (an entry claims to decompress to more than it can)");
+            }
+        }
+        names_ = reinterpret_cast<const char*>(data + namesOffset);
+        return true;
+    }
+
+    [[nodiscard]] const CMentalArchiveEntry* find(const std::string& path) const {
+        const std::string name = CMentalArchiveFormat::normalize(path);
+        const uint64_t hash = CMentalArchiveFormat::hash(name);
+        auto entry = std::lower_bound(entries_.begin(), entries_.end(), hash,
+                                      [](const CMentalArchiveEntry& candidate, uint64_t value) { return candidate.hash < value; });
+        for (; entry != entries_.end() && entry->hash == hash; ++entry) {
+            if (this->getName(*entry) == name) {
+                return &*entry;
+            }
+        }
+        return nullptr;
+    }
+
+    // Stored entries point into the mapping and keep it alive; compressed ones are inflated
+    bool read(const std::string& path, CMentalFileBytes& bytes) const {
+        const CMentalArchiveEntry* entry = this->find(path);
+        if (entry == nullptr) {
+            return false;
+        }
+        const uint8_t* stored = file_->getData() + entry->offset;
+        bytes = CMentalFileBytes{};
+        if (entry->codec == Stored) {
+            bytes.data = stored;
+            bytes.size = static_cast<size_t>(entry->size);
+            bytes.owner = file_;
+            return true;
+        }
+        if (!CMentalArchiveFormat::isCodecAvailable(entry->codec)) {
+            std::cerr << "Error: " << path << " in " << path_ << " is " << CMentalArchiveFormat::getCodecName(entry->codec)
+                      << " compressed, which this build does not support\n";
+            return false;
+        }
+        bytes.storage.resize(static_cast<size_t>(entry->size));
+        if (!CMentalArchiveFormat::decompress(entry->codec, stored, static_cast<size_t>(entry->storedSize), bytes.storage.data(),
+                                              bytes.storage.size())) {
+            std::cerr << "Error: Could not decompress " << path << " in " << path_ << "\n";
+            bytes.storage.clear();
+            return false;
+        }
+        bytes.data = bytes.storage.data();
+        bytes.size = bytes.storage.size();
+        return true;
+    }
+
+    [[nodiscard]] bool contains(const std::string& path) const { return this->find(path) != nullptr; }
+    [[nodiscard]] bool isOpen() const { return file_ != nullptr; }
+    [[nodiscard]] size_t getEntryCount() const { return entries_.size(); }
+    [[nodiscard]] const std::string& getPath() const { return path_; }
+};
+
+// Write side, used offline by mental_pack. Entries that do not shrink are stored as is
+class CMentalArchiveWriter
+{
+private:
+    struct Pending {
+        std::string name;
+        std::vector<uint8_t> data;
+        uint64_t size = 0;
+        MentalArchiveCodec codec = Stored;
+    };
+
+    std::vector<Pending> pending_;
+
+    template <typename T>
+    static void writeValue(std::ostream& stream, T value) {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    static void pad(std::ostream& stream, uint64_t& position, uint64_t alignment) {
+        static const char zeros[256] = {};
+        while (position % alignment != 0) {
+            const uint64_t count = std::min<uint64_t>(alignment - position % alignment, sizeof(zeros));
+            stream.write(zeros, static_cast<std::streamsize>(count));
+            position += count;
+        }
+    }
+
+public:
+    // Returns false for a duplicate name or a name too long for the table of contents
+    bool add(const std::string& path, std::vector<uint8_t> data, MentalArchiveCodec codec = Stored) {
+        Pending entry;
+        entry.name = CMentalArchiveFormat::normalize(path);
+        if (entry.name.empty() || entry.name.size() > UINT16_MAX) {
+            return false;
+        }
+        for (const Pending& existing : pending_) {
+            if (existing.name == entry.name) {
+                return false;
+            }
+        }
+        entry.size = data.size();
+        std::vector<uint8_t> compressed;
+        if (codec != Stored && CMentalArchiveFormat::compress(codec, data.data(), data.size(), compressed) &&
+            CMentalArchiveFormat::isInflateBounded(compressed.size(), data.size())) {
+            entry.data = std::move(compressed);
+            entry.codec = codec;
+        } else {
+            entry.data = std::move(data);
+        }
+        pending_.push_back(std::move(entry));
+        return true;
+    }
+
+    bool write(std::ostream& stream, uint32_t alignment = ARCHIVE_DEFAULT_ALIGNMENT) const {
+        alignment = std::max<uint32_t>(alignment, 8);
+        std::vector<size_t> order(pending_.size());
+        for (size_t index = 0; index < order.size(); ++index) {
+            order[index] = index;
+        }
+        std::vector<uint64_t> hashes(pending_.size());
+        for (size_t index = 0; index < pending_.size(); ++index) {
+            hashes[index] = CMentalArchiveFormat::hash(pending_[index].name);
+        }
+        std::sort(order.begin(), order.end(), [&hashes](size_t lhs, size_t rhs) { return hashes[lhs] < hashes[rhs]; });
+
+        // Header is rewritten once the offsets are known
+        uint64_t position = 0;
+        std::vector<char> header(ARCHIVE_HEADER_SIZE, 0);
+        stream.write(header.data(), static_cast<std::streamsize>(header.size()));
+        position += header.size();
+
+        std::vector<uint64_t> offsets(pending_.size());
+        for (const size_t index : order) {
+            pad(stream, position, alignment);
+            offsets[index] = position;
+            stream.write(reinterpret_cast<const char*>(pending_[index].data.data()), static_cast<std::streamsize>(pending_[index].data.size()));
+            position += pending_[index].data.size();
+        }
+
+        pad(stream, position, 8);
+        const uint64_t tocOffset = position;
+        uint64_t nameOffset = 0;
+        for (const size_t index : order) {
+            const Pending& entry = pending_[index];
+            writeValue<uint64_t>(stream, hashes[index]);
+            writeValue<uint64_t>(stream, offsets[index]);
+            writeValue<uint64_t>(stream, entry.data.size());
+            writeValue<uint64_t>(stream, entry.size);
+            writeValue<uint32_t>(stream, static_cast<uint32_t>(nameOffset));
+            writeValue<uint16_t>(stream, static_cast<uint16_t>(entry.name.size()));
+            writeValue<uint8_t>(stream, entry.codec);
+            writeValue<uint8_t>(stream, 0);
+            nameOffset += entry.name.size();
+        }
+        position += pending_.size() * ARCHIVE_ENTRY_SIZE;
+        const uint64_t namesOffset = position;
+        if (nameOffset > UINT32_MAX) {
+            return false;
+        }
+        for (const size_t index : order) {
+            stream.write(pending_[index].name.data(), static_cast<std::streamsize>(pending_[index].name.size()));
+        }
+
+        stream.seekp(0);
+        writeValue<uint32_t>(stream, ARCHIVE_MAGIC);
+        writeValue<uint32_t>(stream, ARCHIVE_VERSION);
+        writeValue<uint32_t>(stream, static_cast<uint32_t>(pending_.size()));
+        writeValue<uint32_t>(stream, alignment);
+        writeValue<uint64_t>(stream, tocOffset);
+        writeValue<uint64_t>(stream, namesOffset);
+        writeValue<uint64_t>(stream, nameOffset);
+        return static_cast<bool>(stream);
+    }
+
+    [[nodiscard]] size_t getEntryCount() const { return pending_.size(); }
+    [[nodiscard]] uint64_t getStoredBytes() const {
+        uint64_t bytes = 0;
+        for (const Pending& entry : pending_) {
+            bytes += entry.data.size();
+        }
+        return bytes;
+    }
+    [[nodiscard]] uint64_t getOriginalBytes() const {
+        uint64_t bytes = 0;
+        for (const Pending& entry : pending_) {
+            bytes += entry.size;
+        }
+        return bytes;
+    }
+};
+
+} // mentalsdk
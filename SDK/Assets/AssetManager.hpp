@@ -0,0 +1,677 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Archive.hpp"
+#include "../Objects/Mesh.hpp"
+#include "../Objects/MeshOptimizer.hpp"
+#include "../Objects/Texture.hpp"
+#include "../Objects/TextureStreamer.hpp"
+#include "../Renderer/Shader.hpp"
+#include "../Utils/JobSystem.hpp"
+#include "../Utils/Profiler.hpp"
+#include "../Utils/Stats.hpp"
+
+namespace mentalsdk
+{
+
+const size_t DEFAULT_ASSET_MAX_IN_FLIGHT = 16; // Decodes running at once; the rest wait in priority order
+const auto DEFAULT_ASSET_FINALIZE_BUDGET = std::chrono::microseconds(4000); // GL work per update(), at least one asset
+const int64_t DEFAULT_TEXTURE_BUDGET = 512LL * 1024 * 1024; // Bytes of VRAM for textures kept with nobody using them
+
+enum MentalAssetState : uint8_t {
+    Queued = 0,
+    Loading = 1,
+    Ready = 2,
+    Failed = 3,
+};
+
+using AssetCallback = std::function<void(MentalAssetState)>;
+
+// Shared by every handle to one asset. Internal to the manager apart from the state
+struct CMentalAssetRecord {
+    std::string key;
+    std::string path;
+    std::atomic<MentalAssetState> state{ Queued };
+    std::shared_ptr<void> asset; // Written once on the GL thread before state turns Ready
+
+    // Owned by the manager, under its mutex
+    int priority = 0;
+    uint64_t sequence = 0;
+    uint64_t lastUse = 0; // Sequence of the latest load() asking for it, orders texture eviction
+    int64_t textureBytes = 0; // Full size of a finished texture, counted against the texture budget
+    std::vector<std::shared_ptr<CMentalAssetRecord>> dependencies;
+    std::vector<AssetCallback> callbacks;
+    std::function<bool()> decode;   // Worker thread: I/O and CPU work
+    std::function<bool()> finalize; // GL thread, once every dependency is ready
+    std::atomic<bool> decoded{ false };
+    bool decodeSucceeded = false;
+};
+
+// Untyped reference, what dependency lists are made of
+class CMentalAssetRef
+{
+protected:
+    std::shared_ptr<CMentalAssetRecord> record_;
+
+public:
+    CMentalAssetRef() = default;
+    explicit CMentalAssetRef(std::shared_ptr<CMentalAssetRecord> record) : record_(std::move(record)) {}
+
+    [[nodiscard]] bool isValid() const { return record_ != nullptr; }
+    [[nodiscard]] MentalAssetState getState() const {
+        return record_ ? record_->state.load(std::memory_order_acquire) : Failed;
+    }
+    [[nodiscard]] bool isReady() const { return this->getState() == Ready; }
+    [[nodiscard]] bool isFailed() const { return this->getState() == Failed; }
+    [[nodiscard]] bool isDone() const { return this->getState() >= Ready; }
+    [[nodiscard]] const std::string& getPath() const {
+        static const std::string empty;
+        return record_ ? record_->path : empty;
+    }
+    [[nodiscard]] const std::shared_ptr<CMentalAssetRecord>& getRecord() const { return record_; }
+};
+
+// Typed handle; get() stays nullptr until the asset is ready
+template <typename T>
+class CMentalAssetHandle : public CMentalAssetRef
+{
+public:
+    CMentalAssetHandle() = default;
+    explicit CMentalAssetHandle(std::shared_ptr<CMentalAssetRecord> record) : CMentalAssetRef(std::move(record)) {}
+
+    [[nodiscard]] std::shared_ptr<T> get() const {
+        return this->isReady() ? std::static_pointer_cast<T>(record_->asset) : nullptr;
+    }
+};
+
+// Where loaders read bytes from: mounted archives, newest first, then loose files. Immutable
+// once built, so decodes in flight keep reading the set they started with
+class CMentalAssetSource
+{
+private:
+    std::vector<std::shared_ptr<const CMentalArchive>> archives_;
+
+public:
+    CMentalAssetSource() = default;
+    explicit CMentalAssetSource(std::vector<std::shared_ptr<const CMentalArchive>> archives) : archives_(std::move(archives)) {}
+
+    [[nodiscard]] CMentalFileBytes read(const std::string& path) const {
+        CMentalFileBytes bytes;
+        for (auto archive = archives_.rbegin(); archive != archives_.rend(); ++archive) {
+            if ((*archive)->read(path, bytes)) {
+                return bytes;
+            }
+        }
+        return CMentalFileBytes::map(path);
+    }
+
+    [[nodiscard]] const std::vector<std::shared_ptr<const CMentalArchive>>& getArchives() const { return archives_; }
+};
+
+// Specialized per asset type: Params (with getKey()), a Payload filled by decode() on a
+// worker and turned into the asset by finalize() on the GL thread
+template <typename T>
+struct CMentalAssetLoader;
+
+template <>
+struct CMentalAssetLoader<CMentalTexture> {
+    using Params = CMentalTextureParams;
+    struct Payload {
+        CMentalMipChain chain;
+        CMentalFileBytes bytes; // A cooked DDS uploads straight from these on the GL thread
+    };
+
+    static bool decode(const CMentalAssetSource& source, const std::string& path, const Params& params, Payload& payload) {
+        CMentalFileBytes bytes = source.read(path);
+        if (!bytes.isValid()) {
+            return false;
+        }
+        if (CMentalTexture::isCompressedFile(bytes.data, bytes.size)) {
+            payload.bytes = std::move(bytes);
+            return true;
+        }
+        return CMentalTexture::decodeMemory(bytes.data, bytes.size, path, params, payload.chain);
+    }
+
+    static std::shared_ptr<CMentalTexture> finalize(const std::string& path, const Params& params, Payload& payload) {
+        auto texture = std::make_shared<CMentalTexture>();
+        const bool uploaded = payload.bytes.isValid() ? texture->loadFromMemory(std::move(payload.bytes), path, params)
+                                                      : texture->upload(std::move(payload.chain), params);
+        texture->setSourcePath(path);
+        return uploaded ? texture : nullptr;
+    }
+};
+
+// Asset path is the vertex shader, the fragment shader comes in the params
+struct CMentalShaderParams {
+    std::string fragmentPath;
+
+    [[nodiscard]] std::string getKey() const { return fragmentPath; }
+};
+
+template <>
+struct CMentalAssetLoader<CMentalShader> {
+    using Params = CMentalShaderParams;
+    struct Payload {
+        std::string vertexSource;
+        std::string fragmentSource;
+    };
+
+    static bool decode(const CMentalAssetSource& source, const std::string& path, const Params& params, Payload& payload) {
+        const CMentalFileBytes vertex = source.read(path);
+        const CMentalFileBytes fragment = source.read(params.fragmentPath);
+        if (!vertex.isValid() || !fragment.isValid()) {
+            return false;
+        }
+        payload.vertexSource.assign(reinterpret_cast<const char*>(vertex.data), vertex.size);
+        payload.fragmentSource.assign(reinterpret_cast<const char*>(fragment.data), fragment.size);
+        return !payload.vertexSource.empty() && !payload.fragmentSource.empty();
+    }
+
+    static std::shared_ptr<CMentalShader> finalize(const std::string& path, const Params& params, Payload& payload) {
+        auto shader = std::make_shared<CMentalShader>();
+        return shader->loadFromSources(path, params.fragmentPath, payload.vertexSource, payload.fragmentSource) ? shader : nullptr;
+    }
+};
+
+struct CMentalMeshParams {
+    bool optimize = true; // Reorder for the vertex cache, overdraw and fetches on import
+    bool cache = true; // Reuse path + ".mmsh" when it was cooked from these bytes, write it when not
+
+    [[nodiscard]] std::string getKey() const { return std::string(optimize ? "" : "raw") + (cache ? "" : "nocache"); }
+};
+
+template <>
+struct CMentalAssetLoader<CMentalMeshData> {
+    using Params = CMentalMeshParams;
+    using Payload = CMentalMeshData;
+
+    static bool decode(const CMentalAssetSource& source, const std::string& path, const Params& params, Payload& payload) {
+        const CMentalFileBytes bytes = source.read(path);
+        if (!bytes.isValid()) {
+            return false;
+        }
+        if (CMentalMeshData::isBinaryMesh(bytes.data, bytes.size)) {
+            return payload.loadBinary(bytes.data, bytes.size, path);
+        }
+        if (!params.optimize) {
+            return payload.loadObj(bytes.data, bytes.size, path);
+        }
+
+        const uint64_t sourceHash = CMentalArchiveFormat::hash(std::string_view(reinterpret_cast<const char*>(bytes.data), bytes.size));
+        const std::string cookedPath = path + ".mmsh";
+        if (params.cache) {
+            const CMentalFileBytes cooked = source.read(cookedPath);
+            CMentalMeshHeader header;
+            if (cooked.isValid() && CMentalMeshData::readBinaryHeader(cooked.data, cooked.size, header) &&
+                header.sourceHash == sourceHash && (header.flags & MESH_BINARY_OPTIMIZED) != 0 &&
+                header.optimizerVersion == MESH_OPTIMIZER_VERSION &&
+                payload.loadBinary(cooked.data, cooked.size, cookedPath)) {
+                return true;
+            }
+        }
+
+        if (!payload.loadObj(bytes.data, bytes.size, path)) {
+            return false;
+        }
+        {
+            MENTAL_PROFILE_SCOPE("Mesh Optimize"); // Reported by mental_meshcook, not per load
+            CMentalMeshOptimizer::optimize(payload);
+        }
+        if (params.cache && !isArchived(source, path)) {
+            writeCache(payload, cookedPath, sourceHash);
+        }
+        return true;
+    }
+
+    static std::shared_ptr<CMentalMeshData> finalize(const std::string& /*path*/, const Params& /*params*/, Payload& payload) {
+        return std::make_shared<CMentalMeshData>(std::move(payload));
+    }
+
+private:
+    static bool isArchived(const CMentalAssetSource& source, const std::string& path) {
+        const auto& archives = source.getArchives();
+        return std::any_of(archives.begin(), archives.end(),
+                           [&path](const std::shared_ptr<const CMentalArchive>& archive) { return archive->contains(path); });
+    }
+
+    // Next to a loose source only. Written aside and renamed, so a concurrent load of the
+    // same mesh never reads half a file; a read-only directory just means no cache
+    static void writeCache(const CMentalMeshData& mesh, const std::string& cookedPath, uint64_t sourceHash) {
+        const std::string temporary = cookedPath + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        std::error_code error;
+        if (mesh.saveBinary(temporary, sourceHash, MESH_BINARY_OPTIMIZED, MESH_OPTIMIZER_VERSION)) {
+            std::filesystem::rename(temporary, cookedPath, error);
+        }
+        if (error || std::filesystem::exists(temporary, error)) {
+            std::filesystem::remove(temporary, error);
+        }
+    }
+};
+
+// One place that loads every asset once and asynchronously. load() returns a handle at
+// once; decoding runs as background jobs, highest priority first, and update() finishes
+// assets on the GL thread once everything they depend on is ready (a failed dependency
+// fails its dependents). Completion callbacks run in dispatchCallbacks(), on whichever
+// thread owns the objects they touch. load() may be called from any thread.
+// Textures nobody uses any more stay loaded within a VRAM budget, least recently requested
+// go first; streaming ones are tracked by the texture streamer set here.
+class CMentalAssetManager
+{
+private:
+    struct QueueEntry {
+        int priority = 0;
+        uint64_t sequence = 0;
+        std::shared_ptr<CMentalAssetRecord> record;
+
+        // Highest priority first, then first requested
+        bool operator<(const QueueEntry& other) const {
+            return priority != other.priority ? priority < other.priority : sequence > other.sequence;
+        }
+    };
+
+    std::shared_ptr<CMentalJobSystem> jobSystem_;
+    mutable std::mutex mutex_;
+    std::shared_ptr<const CMentalAssetSource> source_ = std::make_shared<CMentalAssetSource>();
+    std::unordered_map<std::string, std::shared_ptr<CMentalAssetRecord>> records_;
+    std::priority_queue<QueueEntry> queue_; // May hold stale entries for re-prioritized records
+    std::vector<std::shared_ptr<CMentalAssetRecord>> loading_;
+    std::vector<std::pair<AssetCallback, MentalAssetState>> completed_;
+    size_t queuedCount_ = 0;
+    size_t maxInFlight_ = DEFAULT_ASSET_MAX_IN_FLIGHT;
+    size_t inFlight_ = 0;
+    uint64_t sequence_ = 0;
+    std::chrono::microseconds finalizeBudget_ = DEFAULT_ASSET_FINALIZE_BUDGET; // Guarded by mutex_ like the rest
+    std::shared_ptr<CMentalTextureStreamer> textureStreamer_ = nullptr;
+    int64_t textureBudget_ = DEFAULT_TEXTURE_BUDGET;
+    int64_t textureBytes_ = 0;
+
+    // Called with the finished asset from finalize(), GL thread under mutex_. Textures count
+    // against the budget and streaming ones go to the streamer for mip residency
+    template <typename T>
+    void adopt(CMentalAssetRecord& /*record*/, const std::shared_ptr<T>& /*asset*/) {}
+
+    void adopt(CMentalAssetRecord& record, const std::shared_ptr<CMentalTexture>& texture) {
+        record.textureBytes = texture->getBytesFrom(0);
+        textureBytes_ += record.textureBytes;
+        if (textureStreamer_ && texture->isStreaming()) {
+            textureStreamer_->track(texture);
+        }
+    }
+
+    // Forgets the record; the asset lives on with whoever still holds it. Caller holds mutex_
+    std::unordered_map<std::string, std::shared_ptr<CMentalAssetRecord>>::iterator
+    forget(std::unordered_map<std::string, std::shared_ptr<CMentalAssetRecord>>::iterator entry) {
+        textureBytes_ -= entry->second->textureBytes;
+        return records_.erase(entry);
+    }
+
+    // Over the texture budget, evicts textures no handle and no one else holds, least
+    // recently requested first. Caller holds mutex_
+    void trimTextures() {
+        if (textureBytes_ <= textureBudget_) {
+            return;
+        }
+        std::vector<std::unordered_map<std::string, std::shared_ptr<CMentalAssetRecord>>::iterator> unused;
+        for (auto entry = records_.begin(); entry != records_.end(); ++entry) {
+            const CMentalAssetRecord& record = *entry->second;
+            if (record.textureBytes > 0 && entry->second.use_count() == 1 && record.asset.use_count() == 1) {
+                unused.push_back(entry);
+            }
+        }
+        std::sort(unused.begin(), unused.end(), [](const auto& lhs, const auto& rhs) { return lhs->second->lastUse < rhs->second->lastUse; });
+        for (const auto& entry : unused) {
+            if (textureBytes_ <= textureBudget_) {
+                break;
+            }
+            this->forget(entry);
+        }
+    }
+
+    // Raises a queued record and, transitively, what it depends on. Caller holds mutex_
+    void raisePriority(const std::shared_ptr<CMentalAssetRecord>& record, int priority) {
+        if (record->priority >= priority || record->state.load(std::memory_order_relaxed) != Queued) {
+            return;
+        }
+        record->priority = priority;
+        queue_.push(QueueEntry{ priority, record->sequence, record });
+        for (const auto& dependency : record->dependencies) {
+            this->raisePriority(dependency, priority);
+        }
+    }
+
+    void complete(CMentalAssetRecord& record, MentalAssetState state) {
+        record.decode = nullptr;
+        record.finalize = nullptr;
+        record.state.store(state, std::memory_order_release);
+        for (AssetCallback& callback : record.callbacks) {
+            completed_.emplace_back(std::move(callback), state);
+        }
+        record.callbacks.clear();
+    }
+
+    // Worker thread, or the caller's without workers. A throwing loader fails the asset
+    static void decodeRecord(CMentalAssetRecord& record) {
+        try {
+            record.decodeSucceeded = record.decode();
+        } catch (const std::exception& error) {
+            std::cerr << "Error: Loading asset " << record.path << " threw: " << error.what() << "\n";
+            record.decodeSucceeded = false;
+        } catch (...) {
+            std::cerr << "Error: Loading asset " << record.path << " threw\n";
+            record.decodeSucceeded = false;
+        }
+        record.decoded.store(true, std::memory_order_release);
+    }
+
+    // Caller holds mutex_. Without workers the records come back in inlined, for the caller
+    // to decode once it has let go of the lock
+    void dispatch(std::vector<std::shared_ptr<CMentalAssetRecord>>& inlined) {
+        while (inFlight_ < maxInFlight_ && !queue_.empty()) {
+            const std::shared_ptr<CMentalAssetRecord> record = queue_.top().record;
+            queue_.pop();
+            if (record->state.load(std::memory_order_relaxed) != Queued) {
+                continue; // Stale entry of a raised record
+            }
+            --queuedCount_;
+            record->state.store(Loading, std::memory_order_release);
+            loading_.push_back(record);
+            ++inFlight_;
+            if (jobSystem_ && jobSystem_->getWorkerCount() > 0) {
+                jobSystem_->submit([record]() { decodeRecord(*record); }, nullptr, MentalJobPriority::Background);
+            } else {
+                inlined.push_back(record);
+            }
+        }
+    }
+
+    // Starts decodes and finishes decoded assets, within the finalize budget unless unbounded
+    void advance(bool unbounded) {
+        std::vector<std::shared_ptr<CMentalAssetRecord>> inlined;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            this->dispatch(inlined);
+        }
+        for (const auto& record : inlined) {
+            decodeRecord(*record); // load() and the rest stay free meanwhile
+        }
+        inlined.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            const auto start = std::chrono::steady_clock::now();
+            bool finalized = false;
+            for (size_t index = 0; index < loading_.size();) {
+                CMentalAssetRecord& record = *loading_[index];
+                if (!record.decoded.load(std::memory_order_acquire)) {
+                    ++index;
+                    continue;
+                }
+                if (record.decode) {
+                    record.decode = nullptr; // Counted out of flight once
+                    --inFlight_;
+                }
+
+                bool waiting = false;
+                bool dependencyFailed = false;
+                for (const auto& dependency : record.dependencies) {
+                    const MentalAssetState state = dependency->state.load(std::memory_order_acquire);
+                    dependencyFailed = dependencyFailed || state == Failed;
+                    waiting = waiting || state < Ready;
+                }
+                if (!dependencyFailed && record.decodeSucceeded && waiting) {
+                    ++index;
+                    continue;
+                }
+                if (!unbounded && finalized && std::chrono::steady_clock::now() - start > finalizeBudget_) {
+                    break;
+                }
+
+                MentalAssetState state = Failed;
+                if (dependencyFailed) {
+                    std::cerr << "Error: Asset " << record.path << " has a dependency that failed to load\n";
+                } else if (!record.decodeSucceeded) {
+                    std::cerr << "Error: Could not load asset " << record.path << "\n";
+                } else {
+                    state = record.finalize() ? Ready : Failed;
+                    finalized = true;
+                }
+                this->complete(record, state);
+                loading_[index] = std::move(loading_.back());
+                loading_.pop_back();
+            }
+            this->dispatch(inlined); // Slots freed by this frame's decodes
+            this->trimTextures();
+            CMentalStats::instance().setAssetQueueDepth(queuedCount_ + loading_.size());
+        }
+        for (const auto& record : inlined) {
+            decodeRecord(*record); // Finished at the next update
+        }
+    }
+
+public:
+    explicit CMentalAssetManager(std::shared_ptr<CMentalJobSystem> jobSystem = nullptr) : jobSystem_(std::move(jobSystem)) {}
+    ~CMentalAssetManager() { this->cancel(); }
+
+    CMentalAssetManager(const CMentalAssetManager&) = delete;
+    CMentalAssetManager& operator=(const CMentalAssetManager&) = delete;
+    CMentalAssetManager(CMentalAssetManager&&) = delete;
+    CMentalAssetManager& operator=(CMentalAssetManager&&) = delete;
+
+    // Loading the same path and params again returns the same asset, raising its priority
+    // if it is still queued. Callbacks of finished assets run at the next dispatchCallbacks()
+    template <typename T>
+    CMentalAssetHandle<T> load(const std::string& path, const typename CMentalAssetLoader<T>::Params& params = {},
+                               int priority = 0, const std::vector<CMentalAssetRef>& dependencies = {},
+                               AssetCallback callback = nullptr) {
+        using Loader = CMentalAssetLoader<T>;
+        const std::string key = std::string(typeid(T).name()) + ":" + path + "|" + params.getKey();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto found = records_.find(key);
+        if (found != records_.end()) {
+            const std::shared_ptr<CMentalAssetRecord>& record = found->second;
+            record->lastUse = sequence_++;
+            this->raisePriority(record, priority);
+            if (callback) {
+                const MentalAssetState state = record->state.load(std::memory_order_relaxed);
+                if (state >= Ready) {
+                    completed_.emplace_back(std::move(callback), state);
+                } else {
+                    record->callbacks.push_back(std::move(callback));
+                }
+            }
+            return CMentalAssetHandle<T>(record);
+        }
+
+        auto record = std::make_shared<CMentalAssetRecord>();
+        record->key = key;
+        record->path = path;
+        record->priority = priority;
+        record->sequence = sequence_++;
+        record->lastUse = record->sequence;
+        for (const CMentalAssetRef& dependency : dependencies) {
+            if (dependency.isValid()) {
+                record->dependencies.push_back(dependency.getRecord());
+                this->raisePriority(dependency.getRecord(), priority);
+            }
+        }
+        if (callback) {
+            record->callbacks.push_back(std::move(callback));
+        }
+        auto payload = std::make_shared<typename Loader::Payload>();
+        record->decode = [source = source_, path, params, payload]() { return Loader::decode(*source, path, params, *payload); };
+        CMentalAssetRecord* self = record.get(); // The record owns the closure
+        record->finalize = [this, self, params, payload]() {
+            std::shared_ptr<T> asset = Loader::finalize(self->path, params, *payload);
+            if (asset) {
+                this->adopt(*self, asset);
+            }
+            self->asset = asset;
+            return asset != nullptr;
+        };
+
+        records_.emplace(key, record);
+        queue_.push(QueueEntry{ priority, record->sequence, record });
+        ++queuedCount_;
+        return CMentalAssetHandle<T>(record);
+    }
+
+    // Later mounts shadow earlier ones and loose files; only loads requested afterwards see it
+    void mount(std::shared_ptr<const CMentalArchive> archive) {
+        if (!archive || !archive->isOpen()) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<std::shared_ptr<const CMentalArchive>> archives = source_->getArchives();
+        archives.push_back(std::move(archive));
+        source_ = std::make_shared<CMentalAssetSource>(std::move(archives));
+    }
+
+    // Opens and mounts an .mpak; false when it is missing or unreadable
+    bool mount(const std::string& archivePath) {
+        auto archive = std::make_shared<CMentalArchive>();
+        if (!archive->open(archivePath)) {
+            return false;
+        }
+        this->mount(std::shared_ptr<const CMentalArchive>(std::move(archive)));
+        return true;
+    }
+
+    // GL thread, once per frame: starts decodes by priority and finishes decoded assets
+    // within the finalize budget
+    void update() { this->advance(false); }
+
+    // Runs the callbacks of assets finished since the last call, on the calling thread
+    void dispatchCallbacks() {
+        std::vector<std::pair<AssetCallback, MentalAssetState>> completed;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            completed.swap(completed_);
+        }
+        for (auto& [callback, state] : completed) {
+            callback(state);
+        }
+    }
+
+    // GL thread: blocks until everything requested so far is ready or failed, then runs callbacks
+    void finish() {
+        while (this->getPendingCount() > 0) {
+            this->advance(true);
+            if (this->getPendingCount() > 0) {
+                std::this_thread::yield();
+            }
+        }
+        this->dispatchCallbacks();
+    }
+
+    // Drops queued requests and waits for running decodes, whose results are discarded
+    void cancel() {
+        std::vector<std::shared_ptr<CMentalAssetRecord>> loading;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            while (!queue_.empty()) {
+                CMentalAssetRecord& record = *queue_.top().record;
+                if (record.state.load(std::memory_order_relaxed) == Queued) {
+                    this->complete(record, Failed);
+                }
+                queue_.pop();
+            }
+            queuedCount_ = 0;
+            loading.swap(loading_);
+        }
+        for (const auto& record : loading) {
+            while (!record->decoded.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            this->complete(*record, Failed);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        inFlight_ = 0;
+    }
+
+    // Forgets finished assets that no handle or dependent refers to any more
+    size_t purge() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t purged = 0;
+        for (auto entry = records_.begin(); entry != records_.end();) {
+            if (entry->second.use_count() == 1 && entry->second->state.load(std::memory_order_relaxed) >= Ready) {
+                entry = this->forget(entry);
+                ++purged;
+            } else {
+                ++entry;
+            }
+        }
+        return purged;
+    }
+
+    void setMaxInFlight(size_t count) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        maxInFlight_ = std::max<size_t>(count, 1);
+    }
+    void setFinalizeBudget(std::chrono::microseconds budget) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finalizeBudget_ = budget;
+    }
+
+    // Textures loaded with params.streaming are handed to the streamer for mip residency;
+    // give the world the same one so culling requests their levels
+    void setTextureStreamer(const std::shared_ptr<CMentalTextureStreamer>& streamer) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        textureStreamer_ = streamer;
+    }
+    [[nodiscard]] std::shared_ptr<CMentalTextureStreamer> getTextureStreamer() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return textureStreamer_;
+    }
+
+    // Full sizes of finished textures the manager still knows; unused ones go once it is exceeded
+    void setTextureBudget(int64_t budget) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        textureBudget_ = budget;
+        this->trimTextures();
+    }
+    [[nodiscard]] int64_t getTextureBudget() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return textureBudget_;
+    }
+    [[nodiscard]] int64_t getTextureBytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return textureBytes_;
+    }
+
+    // Queued and loading, the number reported as the stats' asset queue depth
+    [[nodiscard]] size_t getPendingCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queuedCount_ + loading_.size();
+    }
+    [[nodiscard]] size_t getAssetCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return records_.size();
+    }
+    [[nodiscard]] std::shared_ptr<const CMentalAssetSource> getSource() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return source_;
+    }
+};
+
+} // mentalsdk
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "AssetManager.hpp"
+#include "SceneFormat.hpp"
+#include "../Objects/World.hpp"
+
+namespace mentalsdk
+{
+
+static_assert(Environment + 1 == SCENE_OBJECT_TYPE_COUNT, "scene files must cover every CMentalObjectType");
+
+struct CMentalSceneParams {
+    [[nodiscard]] std::string getKey() const { return {}; }
+};
+
+// Reading and validating a scene is worker work; there is nothing left for the GL thread
+template <>
+struct CMentalAssetLoader<CMentalSceneView> {
+    using Params = CMentalSceneParams;
+    using Payload = std::shared_ptr<CMentalSceneView>;
+
+    static bool decode(const CMentalAssetSource& source, const std::string& path, const Params& /*params*/, Payload& payload) {
+        CMentalFileBytes bytes = source.read(path);
+        payload = std::make_shared<CMentalSceneView>();
+        return bytes.isValid() && payload->open(std::move(bytes), path);
+    }
+
+    static std::shared_ptr<CMentalSceneView> finalize(const std::string& /*path*/, const Params& /*params*/, Payload& payload) {
+        return std::move(payload);
+    }
+};
+
+// What instantiate() added, so it can be taken out again
+struct CMentalSceneInstance {
+    std::vector<std::shared_ptr<CMentalObject>> objects; // In file order
+    std::vector<std::string> nodes; // Keys added to the world hierarchy
+    std::vector<CMentalAssetRef> assets; // Holds the scene's assets in the manager while the instance lives
+};
+
+// Saves a world to the binary scene format and builds worlds back from it. Objects refer
+// to meshes, textures, shaders and scripts by path; loading them goes through the asset
+// manager, so each is loaded once however many objects share it.
+class CMentalScene
+{
+private:
+    static uint8_t packTextureFlags(const CMentalTextureParams& params) {
+        return static_cast<uint8_t>((params.mipmaps ? SCENE_TEXTURE_MIPMAPS : 0) | (params.srgb ? SCENE_TEXTURE_SRGB : 0) |
+                                    (params.mipFilter == Kaiser ? SCENE_TEXTURE_KAISER : 0) |
+                                    (params.streaming ? SCENE_TEXTURE_STREAMING : 0));
+    }
+
+    static CMentalTextureParams unpackTextureParams(const CMentalSceneResource& resource) {
+        CMentalTextureParams params;
+        params.wrap = resource.wrap;
+        params.minFilter = resource.minFilter;
+        params.magFilter = resource.magFilter;
+        params.mipmaps = (resource.textureFlags & SCENE_TEXTURE_MIPMAPS) != 0;
+        params.srgb = (resource.textureFlags & SCENE_TEXTURE_SRGB) != 0;
+        params.mipFilter = (resource.textureFlags & SCENE_TEXTURE_KAISER) != 0 ? Kaiser : Box;
+        params.streaming = (resource.textureFlags & SCENE_TEXTURE_STREAMING) != 0;
+        return params;
+    }
+
+    static void writeVector(float* values, const glm::vec3& vector) {
+        values[0] = vector.x;
+        values[1] = vector.y;
+        values[2] = vector.z;
+    }
+
+    // Objects using one resource; weak so a pending load does not keep removed objects alive
+    using Users = std::vector<std::weak_ptr<CMentalObject>>;
+
+    template <typename Apply>
+    static void forEachUser(const Users& users, Apply&& apply) {
+        for (const auto& user : users) {
+            if (const std::shared_ptr<CMentalObject> object = user.lock()) {
+                apply(*object);
+            }
+        }
+    }
+
+public:
+    // Adds one object and, through the children it links with setNext, its subtree
+    static uint32_t addObject(CMentalSceneWriter& writer, const CMentalObject& object, const std::string& node,
+                              std::unordered_map<const CMentalObject*, uint32_t>& indices) {
+        const auto found = indices.find(&object);
+        if (found != indices.end()) {
+            return found->second;
+        }
+        CMentalSceneObject record;
+        record.name = writer.addString(object.getName());
+        record.node = writer.addString(node);
+        record.type = static_cast<uint8_t>(object.getType());
+        record.flags = object.isStatic() ? SCENE_OBJECT_STATIC : 0;
+        writeVector(record.position, object.getPosition());
+        writeVector(record.rotation, object.getRotation());
+        writeVector(record.scale, object.getScale());
+        record.mesh = writer.addResource(SceneMesh, object.getModelPath());
+        if (const CMentalTexture* texture = object.getTexture()) {
+            const CMentalTextureParams& params = texture->getParams();
+            record.texture = writer.addResource(SceneTexture, texture->getSourcePath(), {}, params.wrap, params.minFilter,
+                                                params.magFilter, packTextureFlags(params));
+        }
+        if (const CMentalShader* shader = object.getShader()) {
+            record.shader = writer.addResource(SceneShader, shader->getVertexPath(), shader->getFragmentPath());
+        }
+        if (const CMentalScript* script = object.getScript()) {
+            record.script = writer.addResource(SceneScript, script->getScriptFile());
+        }
+
+        const uint32_t index = writer.addObject(record);
+        indices.emplace(&object, index);
+        for (const auto& child : object.getNext()) {
+            if (!child) {
+                continue;
+            }
+            const uint32_t childIndex = addObject(writer, *child, {}, indices);
+            if (writer.getObject(childIndex).parent == SCENE_NONE && childIndex != index) {
+                writer.getObject(childIndex).parent = index;
+            }
+        }
+        return index;
+    }
+
+    // A world hierarchy entry; it may have been written already as another object's child
+    static uint32_t addNode(CMentalSceneWriter& writer, const CMentalObject& object, const std::string& node,
+                            std::unordered_map<const CMentalObject*, uint32_t>& indices) {
+        const uint32_t index = addObject(writer, object, node, indices);
+        if (writer.getObject(index).node.length == 0) {
+            writer.getObject(index).node = writer.addString(node);
+        }
+        return index;
+    }
+
+    // Resources made in code, without a path, are not saved; their objects keep the rest.
+    // Node changes still queued in the world are not written
+    static bool save(const CMentalWorld& world, const std::string& filePath) {
+        CMentalSceneWriter writer;
+        std::unordered_map<const CMentalObject*, uint32_t> indices;
+        if (const auto hierarchy = world.getHierarchy()) {
+            for (const auto& [node, object] : *hierarchy) {
+                if (!object) {
+                    continue;
+                }
+                addNode(writer, *object, node, indices);
+            }
+        }
+        if (const auto environment = world.getEnvironment()) {
+            writer.setEnvironment(ClearColor, environment->getColor());
+        }
+        return writer.write(filePath);
+    }
+
+    // GL thread, the frame sync stage with threaded rendering. Objects join the world at the
+    // next frame boundary; their meshes, textures and shaders arrive as the asset manager
+    // finishes them, through its dispatchCallbacks(). A mesh is a dependent of its objects'
+    // textures and shaders, so one whose material fails to load is not shown. Scripts load here
+    static bool instantiate(const CMentalSceneView& scene, CMentalWorld& world, CMentalAssetManager& assets,
+                            CMentalSceneInstance& instance, int priority = 0, bool applyEnvironment = true) {
+        if (!scene.isOpen()) {
+            return false;
+        }
+        const uint32_t count = scene.getObjectCount();
+        instance.objects.reserve(instance.objects.size() + count);
+        std::vector<Users> users(scene.getResourceCount());
+        std::vector<std::vector<uint32_t>> materials(scene.getResourceCount()); // Per mesh, the textures and shaders drawn with it
+        const size_t first = instance.objects.size();
+
+        for (uint32_t index = 0; index < count; ++index) {
+            const CMentalSceneObject& record = scene.getObject(index); // open() checked type and parent
+            auto object = std::make_shared<CMentalObject>(std::string(scene.getString(record.name)),
+                                                          static_cast<CMentalObjectType>(record.type));
+            object->setPosition(glm::vec3(record.position[0], record.position[1], record.position[2]));
+            object->setRotation(glm::vec3(record.rotation[0], record.rotation[1], record.rotation[2]));
+            object->setScale(glm::vec3(record.scale[0], record.scale[1], record.scale[2]));
+            object->setStatic((record.flags & SCENE_OBJECT_STATIC) != 0);
+            if (record.script != SCENE_NONE) {
+                object->connectScript(std::string(scene.getString(scene.getResource(record.script).path)));
+            }
+            if (record.mesh == SCENE_NONE && record.type == Triangle) {
+                object->initializeTriangle();
+            }
+            for (const uint32_t resource : { record.mesh, record.texture, record.shader }) {
+                if (resource != SCENE_NONE) {
+                    users[resource].push_back(object);
+                }
+            }
+            if (record.mesh != SCENE_NONE) {
+                for (const uint32_t material : { record.texture, record.shader }) {
+                    std::vector<uint32_t>& used = materials[record.mesh];
+                    if (material != SCENE_NONE && std::find(used.begin(), used.end(), material) == used.end()) {
+                        used.push_back(material);
+                    }
+                }
+            }
+            instance.objects.push_back(std::move(object));
+        }
+
+        for (uint32_t index = 0; index < count; ++index) {
+            const CMentalSceneObject& record = scene.getObject(index);
+            const std::shared_ptr<CMentalObject>& object = instance.objects[first + index];
+            if (record.parent != SCENE_NONE) {
+                instance.objects[first + record.parent]->setNext(object);
+            }
+            if (record.node.length > 0) {
+                std::string node(scene.getString(record.node));
+                world.setNode(node, object);
+                instance.nodes.push_back(std::move(node));
+            }
+        }
+
+        // Textures and shaders first, so each mesh can wait on what it is drawn with: geometry
+        // shows up already textured, and the manager raises materials along with their meshes
+        std::vector<CMentalAssetRef> refs(scene.getResourceCount());
+        for (const bool meshes : { false, true }) {
+            for (uint32_t index = 0; index < scene.getResourceCount(); ++index) {
+                const CMentalSceneResource& resource = scene.getResource(index);
+                if (users[index].empty() || (resource.kind == SceneMesh) != meshes) {
+                    continue;
+                }
+                const std::string path(scene.getString(resource.path));
+                // The callback holds its own handle; the record drops it once the load completes
+                auto shared = std::make_shared<Users>(std::move(users[index]));
+                switch (resource.kind) {
+                    case SceneMesh: {
+                        std::vector<CMentalAssetRef> dependencies;
+                        for (const uint32_t material : materials[index]) {
+                            dependencies.push_back(refs[material]);
+                        }
+                        auto handle = std::make_shared<CMentalAssetHandle<CMentalMeshData>>();
+                        *handle = assets.load<CMentalMeshData>(path, {}, priority, dependencies, [handle, shared, path](MentalAssetState state) {
+                            if (state == Ready) {
+                                const auto mesh = handle->get();
+                                forEachUser(*shared, [&mesh, &path](CMentalObject& object) { object.setMesh(*mesh, path); });
+                            }
+                        });
+                        refs[index] = *handle;
+                        break;
+                    }
+                    case SceneTexture: {
+                        auto handle = std::make_shared<CMentalAssetHandle<CMentalTexture>>();
+                        *handle = assets.load<CMentalTexture>(path, unpackTextureParams(resource), priority, {},
+                                                              [handle, shared](MentalAssetState state) {
+                            if (state == Ready) {
+                                const auto texture = handle->get();
+                                forEachUser(*shared, [&texture](CMentalObject& object) { object.setTexture(texture); });
+                            }
+                        });
+                        refs[index] = *handle;
+                        break;
+                    }
+                    case SceneShader: {
+                        auto handle = std::make_shared<CMentalAssetHandle<CMentalShader>>();
+                        *handle = assets.load<CMentalShader>(path, { std::string(scene.getString(resource.extra)) }, priority, {},
+                                                             [handle, shared](MentalAssetState state) {
+                            if (state == Ready) {
+                                const auto shader = handle->get();
+                                forEachUser(*shared, [&shader](CMentalObject& object) { object.setShader(shader); });
+                            }
+                        });
+                        refs[index] = *handle;
+                        break;
+                    }
+                    default:
+                        break;
+                }
+                if (refs[index].isValid()) {
+                    instance.assets.push_back(refs[index]);
+                }
+            }
+        }
+
+        if (applyEnvironment && scene.hasEnvironment()) {
+            auto environment = std::make_shared<CMentalEnvironment>();
+            const float* color = scene.getEnvironmentColor();
+            environment->setColor(color[0], color[1], color[2], color[3]);
+            world.setEnvironment(environment);
+        }
+        return true;
+    }
+
+    // Takes an instance's nodes back out of the world at the next frame boundary and lets go
+    // of its assets. Objects a frame in flight still draws live until that frame retires
+    static void remove(CMentalWorld& world, CMentalSceneInstance& instance) {
+        for (const std::string& node : instance.nodes) {
+            world.removeNode(node);
+        }
+        instance = CMentalSceneInstance{};
+    }
+};
+
+} // mentalsdk
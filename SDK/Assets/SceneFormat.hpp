@@ -0,0 +1,422 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../Utils/MappedFile.hpp"
+
+namespace mentalsdk
+{
+
+const uint32_t SCENE_MAGIC = 0x4E43534DU; // "MSCN"
+const uint32_t SCENE_VERSION = 1;
+const uint32_t SCENE_NONE = 0xFFFFFFFFU; // Absent parent or resource
+const uint8_t SCENE_OBJECT_TYPE_COUNT = 6; // Object types are CMentalObjectType values below this
+
+const uint8_t SCENE_OBJECT_STATIC = 1U << 0;
+
+const uint8_t SCENE_TEXTURE_MIPMAPS = 1U << 0;
+const uint8_t SCENE_TEXTURE_SRGB = 1U << 1;
+const uint8_t SCENE_TEXTURE_KAISER = 1U << 2;
+const uint8_t SCENE_TEXTURE_STREAMING = 1U << 3;
+
+enum MentalSceneResourceKind : uint8_t {
+    SceneMesh = 0,
+    SceneTexture = 1,
+    SceneShader = 2, // path is the vertex shader, extra the fragment shader
+    SceneScript = 3,
+};
+
+// Records are read in place from the mapped file, so they hold only 4 byte fields and
+// keep the layout below exactly. Files are little endian, like every platform we ship on.
+struct CMentalSceneString {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+};
+
+struct CMentalSceneObject {
+    CMentalSceneString name;
+    CMentalSceneString node; // Key in the world hierarchy; empty for objects only reachable as children
+    uint32_t parent = SCENE_NONE;
+    uint32_t mesh = SCENE_NONE;
+    uint32_t texture = SCENE_NONE;
+    uint32_t shader = SCENE_NONE;
+    uint32_t script = SCENE_NONE;
+    uint8_t type = 0; // CMentalObjectType
+    uint8_t flags = 0;
+    uint16_t reserved = 0;
+    float position[3] = { 0.0F, 0.0F, 0.0F };
+    float rotation[3] = { 0.0F, 0.0F, 0.0F };
+    float scale[3] = { 1.0F, 1.0F, 1.0F };
+    uint32_t padding = 0;
+};
+
+struct CMentalSceneResource {
+    uint8_t kind = SceneMesh;
+    uint8_t textureFlags = SCENE_TEXTURE_MIPMAPS;
+    uint16_t reserved = 0;
+    int32_t wrap = 0; // GL sampler enums, textures only
+    int32_t minFilter = 0;
+    int32_t magFilter = 0;
+    CMentalSceneString path;
+    CMentalSceneString extra;
+};
+
+struct CMentalSceneHeader {
+    uint32_t magic = SCENE_MAGIC;
+    uint32_t version = SCENE_VERSION;
+    uint32_t objectCount = 0;
+    uint32_t resourceCount = 0;
+    uint32_t objectsOffset = 0;
+    uint32_t resourcesOffset = 0;
+    uint32_t stringsOffset = 0;
+    uint32_t stringsSize = 0;
+    uint8_t hasEnvironment = 0;
+    uint8_t environmentType = 0;
+    uint16_t reserved = 0;
+    float environmentColor[4] = { 1.0F, 1.0F, 1.0F, 1.0F };
+    uint32_t padding[3] = {};
+};
+
+static_assert(sizeof(CMentalSceneString) == 8, "scene string layout");
+static_assert(sizeof(CMentalSceneObject) == 80, "scene object layout");
+static_assert(sizeof(CMentalSceneResource) == 32, "scene resource layout");
+static_assert(sizeof(CMentalSceneHeader) == 64, "scene header layout");
+static_assert(std::is_trivially_copyable_v<CMentalSceneObject> && std::is_trivially_copyable_v<CMentalSceneResource>,
+              "scene records are used in place");
+
+// A scene file viewed where it lies. open() checks the header and every index and string
+// reference once, then hands out records straight from the bytes: nothing is parsed or
+// copied, which is what makes large scenes open in about the time it takes to fault in
+// their pages. The bytes can be a mapped file or an archive entry.
+class CMentalSceneView
+{
+private:
+    CMentalFileBytes bytes_;
+    CMentalSceneHeader header_;
+    const CMentalSceneObject* objects_ = nullptr;
+    const CMentalSceneResource* resources_ = nullptr;
+    const char* strings_ = nullptr;
+
+    [[nodiscard]] bool isValidString(const CMentalSceneString& text) const {
+        return text.offset <= header_.stringsSize && text.length <= header_.stringsSize - text.offset;
+    }
+
+    [[nodiscard]] bool isValidResource(uint32_t index, MentalSceneResourceKind kind) const {
+        return index == SCENE_NONE || (index < header_.resourceCount && resources_[index].kind == kind);
+    }
+
+    // Parent links must form a forest: follow each chain until it reaches a root or an object
+    // already known to lead to one. Meeting an object of the current chain means a cycle
+    [[nodiscard]] bool hasParentCycle() const {
+        enum : uint8_t { Unvisited, OnChain, Rooted };
+        std::vector<uint8_t> marks(header_.objectCount, Unvisited);
+        for (uint32_t start = 0; start < header_.objectCount; ++start) {
+            uint32_t index = start;
+            while (index != SCENE_NONE && marks[index] == Unvisited) {
+                marks[index] = OnChain;
+                index = objects_[index].parent;
+            }
+            if (index != SCENE_NONE && marks[index] == OnChain) {
+                return true;
+            }
+            for (index = start; index != SCENE_NONE && marks[index] == OnChain; index = objects_[index].parent) {
+                marks[index] = Rooted;
+            }
+        }
+        return false;
+    }
+
+    static void writeJsonString(std::ostream& stream, std::string_view text) {
+        stream << '"';
+        for (const char character : text) {
+            switch (character) {
+                case '"': stream << "\\\""; break;
+                case '\\': stream << "\\\\"; break;
+                case '\n': stream << "\\n"; break;
+                case '\t': stream << "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(character) < 0x20) {
+                        stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(character) << std::dec;
+                    } else {
+                        stream << character;
+                    }
+            }
+        }
+        stream << '"';
+    }
+
+    static void writeJsonVector(std::ostream& stream, const float* values, size_t count) {
+        stream << '[';
+        for (size_t index = 0; index < count; ++index) {
+            stream << (index > 0 ? ", " : "") << values[index];
+        }
+        stream << ']';
+    }
+
+    void writeJsonIndex(std::ostream& stream, uint32_t index) const {
+        if (index == SCENE_NONE) {
+            stream << "null";
+        } else {
+            stream << index;
+        }
+    }
+
+public:
+    CMentalSceneView() = default;
+    ~CMentalSceneView() = default;
+
+    CMentalSceneView(const CMentalSceneView&) = delete;
+    CMentalSceneView& operator=(const CMentalSceneView&) = delete;
+    CMentalSceneView(CMentalSceneView&&) = delete;
+    CMentalSceneView& operator=(CMentalSceneView&&) = delete;
+
+    bool open(const std::string& filePath) {
+        CMentalFileBytes bytes = CMentalFileBytes::map(filePath);
+        if (!bytes.isValid()) {
+            std::cerr << "Error: Could not open scene " << filePath << "\n";
+            return false;
+        }
+        return this->open(std::move(bytes), filePath);
+    }
+
+    // name is for messages
+    bool open(CMentalFileBytes bytes, const std::string& name) {
+        bytes_ = std::move(bytes);
+        objects_ = nullptr;
+        resources_ = nullptr;
+        strings_ = nullptr;
+        header_ = CMentalSceneHeader{};
+
+        const auto fail = [this, &name](const char* reason) {
+            std::cerr << "Error: Scene " << name << " is " << reason << "\n";
+            bytes_ = CMentalFileBytes{};
+            objects_ = nullptr;
+            resources_ = nullptr;
+            strings_ = nullptr;
+            header_ = CMentalSceneHeader{};
+            return false;
+        };
+        const size_t size = bytes_.size;
+        if (bytes_.data == nullptr || size < sizeof(CMentalSceneHeader)) {
+            return fail("not a scene file");
+        }
+        std::memcpy(&header_, bytes_.data, sizeof(header_));
+        if (header_.magic != SCENE_MAGIC) {
+            return fail("not a scene file");
+        }
+        if (header_.version != SCENE_VERSION) {
+            return fail("from an unsupported version");
+        }
+        if (reinterpret_cast<uintptr_t>(bytes_.data) % alignof(CMentalSceneObject) != 0 ||
+            header_.objectsOffset % alignof(CMentalSceneObject) != 0 || header_.resourcesOffset % alignof(CMentalSceneResource) != 0) {
+            return fail("misaligned");
+        }
+        if (header_.objectsOffset > size || static_cast<uint64_t>(header_.objectCount) * sizeof(CMentalSceneObject) > size - header_.objectsOffset ||
+            header_.resourcesOffset > size ||
+            static_cast<uint64_t>(header_.resourceCount) * sizeof(CMentalSceneResource) > size - header_.resourcesOffset ||
+            header_.stringsOffset > size || header_.stringsSize > size - header_.stringsOffset) {
+            return fail("truncated");
+        }
+
+        // The fixup: section offsets become typed pointers into the bytes
+        objects_ = reinterpret_cast<const CMentalSceneObject*>(bytes_.data + header_.objectsOffset);
+        resources_ = reinterpret_cast<const CMentalSceneResource*>(bytes_.data + header_.resourcesOffset);
+        strings_ = reinterpret_cast<const char*>(bytes_.data + header_.stringsOffset);
+
+        for (uint32_t index = 0; index < header_.resourceCount; ++index) {
+            const CMentalSceneResource& resource = resources_[index];
+            if (resource.kind > SceneScript || !this->isValidString(resource.path) || !this->isValidString(resource.extra)) {
+                return fail("corrupt");
+            }
+        }
+        for (uint32_t index = 0; index < header_.objectCount; ++index) {
+            const CMentalSceneObject& object = objects_[index];
+            if (!this->isValidString(object.name) || !this->isValidString(object.node) ||
+                (object.parent != SCENE_NONE && (object.parent >= header_.objectCount || object.parent == index)) ||
+                object.type >= SCENE_OBJECT_TYPE_COUNT || !this->isValidResource(object.mesh, SceneMesh) ||
+                !this->isValidResource(object.texture, SceneTexture) || !this->isValidResource(object.shader, SceneShader) ||
+                !this->isValidResource(object.script, SceneScript)) {
+                return fail("corrupt");
+            }
+        }
+        if (this->hasParentCycle()) {
+            return fail("corrupt (its parent links form a cycle)");
+        }
+        return true;
+    }
+
+    // One object per line, so scene diffs stay readable
+    void exportJson(std::ostream& stream) const {
+        const char* const kinds[] = { "mesh", "texture", "shader", "script" };
+        stream << "{\n  \"version\": " << header_.version << ",\n  \"environment\": ";
+        if (header_.hasEnvironment != 0) {
+            stream << "{\"type\": " << static_cast<int>(header_.environmentType) << ", \"color\": ";
+            writeJsonVector(stream, header_.environmentColor, 4);
+            stream << "}";
+        } else {
+            stream << "null";
+        }
+
+        stream << ",\n  \"resources\": [";
+        for (uint32_t index = 0; index < header_.resourceCount; ++index) {
+            const CMentalSceneResource& resource = resources_[index];
+            stream << (index > 0 ? "," : "") << "\n    {\"kind\": \"" << kinds[resource.kind] << "\", \"path\": ";
+            writeJsonString(stream, this->getString(resource.path));
+            if (resource.kind == SceneShader) {
+                stream << ", \"fragment\": ";
+                writeJsonString(stream, this->getString(resource.extra));
+            } else if (resource.kind == SceneTexture) {
+                stream << ", \"wrap\": " << resource.wrap << ", \"minFilter\": " << resource.minFilter
+                       << ", \"magFilter\": " << resource.magFilter << ", \"flags\": " << static_cast<int>(resource.textureFlags);
+            }
+            stream << "}";
+        }
+
+        stream << "\n  ],\n  \"objects\": [";
+        for (uint32_t index = 0; index < header_.objectCount; ++index) {
+            const CMentalSceneObject& object = objects_[index];
+            stream << (index > 0 ? "," : "") << "\n    {\"name\": ";
+            writeJsonString(stream, this->getString(object.name));
+            stream << ", \"node\": ";
+            writeJsonString(stream, this->getString(object.node));
+            stream << ", \"type\": " << static_cast<int>(object.type) << ", \"static\": " << ((object.flags & SCENE_OBJECT_STATIC) != 0 ? "true" : "false");
+            stream << ", \"parent\": ";
+            this->writeJsonIndex(stream, object.parent);
+            stream << ", \"position\": ";
+            writeJsonVector(stream, object.position, 3);
+            stream << ", \"rotation\": ";
+            writeJsonVector(stream, object.rotation, 3);
+            stream << ", \"scale\": ";
+            writeJsonVector(stream, object.scale, 3);
+            stream << ", \"mesh\": ";
+            this->writeJsonIndex(stream, object.mesh);
+            stream << ", \"texture\": ";
+            this->writeJsonIndex(stream, object.texture);
+            stream << ", \"shader\": ";
+            this->writeJsonIndex(stream, object.shader);
+            stream << ", \"script\": ";
+            this->writeJsonIndex(stream, object.script);
+            stream << "}";
+        }
+        stream << "\n  ]\n}\n";
+    }
+
+    [[nodiscard]] bool isOpen() const { return objects_ != nullptr; }
+    [[nodiscard]] uint32_t getObjectCount() const { return header_.objectCount; }
+    [[nodiscard]] const CMentalSceneObject& getObject(uint32_t index) const { return objects_[index]; }
+    [[nodiscard]] uint32_t getResourceCount() const { return header_.resourceCount; }
+    [[nodiscard]] const CMentalSceneResource& getResource(uint32_t index) const { return resources_[index]; }
+    [[nodiscard]] std::string_view getString(const CMentalSceneString& text) const { return { strings_ + text.offset, text.length }; }
+    [[nodiscard]] bool hasEnvironment() const { return header_.hasEnvironment != 0; }
+    [[nodiscard]] uint8_t getEnvironmentType() const { return header_.environmentType; }
+    [[nodiscard]] const float* getEnvironmentColor() const { return header_.environmentColor; }
+};
+
+// Builds a scene file: strings and resources are stored once however often they are used
+class CMentalSceneWriter
+{
+private:
+    std::vector<CMentalSceneObject> objects_;
+    std::vector<CMentalSceneResource> resources_;
+    std::string strings_;
+    std::unordered_map<std::string, CMentalSceneString> stringIndex_;
+    std::unordered_map<std::string, uint32_t> resourceIndex_;
+    CMentalSceneHeader header_;
+
+public:
+    CMentalSceneString addString(std::string_view text) {
+        if (text.empty()) {
+            return {};
+        }
+        auto [entry, inserted] = stringIndex_.try_emplace(std::string(text));
+        if (inserted) {
+            entry->second = CMentalSceneString{ static_cast<uint32_t>(strings_.size()), static_cast<uint32_t>(text.size()) };
+            strings_.append(text);
+        }
+        return entry->second;
+    }
+
+    // Returns the index to store in objects; sampler fields only matter for textures
+    uint32_t addResource(MentalSceneResourceKind kind, const std::string& path, const std::string& extra = {},
+                         int32_t wrap = 0, int32_t minFilter = 0, int32_t magFilter = 0, uint8_t textureFlags = SCENE_TEXTURE_MIPMAPS) {
+        if (path.empty()) {
+            return SCENE_NONE;
+        }
+        const std::string key = std::to_string(kind) + "|" + path + "|" + extra + "|" + std::to_string(wrap) + ":" +
+                                std::to_string(minFilter) + ":" + std::to_string(magFilter) + ":" + std::to_string(textureFlags);
+        const auto found = resourceIndex_.find(key);
+        if (found != resourceIndex_.end()) {
+            return found->second;
+        }
+        CMentalSceneResource resource;
+        resource.kind = kind;
+        resource.textureFlags = textureFlags;
+        resource.wrap = wrap;
+        resource.minFilter = minFilter;
+        resource.magFilter = magFilter;
+        resource.path = this->addString(path);
+        resource.extra = this->addString(extra);
+        const auto index = static_cast<uint32_t>(resources_.size());
+        resources_.push_back(resource);
+        resourceIndex_.emplace(key, index);
+        return index;
+    }
+
+    uint32_t addObject(const CMentalSceneObject& object) {
+        objects_.push_back(object);
+        return static_cast<uint32_t>(objects_.size() - 1);
+    }
+    [[nodiscard]] CMentalSceneObject& getObject(uint32_t index) { return objects_[index]; }
+    [[nodiscard]] size_t getObjectCount() const { return objects_.size(); }
+
+    void setEnvironment(uint8_t type, const float* color) {
+        header_.hasEnvironment = 1;
+        header_.environmentType = type;
+        std::memcpy(header_.environmentColor, color, sizeof(header_.environmentColor));
+    }
+
+    bool write(std::ostream& stream) const {
+        CMentalSceneHeader header = header_;
+        header.objectCount = static_cast<uint32_t>(objects_.size());
+        header.resourceCount = static_cast<uint32_t>(resources_.size());
+        const uint64_t objectsBytes = objects_.size() * sizeof(CMentalSceneObject);
+        const uint64_t resourcesBytes = resources_.size() * sizeof(CMentalSceneResource);
+        if (sizeof(header) + objectsBytes + resourcesBytes + strings_.size() > UINT32_MAX) {
+            std::cerr << "Error: Scene is too large for format version " << SCENE_VERSION << "\n";
+            return false;
+        }
+        header.objectsOffset = static_cast<uint32_t>(sizeof(header));
+        header.resourcesOffset = static_cast<uint32_t>(header.objectsOffset + objectsBytes);
+        header.stringsOffset = static_cast<uint32_t>(header.resourcesOffset + resourcesBytes);
+        header.stringsSize = static_cast<uint32_t>(strings_.size());
+
+        // Header and record sizes are multiples of 16, so every section starts aligned
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char*>(objects_.data()), static_cast<std::streamsize>(objectsBytes));
+        stream.write(reinterpret_cast<const char*>(resources_.data()), static_cast<std::streamsize>(resourcesBytes));
+        stream.write(strings_.data(), static_cast<std::streamsize>(strings_.size()));
+        return static_cast<bool>(stream);
+    }
+
+    bool write(const std::string& filePath) const {
+        std::ofstream file(filePath, std::ios::binary);
+        if (!file.is_open() || !this->write(file)) {
+            std::cerr << "Error: Could not write scene " << filePath << "\n";
+            return false;
+        }
+        return true;
+    }
+};
+
+} // mentalsdk
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+#include "AssetManager.hpp"
+#include "Scene.hpp"
+#include "SceneFormat.hpp"
+#include "../Objects/World.hpp"
+
+namespace mentalsdk
+{
+
+const uint32_t WORLD_INDEX_MAGIC = 0x444C574DU; // "MWLD"
+const uint32_t WORLD_INDEX_VERSION = 1;
+const float DEFAULT_STREAMING_LOAD_RADIUS = 200.0F;
+const float DEFAULT_STREAMING_UNLOAD_RADIUS = 250.0F; // The gap keeps cells at the edge from flickering in and out
+const size_t DEFAULT_STREAMING_CELLS_PER_UPDATE = 2; // Instantiation is GL thread work, spread it over frames
+
+enum MentalCellState : uint8_t {
+    CellUnloaded = 0,
+    CellLoading = 1,
+    CellLoaded = 2,
+    CellFailed = 3, // Retried once the camera has left and come back
+};
+
+// Index file: a header and one record per non-empty cell, little endian like scene files
+struct CMentalWorldIndexHeader {
+    uint32_t magic = WORLD_INDEX_MAGIC;
+    uint32_t version = WORLD_INDEX_VERSION;
+    uint32_t cellCount = 0;
+    float cellSize = 0.0F;
+};
+
+struct CMentalWorldCellRecord {
+    int32_t x = 0;
+    int32_t z = 0;
+    uint32_t objectCount = 0;
+    uint32_t reserved = 0;
+};
+
+struct CMentalWorldCell {
+    int32_t x = 0;
+    int32_t z = 0;
+    uint32_t objectCount = 0;
+    std::string path;
+    MentalCellState state = CellUnloaded;
+    float distance = 0.0F; // From the camera, as of the last update()
+    CMentalAssetHandle<CMentalSceneView> view; // Held only while loading
+    CMentalSceneInstance instance;
+};
+
+// Keeps the part of a large world near the camera in memory. partition() splits a world on
+// a square grid over XZ into one scene file per cell plus an index; update() then loads
+// cells within the load radius and drops those beyond the unload radius. Cell files and
+// the assets they use load through the asset manager, closer first, so two cells using
+// the same mesh share one load and an asset goes away with the last cell using it.
+//
+// GL thread, in the frame sync stage (CMentalRenderer::setFrameSync) when rendering is
+// threaded. The caller keeps driving the asset manager (update() and dispatchCallbacks())
+// before update(); the world applies the node changes after it, in synchronize().
+class CMentalWorldStreamer
+{
+private:
+    CMentalWorld& world_;
+    CMentalAssetManager& assets_;
+    std::vector<CMentalWorldCell> cells_;
+    float cellSize_ = 0.0F;
+    float loadRadius_ = DEFAULT_STREAMING_LOAD_RADIUS;
+    float unloadRadius_ = DEFAULT_STREAMING_UNLOAD_RADIUS;
+    size_t cellsPerUpdate_ = DEFAULT_STREAMING_CELLS_PER_UPDATE;
+    std::vector<CMentalWorldCell*> pending_;
+
+    static std::string getCellName(int32_t x, int32_t z) {
+        return "cell_" + std::to_string(x) + "_" + std::to_string(z) + ".mscn";
+    }
+
+    // To the nearest point of the cell's square, so the camera's own cell is at zero
+    [[nodiscard]] float getDistance(const CMentalWorldCell& cell, const glm::vec3& camera) const {
+        const float minX = static_cast<float>(cell.x) * cellSize_;
+        const float minZ = static_cast<float>(cell.z) * cellSize_;
+        const float dx = std::max({ minX - camera.x, 0.0F, camera.x - (minX + cellSize_) });
+        const float dz = std::max({ minZ - camera.z, 0.0F, camera.z - (minZ + cellSize_) });
+        return std::sqrt(dx * dx + dz * dz);
+    }
+
+    // Nearer loads first, in the asset manager's terms
+    static int getPriority(float distance) { return -static_cast<int>(std::min(distance, 1e9F)); }
+
+    void unload(CMentalWorldCell& cell) {
+        if (cell.state == CellLoaded) {
+            CMentalScene::remove(world_, cell.instance);
+        }
+        cell.view = CMentalAssetHandle<CMentalSceneView>{};
+        cell.state = CellUnloaded;
+    }
+
+public:
+    CMentalWorldStreamer(CMentalWorld& world, CMentalAssetManager& assets) : world_(world), assets_(assets) {}
+    ~CMentalWorldStreamer() { this->unloadAll(); }
+
+    CMentalWorldStreamer(const CMentalWorldStreamer&) = delete;
+    CMentalWorldStreamer& operator=(const CMentalWorldStreamer&) = delete;
+    CMentalWorldStreamer(CMentalWorldStreamer&&) = delete;
+    CMentalWorldStreamer& operator=(CMentalWorldStreamer&&) = delete;
+
+    // Writes cell files next to indexPath. Objects go to the cell holding their bounds'
+    // center, children with the node that links them. Queued node changes are not written
+    static bool partition(const CMentalWorld& world, float cellSize, const std::string& indexPath) {
+        if (cellSize <= 0.0F) {
+            return false;
+        }
+        struct Cell {
+            CMentalSceneWriter writer;
+            std::unordered_map<const CMentalObject*, uint32_t> indices;
+        };
+        std::map<std::pair<int32_t, int32_t>, Cell> cells;
+        if (const auto hierarchy = world.getHierarchy()) {
+            for (const auto& [node, object] : *hierarchy) {
+                if (!object) {
+                    continue;
+                }
+                const AABB bounds = object->getWorldBounds();
+                const glm::vec3 center = bounds.min.x <= bounds.max.x ? bounds.getCenter() : object->getPosition();
+                const std::pair<int32_t, int32_t> key{ static_cast<int32_t>(std::floor(center.x / cellSize)),
+                                                       static_cast<int32_t>(std::floor(center.z / cellSize)) };
+                Cell& cell = cells[key];
+                CMentalScene::addNode(cell.writer, *object, node, cell.indices);
+            }
+        }
+
+        const std::filesystem::path directory = std::filesystem::path(indexPath).parent_path();
+        CMentalWorldIndexHeader header;
+        header.cellCount = static_cast<uint32_t>(cells.size());
+        header.cellSize = cellSize;
+        std::vector<CMentalWorldCellRecord> records;
+        for (const auto& [key, cell] : cells) {
+            if (!cell.writer.write((directory / getCellName(key.first, key.second)).string())) {
+                return false;
+            }
+            records.push_back({ key.first, key.second, static_cast<uint32_t>(cell.writer.getObjectCount()), 0 });
+        }
+
+        std::ofstream file(indexPath, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(CMentalWorldCellRecord)));
+        if (!file) {
+            std::cerr << "Error: Could not write world index " << indexPath << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    // Reads through the asset manager's source, so the index and cells may sit in an archive
+    bool open(const std::string& indexPath) {
+        this->unloadAll();
+        cells_.clear();
+        const CMentalFileBytes bytes = assets_.getSource()->read(indexPath);
+        CMentalWorldIndexHeader header;
+        if (!bytes.isValid() || bytes.size < sizeof(header)) {
+            std::cerr << "Error: Could not open world index " << indexPath << "\n";
+            return false;
+        }
+        std::memcpy(&header, bytes.data, sizeof(header));
+        if (header.magic != WORLD_INDEX_MAGIC || header.version != WORLD_INDEX_VERSION || !(header.cellSize > 0.0F) ||
+            static_cast<uint64_t>(header.cellCount) * sizeof(CMentalWorldCellRecord) > bytes.size - sizeof(header)) {
+            std::cerr << "Error: " << indexPath << " is not a readable world index\n";
+            return false;
+        }
+
+        cellSize_ = header.cellSize;
+        const std::filesystem::path directory = std::filesystem::path(indexPath).parent_path();
+        cells_.resize(header.cellCount);
+        for (uint32_t index = 0; index < header.cellCount; ++index) {
+            CMentalWorldCellRecord record;
+            std::memcpy(&record, bytes.data + sizeof(header) + index * sizeof(record), sizeof(record));
+            CMentalWorldCell& cell = cells_[index];
+            cell.x = record.x;
+            cell.z = record.z;
+            cell.objectCount = record.objectCount;
+            cell.path = (directory / getCellName(record.x, record.z)).generic_string();
+        }
+        return true;
+    }
+
+    // Once per frame with the point streaming centers on, usually the camera
+    void update(const glm::vec3& camera) {
+        bool unloaded = false;
+        pending_.clear();
+        for (CMentalWorldCell& cell : cells_) {
+            cell.distance = this->getDistance(cell, camera);
+            if (cell.state != CellUnloaded && cell.distance > unloadRadius_) {
+                this->unload(cell);
+                unloaded = true;
+            } else if (cell.state == CellUnloaded && cell.distance <= loadRadius_) {
+                cell.view = assets_.load<CMentalSceneView>(cell.path, {}, getPriority(cell.distance));
+                cell.state = CellLoading;
+            } else if (cell.state == CellLoading) {
+                // Requesting again moves a still queued cell up as the camera approaches
+                assets_.load<CMentalSceneView>(cell.path, {}, getPriority(cell.distance));
+                if (cell.view.isDone()) {
+                    pending_.push_back(&cell);
+                }
+            }
+        }
+
+        std::sort(pending_.begin(), pending_.end(),
+                  [](const CMentalWorldCell* lhs, const CMentalWorldCell* rhs) { return lhs->distance < rhs->distance; });
+        for (size_t index = 0; index < std::min(pending_.size(), cellsPerUpdate_); ++index) {
+            CMentalWorldCell& cell = *pending_[index];
+            const std::shared_ptr<CMentalSceneView> view = cell.view.get();
+            if (view && CMentalScene::instantiate(*view, world_, assets_, cell.instance, getPriority(cell.distance), false)) {
+                cell.state = CellLoaded;
+            } else {
+                std::cerr << "Error: Could not stream in world cell " << cell.path << "\n";
+                cell.state = CellFailed;
+            }
+            cell.view = CMentalAssetHandle<CMentalSceneView>{}; // Objects are built; the mapping can go
+        }
+
+        if (unloaded) {
+            assets_.purge(); // Frees what only the dropped cells used
+        }
+    }
+
+    void unloadAll() {
+        for (CMentalWorldCell& cell : cells_) {
+            this->unload(cell);
+        }
+        assets_.purge();
+    }
+
+    // The unload radius never drops below the load radius
+    void setLoadRadius(float radius) {
+        loadRadius_ = std::max(radius, 0.0F);
+        unloadRadius_ = std::max(unloadRadius_, loadRadius_);
+    }
+    void setUnloadRadius(float radius) { unloadRadius_ = std::max(radius, loadRadius_); }
+    void setCellsPerUpdate(size_t count) { cellsPerUpdate_ = std::max<size_t>(count, 1); }
+
+    [[nodiscard]] float getCellSize() const { return cellSize_; }
+    [[nodiscard]] float getLoadRadius() const { return loadRadius_; }
+    [[nodiscard]] float getUnloadRadius() const { return unloadRadius_; }
+    [[nodiscard]] const std::vector<CMentalWorldCell>& getCells() const { return cells_; }
+    [[nodiscard]] size_t getCellCount(MentalCellState state) const {
+        return static_cast<size_t>(std::count_if(cells_.begin(), cells_.end(),
+                                                 [state](const CMentalWorldCell& cell) { return cell.state == state; }));
+    }
+};
+
+} // mentalsdk
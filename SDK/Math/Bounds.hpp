@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <glm/glm.hpp>
+
+namespace mentalsdk
+{
+
+struct AABB {
+    glm::vec3 min{ std::numeric_limits<float>::max() };
+    glm::vec3 max{ -std::numeric_limits<float>::max() };
+
+    [[nodiscard]] bool isValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+    [[nodiscard]] glm::vec3 getCenter() const { return (min + max) * 0.5F; }
+    [[nodiscard]] glm::vec3 getExtent() const { return max - min; }
+
+    [[nodiscard]] float getSurfaceArea() const {
+        if (!this->isValid()) {
+            return 0.0F;
+        }
+        const glm::vec3 extent = this->getExtent();
+        return 2.0F * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+    }
+
+    void expand(const glm::vec3& point) {
+        this->min = glm::min(this->min, point);
+        this->max = glm::max(this->max, point);
+    }
+
+    void expand(const AABB& other) {
+        this->min = glm::min(this->min, other.min);
+        this->max = glm::max(this->max, other.max);
+    }
+
+    [[nodiscard]] bool overlaps(const AABB& other) const {
+        return min.x <= other.max.x && max.x >= other.min.x &&
+               min.y <= other.max.y && max.y >= other.min.y &&
+               min.z <= other.max.z && max.z >= other.min.z;
+    }
+
+    // Arvo's method: bounds of the transformed box without transforming all 8 corners
+    [[nodiscard]] AABB transformed(const glm::mat4& matrix) const {
+        if (!this->isValid()) {
+            return {};
+        }
+        AABB result;
+        result.min = glm::vec3(matrix[3]);
+        result.max = glm::vec3(matrix[3]);
+        for (int column = 0; column < 3; ++column) {
+            for (int row = 0; row < 3; ++row) {
+                const float first = matrix[column][row] * this->min[column];
+                const float second = matrix[column][row] * this->max[column];
+                result.min[row] += first < second ? first : second;
+                result.max[row] += first < second ? second : first;
+            }
+        }
+        return result;
+    }
+};
+
+struct Ray {
+    glm::vec3 origin{ 0.0F };
+    glm::vec3 direction{ 0.0F, 0.0F, -1.0F };
+
+    // Slab test, returns entry distance or a negative value on miss
+    [[nodiscard]] float intersect(const AABB& box, const glm::vec3& inverseDirection, float maxDistance) const {
+        float tmin = 0.0F;
+        float tmax = maxDistance;
+        for (int axis = 0; axis < 3; ++axis) {
+            float near = (box.min[axis] - origin[axis]) * inverseDirection[axis];
+            float far = (box.max[axis] - origin[axis]) * inverseDirection[axis];
+            if (near > far) {
+                const float swap = near;
+                near = far;
+                far = swap;
+            }
+            tmin = near > tmin ? near : tmin;
+            tmax = far < tmax ? far : tmax;
+            if (tmin > tmax) {
+                return -1.0F;
+            }
+        }
+        return tmin;
+    }
+
+    // Moller-Trumbore, returns hit distance or a negative value on miss
+    [[nodiscard]] float intersect(const glm::vec3& vertex0, const glm::vec3& vertex1, const glm::vec3& vertex2) const {
+        const float epsilon = 1e-7F;
+        const glm::vec3 edge1 = vertex1 - vertex0;
+        const glm::vec3 edge2 = vertex2 - vertex0;
+        const glm::vec3 pvec = glm::cross(direction, edge2);
+        const float det = glm::dot(edge1, pvec);
+        if (std::fabs(det) < epsilon) {
+            return -1.0F;
+        }
+        const float invDet = 1.0F / det;
+        const glm::vec3 tvec = origin - vertex0;
+        const float u = glm::dot(tvec, pvec) * invDet;
+        if (u < 0.0F || u > 1.0F) {
+            return -1.0F;
+        }
+        const glm::vec3 qvec = glm::cross(tvec, edge1);
+        const float v = glm::dot(direction, qvec) * invDet;
+        if (v < 0.0F || u + v > 1.0F) {
+            return -1.0F;
+        }
+        return glm::dot(edge2, qvec) * invDet;
+    }
+};
+
+enum MentalCullResult : uint8_t {
+    Outside = 0,
+    Intersecting = 1,
+    Inside = 2,
+};
+
+struct Frustum {
+    glm::vec4 planes[6];
+
+    // Gribb/Hartmann plane extraction from a column-major view-projection matrix
+    static Frustum fromMatrix(const glm::mat4& viewProjection) {
+        Frustum frustum{};
+        for (int axis = 0; axis < 3; ++axis) {
+            for (int component = 0; component < 4; ++component) {
+                frustum.planes[axis * 2][component] = viewProjection[component][3] + viewProjection[component][axis];
+                frustum.planes[axis * 2 + 1][component] = viewProjection[component][3] - viewProjection[component][axis];
+            }
+        }
+        for (auto& plane : frustum.planes) {
+            const float length = glm::length(glm::vec3(plane));
+            if (length > 0.0F) {
+                plane = plane * (1.0F / length);
+            }
+        }
+        return frustum;
+    }
+
+    [[nodiscard]] MentalCullResult classify(const AABB& box) const {
+        if (!box.isValid()) {
+            return MentalCullResult::Outside;
+        }
+        const glm::vec3 center = box.getCenter();
+        const glm::vec3 halfExtent = box.getExtent() * 0.5F;
+        MentalCullResult result = MentalCullResult::Inside;
+        for (const auto& plane : planes) {
+            const glm::vec3 normal(plane);
+            const float distance = glm::dot(normal, center) + plane.w;
+            const float radius = glm::dot(glm::abs(normal), halfExtent);
+            if (distance < -radius) {
+                return MentalCullResult::Outside;
+            }
+            if (distance < radius) {
+                result = MentalCullResult::Intersecting;
+            }
+        }
+        return result;
+    }
+};
+
+} // mentalsdk
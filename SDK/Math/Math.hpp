@@ -1,36 +1,220 @@
 #pragma once
 
-#include <memory>
+#include <cmath>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define MENTAL_MATH_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MENTAL_MATH_NEON 1
+#endif
+
 namespace mentalsdk
 {
 
+// Plain value types, no heap. Layouts match glm so conversions are copies.
+
+template <typename T>
+struct Vector2 {
+    T x;
+    T y;
+
+    constexpr Vector2 operator+(const Vector2& other) const { return { x + other.x, y + other.y }; }
+    constexpr Vector2 operator-(const Vector2& other) const { return { x - other.x, y - other.y }; }
+    constexpr Vector2 operator*(T scalar) const { return { x * scalar, y * scalar }; }
+    constexpr bool operator==(const Vector2& other) const { return x == other.x && y == other.y; }
+    constexpr bool operator!=(const Vector2& other) const { return !(*this == other); }
+};
+
 template <typename T>
 struct Vector3 {
     T x;
     T y;
     T z;
+
+    constexpr Vector3 operator+(const Vector3& other) const { return { x + other.x, y + other.y, z + other.z }; }
+    constexpr Vector3 operator-(const Vector3& other) const { return { x - other.x, y - other.y, z - other.z }; }
+    constexpr Vector3 operator*(T scalar) const { return { x * scalar, y * scalar, z * scalar }; }
+    constexpr Vector3 operator*(const Vector3& other) const { return { x * other.x, y * other.y, z * other.z }; }
+    constexpr bool operator==(const Vector3& other) const { return x == other.x && y == other.y && z == other.z; }
+    constexpr bool operator!=(const Vector3& other) const { return !(*this == other); }
 };
 
+// 16-byte aligned so a whole vector fits one SSE/NEON register
 template <typename T>
-struct Vector2 {
+struct alignas(4 * sizeof(T)) Vector4 {
     T x;
     T y;
+    T z;
+    T w;
+
+    constexpr Vector4 operator+(const Vector4& other) const { return { x + other.x, y + other.y, z + other.z, w + other.w }; }
+    constexpr Vector4 operator-(const Vector4& other) const { return { x - other.x, y - other.y, z - other.z, w - other.w }; }
+    constexpr Vector4 operator*(T scalar) const { return { x * scalar, y * scalar, z * scalar, w * scalar }; }
+    constexpr bool operator==(const Vector4& other) const { return x == other.x && y == other.y && z == other.z && w == other.w; }
 };
 
 template <typename T>
-std::shared_ptr<Vector3<T>> vec3(T first_value = 1.0F, T second_value = 1.0F, T third_value = 1.0F)
+constexpr Vector2<T> vec2(T first_value = 1.0F, T second_value = 1.0F)
+{
+    return Vector2<T>{first_value, second_value};
+}
+
+template <typename T>
+constexpr Vector3<T> vec3(T first_value = 1.0F, T second_value = 1.0F, T third_value = 1.0F)
+{
+    return Vector3<T>{first_value, second_value, third_value};
+}
+
+template <typename T>
+constexpr Vector4<T> vec4(T first_value = 1.0F, T second_value = 1.0F, T third_value = 1.0F, T fourth_value = 1.0F)
 {
-    return std::make_shared<Vector3<T>>(Vector3<T>{first_value, second_value, third_value});
+    return Vector4<T>{first_value, second_value, third_value, fourth_value};
 }
 
 template <typename T>
-std::shared_ptr<Vector2<T>> vec2(T first_value = 1.0F, T second_value = 1.0F)
+constexpr T dot(const Vector3<T>& lhs, const Vector3<T>& rhs) { return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z; }
+
+template <typename T>
+constexpr Vector3<T> cross(const Vector3<T>& lhs, const Vector3<T>& rhs)
 {
-    return std::make_shared<Vector2<T>>(Vector2<T>{first_value, second_value});
+    return { lhs.y * rhs.z - lhs.z * rhs.y, lhs.z * rhs.x - lhs.x * rhs.z, lhs.x * rhs.y - lhs.y * rhs.x };
 }
 
+template <typename T>
+struct alignas(4 * sizeof(T)) Quaternion {
+    T x = 0;
+    T y = 0;
+    T z = 0;
+    T w = 1;
+
+    static constexpr Quaternion identity() { return {}; }
+
+    static Quaternion fromAxisAngle(const Vector3<T>& axis, T angle) {
+        const T half = angle * static_cast<T>(0.5);
+        const T sine = std::sin(half);
+        return { axis.x * sine, axis.y * sine, axis.z * sine, std::cos(half) };
+    }
+
+    // Same convention as CMentalObject rotation: X, then Y, then Z applied as Rx * Ry * Rz
+    static Quaternion fromEuler(const Vector3<T>& angles) {
+        return fromAxisAngle({1, 0, 0}, angles.x) * fromAxisAngle({0, 1, 0}, angles.y) * fromAxisAngle({0, 0, 1}, angles.z);
+    }
+
+    constexpr Quaternion operator*(const Quaternion& other) const {
+        return { w * other.x + x * other.w + y * other.z - z * other.y,
+                 w * other.y - x * other.z + y * other.w + z * other.x,
+                 w * other.z + x * other.y - y * other.x + z * other.w,
+                 w * other.w - x * other.x - y * other.y - z * other.z };
+    }
+
+    constexpr Vector3<T> rotate(const Vector3<T>& vector) const {
+        const Vector3<T> axis{ x, y, z };
+        const Vector3<T> twice = cross(axis, vector) * static_cast<T>(2);
+        return vector + twice * w + cross(axis, twice);
+    }
+};
+
+using Float2 = Vector2<float>;
+using Float3 = Vector3<float>;
+using Float4 = Vector4<float>;
+using Quat = Quaternion<float>;
+
+// Column-major 4x4, column c / row r lives at columns[c] component r like glm::mat4
+struct alignas(16) Matrix4 {
+    Float4 columns[4];
 
+    static constexpr Matrix4 identity() {
+        return { { {1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1} } };
+    }
 
+    // Translation * Rx * Ry * Rz * Scale in closed form, equivalent to the glm::translate/rotate/scale chain
+    static Matrix4 fromTRS(const Float3& position, const Float3& rotation, const Float3& scale) {
+        const float sx = std::sin(rotation.x);
+        const float cx = std::cos(rotation.x);
+        const float sy = std::sin(rotation.y);
+        const float cy = std::cos(rotation.y);
+        const float sz = std::sin(rotation.z);
+        const float cz = std::cos(rotation.z);
+        Matrix4 result{};
+        result.columns[0] = Float4{ cy * cz, sx * sy * cz + cx * sz, sx * sz - cx * sy * cz, 0.0F } * scale.x;
+        result.columns[1] = Float4{ -cy * sz, cx * cz - sx * sy * sz, cx * sy * sz + sx * cz, 0.0F } * scale.y;
+        result.columns[2] = Float4{ sy, -sx * cy, cx * cy, 0.0F } * scale.z;
+        result.columns[3] = Float4{ position.x, position.y, position.z, 1.0F };
+        return result;
+    }
 
+    static Matrix4 fromQuaternion(const Quat& rotation) {
+        const float xx = rotation.x * rotation.x;
+        const float yy = rotation.y * rotation.y;
+        const float zz = rotation.z * rotation.z;
+        const float xy = rotation.x * rotation.y;
+        const float xz = rotation.x * rotation.z;
+        const float yz = rotation.y * rotation.z;
+        const float wx = rotation.w * rotation.x;
+        const float wy = rotation.w * rotation.y;
+        const float wz = rotation.w * rotation.z;
+        return { { { 1 - 2 * (yy + zz), 2 * (xy + wz), 2 * (xz - wy), 0 },
+                   { 2 * (xy - wz), 1 - 2 * (xx + zz), 2 * (yz + wx), 0 },
+                   { 2 * (xz + wy), 2 * (yz - wx), 1 - 2 * (xx + yy), 0 },
+                   { 0, 0, 0, 1 } } };
+    }
+
+    [[nodiscard]] Float4 transform(const Float4& vector) const {
+#if defined(MENTAL_MATH_SSE)
+        __m128 result = _mm_mul_ps(_mm_load_ps(&columns[0].x), _mm_set1_ps(vector.x));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(&columns[1].x), _mm_set1_ps(vector.y)));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(&columns[2].x), _mm_set1_ps(vector.z)));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(&columns[3].x), _mm_set1_ps(vector.w)));
+        Float4 output;
+        _mm_store_ps(&output.x, result);
+        return output;
+#elif defined(MENTAL_MATH_NEON)
+        float32x4_t result = vmulq_n_f32(vld1q_f32(&columns[0].x), vector.x);
+        result = vmlaq_n_f32(result, vld1q_f32(&columns[1].x), vector.y);
+        result = vmlaq_n_f32(result, vld1q_f32(&columns[2].x), vector.z);
+        result = vmlaq_n_f32(result, vld1q_f32(&columns[3].x), vector.w);
+        Float4 output;
+        vst1q_f32(&output.x, result);
+        return output;
+#else
+        return columns[0] * vector.x + columns[1] * vector.y + columns[2] * vector.z + columns[3] * vector.w;
+#endif
+    }
+
+    Matrix4 operator*(const Matrix4& other) const {
+        Matrix4 result;
+        for (int column = 0; column < 4; ++column) {
+            result.columns[column] = this->transform(other.columns[column]);
+        }
+        return result;
+    }
+};
+
+// glm interop for code that still speaks glm
+
+inline glm::vec2 toGlm(const Float2& vector) { return { vector.x, vector.y }; }
+inline glm::vec3 toGlm(const Float3& vector) { return { vector.x, vector.y, vector.z }; }
+inline glm::vec4 toGlm(const Float4& vector) { return { vector.x, vector.y, vector.z, vector.w }; }
+inline Float2 fromGlm(const glm::vec2& vector) { return { vector.x, vector.y }; }
+inline Float3 fromGlm(const glm::vec3& vector) { return { vector.x, vector.y, vector.z }; }
+inline Float4 fromGlm(const glm::vec4& vector) { return { vector.x, vector.y, vector.z, vector.w }; }
+
+inline glm::mat4 toGlm(const Matrix4& matrix)
+{
+    static_assert(sizeof(glm::mat4) == sizeof(Matrix4), "Matrix4 must match the glm::mat4 layout");
+    return glm::make_mat4(&matrix.columns[0].x);
+}
+
+inline Matrix4 fromGlm(const glm::mat4& matrix)
+{
+    Matrix4 result;
+    std::memcpy(&result, glm::value_ptr(matrix), sizeof(Matrix4));
+    return result;
+}
 
-} // mentalsdk
\ No newline at end of file
+} // mentalsdk
@@ -0,0 +1,380 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "../Math/Bounds.hpp"
+#include "Object.hpp"
+
+namespace mentalsdk
+{
+
+const uint32_t BVH_MAX_LEAF_SIZE = 4;
+const uint32_t BVH_SAH_BINS = 12;
+const uint32_t BVH_LEAF_FLAG = 0x80000000U;
+const uint32_t BVH_MAX_SAH_DEPTH = 48; // Deeper nodes fall back to median splits to bound the stack
+const uint32_t BVH_MAX_DEPTH = 96; // Past this a node is a leaf whatever it holds; median splits reach 48 + 32 at most
+const uint32_t BVH_STACK_SIZE = 128;
+const uint32_t BVH_NO_PARENT = 0xFFFFFFFFU;
+const float BVH_TRAVERSAL_COST = 1.0F;
+const float BVH_INTERSECTION_COST = 1.0F;
+
+// Traversal pushes both children and pops one per level, so depth + 1 entries always suffice
+static_assert(BVH_MAX_SAH_DEPTH < BVH_MAX_DEPTH && BVH_MAX_DEPTH + 1 <= BVH_STACK_SIZE, "BVH traversal stack too small for the depth cap");
+
+// 32-byte node, nodes are stored depth-first so the left child is always index + 1
+struct BVHNode {
+    glm::vec3 min;
+    uint32_t rightOrFirst; // Right child index for inner nodes, first primitive for leaves
+    glm::vec3 max;
+    uint32_t count; // Primitives below this node, BVH_LEAF_FLAG set for leaves
+
+    [[nodiscard]] bool isLeaf() const { return (count & BVH_LEAF_FLAG) != 0; }
+    [[nodiscard]] uint32_t getPrimitiveCount() const { return count & ~BVH_LEAF_FLAG; }
+    [[nodiscard]] AABB getBounds() const { return AABB{ min, max }; }
+};
+
+struct CMentalRayHit {
+    std::shared_ptr<CMentalObject> object = nullptr;
+    float distance = -1.0F;
+
+    [[nodiscard]] bool hasHit() const { return object != nullptr; }
+};
+
+class CMentalBVH
+{
+private:
+    struct Primitive {
+        AABB bounds;
+        glm::vec3 centroid;
+    };
+
+    std::vector<BVHNode> nodes_;
+    std::vector<uint32_t> primitiveIndices_; // Leaf ranges index into objects_
+    std::vector<std::shared_ptr<CMentalObject>> objects_;
+    std::vector<uint32_t> primitiveLeaf_; // Leaf node holding each object, for incremental refit
+    std::vector<uint32_t> parents_;
+    std::vector<Primitive> primitives_; // Only alive during build
+    uint32_t maxDepth_ = 0; // Of the built tree, never above BVH_MAX_DEPTH
+
+    // Objects report their own moves, so refit() costs what moved, not what exists
+    CMentalTransformListener moved_;
+    std::vector<uint8_t> nodeDirty_; // All zero between refits
+    std::vector<uint32_t> dirtyNodes_;
+
+    void setNodeBounds(BVHNode& node, uint32_t first, uint32_t count) const {
+        AABB bounds;
+        for (uint32_t index = first; index < first + count; ++index) {
+            bounds.expand(primitives_[primitiveIndices_[index]].bounds);
+        }
+        node.min = bounds.min;
+        node.max = bounds.max;
+    }
+
+    // Binned SAH split, returns false when a leaf is cheaper than any split
+    bool findSplit(const BVHNode& node, uint32_t first, uint32_t count, int& bestAxis, float& bestPosition) const {
+        AABB centroidBounds;
+        for (uint32_t index = first; index < first + count; ++index) {
+            centroidBounds.expand(primitives_[primitiveIndices_[index]].centroid);
+        }
+
+        float bestCost = BVH_INTERSECTION_COST * static_cast<float>(count);
+        bool found = false;
+        const float parentArea = node.getBounds().getSurfaceArea();
+
+        for (int axis = 0; axis < 3; ++axis) {
+            const float lower = centroidBounds.min[axis];
+            const float upper = centroidBounds.max[axis];
+            if (upper - lower <= 0.0F) {
+                continue;
+            }
+
+            AABB binBounds[BVH_SAH_BINS];
+            uint32_t binCounts[BVH_SAH_BINS] = {};
+            const float scale = static_cast<float>(BVH_SAH_BINS) / (upper - lower);
+            for (uint32_t index = first; index < first + count; ++index) {
+                const Primitive& primitive = primitives_[primitiveIndices_[index]];
+                const auto bin = std::min(BVH_SAH_BINS - 1, static_cast<uint32_t>((primitive.centroid[axis] - lower) * scale));
+                binBounds[bin].expand(primitive.bounds);
+                ++binCounts[bin];
+            }
+
+            // Sweep from both sides to get the cost of every bin boundary
+            float leftArea[BVH_SAH_BINS - 1];
+            uint32_t leftCount[BVH_SAH_BINS - 1];
+            AABB sweep;
+            uint32_t sweepCount = 0;
+            for (uint32_t bin = 0; bin < BVH_SAH_BINS - 1; ++bin) {
+                sweep.expand(binBounds[bin]);
+                sweepCount += binCounts[bin];
+                leftArea[bin] = sweep.getSurfaceArea();
+                leftCount[bin] = sweepCount;
+            }
+
+            sweep = AABB{};
+            sweepCount = 0;
+            for (uint32_t bin = BVH_SAH_BINS - 1; bin > 0; --bin) {
+                sweep.expand(binBounds[bin]);
+                sweepCount += binCounts[bin];
+                const float cost = BVH_TRAVERSAL_COST + BVH_INTERSECTION_COST *
+                    (leftArea[bin - 1] * static_cast<float>(leftCount[bin - 1]) +
+                     sweep.getSurfaceArea() * static_cast<float>(sweepCount)) / std::max(parentArea, 1e-12F);
+                if (leftCount[bin - 1] > 0 && sweepCount > 0 && cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestPosition = lower + static_cast<float>(bin) / scale;
+                    found = true;
+                }
+            }
+        }
+        return found;
+    }
+
+    uint32_t buildRecursive(uint32_t first, uint32_t count, uint32_t depth) {
+        const auto nodeIndex = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+        this->setNodeBounds(nodes_[nodeIndex], first, count);
+
+        const auto begin = primitiveIndices_.begin() + first;
+        const auto end = begin + count;
+        uint32_t leftCount = 0;
+        this->maxDepth_ = std::max(this->maxDepth_, depth);
+
+        if (depth >= BVH_MAX_DEPTH) {
+            nodes_[nodeIndex].rightOrFirst = first;
+            nodes_[nodeIndex].count = count | BVH_LEAF_FLAG;
+            return nodeIndex;
+        }
+        if (depth < BVH_MAX_SAH_DEPTH) {
+            int axis = 0;
+            float position = 0.0F;
+            if (count <= BVH_MAX_LEAF_SIZE || !this->findSplit(nodes_[nodeIndex], first, count, axis, position)) {
+                nodes_[nodeIndex].rightOrFirst = first;
+                nodes_[nodeIndex].count = count | BVH_LEAF_FLAG;
+                return nodeIndex;
+            }
+
+            const auto middle = std::partition(begin, end,
+                [&](uint32_t index) { return primitives_[index].centroid[axis] < position; });
+            leftCount = static_cast<uint32_t>(middle - begin);
+        } else if (count <= BVH_MAX_LEAF_SIZE) {
+            nodes_[nodeIndex].rightOrFirst = first;
+            nodes_[nodeIndex].count = count | BVH_LEAF_FLAG;
+            return nodeIndex;
+        }
+
+        if (leftCount == 0 || leftCount == count) {
+            // Too deep for SAH, or a degenerate split: median split along the widest axis
+            const glm::vec3 extent = nodes_[nodeIndex].getBounds().getExtent();
+            const int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+            leftCount = count / 2;
+            std::nth_element(begin, begin + leftCount, end, [&](uint32_t lhs, uint32_t rhs) {
+                return primitives_[lhs].centroid[axis] < primitives_[rhs].centroid[axis];
+            });
+        }
+
+        this->buildRecursive(first, leftCount, depth + 1);
+        const uint32_t right = this->buildRecursive(first + leftCount, count - leftCount, depth + 1);
+        nodes_[nodeIndex].rightOrFirst = right;
+        nodes_[nodeIndex].count = count;
+        return nodeIndex;
+    }
+
+    void detachObjects() {
+        for (const auto& object : objects_) {
+            object->setTransformListener(nullptr, 0);
+        }
+    }
+
+    [[nodiscard]] uint32_t firstPrimitiveOf(uint32_t nodeIndex) const {
+        while (!nodes_[nodeIndex].isLeaf()) {
+            ++nodeIndex;
+        }
+        return nodes_[nodeIndex].rightOrFirst;
+    }
+
+public:
+    CMentalBVH() = default;
+    ~CMentalBVH() { this->detachObjects(); }
+
+    CMentalBVH(const CMentalBVH&) = delete;
+    CMentalBVH& operator=(const CMentalBVH&) = delete;
+    CMentalBVH(CMentalBVH&&) = delete;
+    CMentalBVH& operator=(CMentalBVH&&) = delete;
+
+    // An object is indexed by one BVH at a time, the last to build with it
+    void build(std::vector<std::shared_ptr<CMentalObject>> objects) {
+        this->detachObjects();
+        this->objects_ = std::move(objects);
+        nodes_.clear();
+        primitiveIndices_.clear();
+        this->maxDepth_ = 0;
+        primitiveLeaf_.assign(objects_.size(), 0);
+        moved_.reset(objects_.size());
+        if (objects_.empty()) {
+            parents_.clear();
+            nodeDirty_.clear();
+            return;
+        }
+
+        primitives_.resize(objects_.size());
+        primitiveIndices_.resize(objects_.size());
+        for (uint32_t index = 0; index < objects_.size(); ++index) {
+            primitives_[index].bounds = objects_[index]->getWorldBounds();
+            primitives_[index].centroid = primitives_[index].bounds.isValid() ? primitives_[index].bounds.getCenter() : glm::vec3(0.0F);
+            primitiveIndices_[index] = index;
+            objects_[index]->setTransformListener(&moved_, index);
+        }
+
+        nodes_.reserve(objects_.size() * 2);
+        this->buildRecursive(0, static_cast<uint32_t>(objects_.size()), 0);
+        primitives_.clear();
+        primitives_.shrink_to_fit();
+
+        parents_.assign(nodes_.size(), BVH_NO_PARENT);
+        nodeDirty_.assign(nodes_.size(), 0);
+        for (uint32_t nodeIndex = 0; nodeIndex < nodes_.size(); ++nodeIndex) {
+            const BVHNode& node = nodes_[nodeIndex];
+            if (node.isLeaf()) {
+                for (uint32_t index = node.rightOrFirst; index < node.rightOrFirst + node.getPrimitiveCount(); ++index) {
+                    primitiveLeaf_[primitiveIndices_[index]] = nodeIndex;
+                }
+            } else {
+                parents_[nodeIndex + 1] = nodeIndex;
+                parents_[node.rightOrFirst] = nodeIndex;
+            }
+        }
+    }
+
+    // Refits the leaves of objects that moved since the last build/refit and their ancestors.
+    // Children always follow their parent, so refitting in descending index order is bottom-up
+    bool refit() {
+        if (nodes_.empty() || moved_.empty()) {
+            return false;
+        }
+
+        for (const uint32_t object : moved_) {
+            objects_[object]->acknowledgeTransform();
+            for (uint32_t node = primitiveLeaf_[object]; node != BVH_NO_PARENT && nodeDirty_[node] == 0; node = parents_[node]) {
+                nodeDirty_[node] = 1;
+                dirtyNodes_.push_back(node);
+            }
+        }
+        moved_.clear();
+
+        std::sort(dirtyNodes_.begin(), dirtyNodes_.end(), std::greater<>());
+        for (const uint32_t nodeIndex : dirtyNodes_) {
+            BVHNode& node = nodes_[nodeIndex];
+            AABB bounds;
+            if (node.isLeaf()) {
+                for (uint32_t index = node.rightOrFirst; index < node.rightOrFirst + node.getPrimitiveCount(); ++index) {
+                    bounds.expand(objects_[primitiveIndices_[index]]->getWorldBounds());
+                }
+            } else {
+                bounds.expand(nodes_[nodeIndex + 1].getBounds());
+                bounds.expand(nodes_[node.rightOrFirst].getBounds());
+            }
+            node.min = bounds.min;
+            node.max = bounds.max;
+            nodeDirty_[nodeIndex] = 0;
+        }
+        dirtyNodes_.clear();
+        return true;
+    }
+
+    // Hierarchical frustum culling, fully contained subtrees are emitted without further tests
+    void cullFrustum(const Frustum& frustum, std::vector<CMentalObject*>& visible) const {
+        if (nodes_.empty()) {
+            return;
+        }
+
+        uint32_t stack[BVH_STACK_SIZE];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0) {
+            const uint32_t nodeIndex = stack[--stackSize];
+            const BVHNode& node = nodes_[nodeIndex];
+            const MentalCullResult result = frustum.classify(node.getBounds());
+            if (result == MentalCullResult::Outside) {
+                continue;
+            }
+
+            if (result == MentalCullResult::Inside || node.isLeaf()) {
+                const uint32_t first = node.isLeaf() ? node.rightOrFirst : this->firstPrimitiveOf(nodeIndex);
+                const uint32_t count = node.getPrimitiveCount();
+                for (uint32_t index = first; index < first + count; ++index) {
+                    CMentalObject* object = objects_[primitiveIndices_[index]].get();
+                    if (result == MentalCullResult::Inside || count == 1 ||
+                        frustum.classify(object->getWorldBounds()) != MentalCullResult::Outside) {
+                        visible.push_back(object);
+                    }
+                }
+                continue;
+            }
+
+            stack[stackSize++] = node.rightOrFirst;
+            stack[stackSize++] = nodeIndex + 1;
+        }
+    }
+
+    // Closest-hit query, boxes narrow the candidates and triangles decide the hit
+    [[nodiscard]] CMentalRayHit raycast(const Ray& ray, float maxDistance) const {
+        CMentalRayHit hit;
+        if (nodes_.empty()) {
+            return hit;
+        }
+
+        const glm::vec3 inverseDirection = 1.0F / ray.direction;
+        float closest = maxDistance;
+
+        uint32_t stack[BVH_STACK_SIZE];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0) {
+            const BVHNode& node = nodes_[stack[--stackSize]];
+            const float entry = ray.intersect(node.getBounds(), inverseDirection, closest);
+            if (entry < 0.0F) {
+                continue;
+            }
+
+            if (node.isLeaf()) {
+                for (uint32_t index = node.rightOrFirst; index < node.rightOrFirst + node.getPrimitiveCount(); ++index) {
+                    const auto& object = objects_[primitiveIndices_[index]];
+                    const float distance = object->intersectRay(ray);
+                    if (distance >= 0.0F && distance < closest) {
+                        closest = distance;
+                        hit.object = object;
+                        hit.distance = distance;
+                    }
+                }
+                continue;
+            }
+
+            // Visit the nearer child first so the far one is more likely to be rejected
+            const uint32_t left = static_cast<uint32_t>(&node - nodes_.data()) + 1;
+            const uint32_t right = node.rightOrFirst;
+            const float leftEntry = ray.intersect(nodes_[left].getBounds(), inverseDirection, closest);
+            const float rightEntry = ray.intersect(nodes_[right].getBounds(), inverseDirection, closest);
+            if (leftEntry >= 0.0F && rightEntry >= 0.0F) {
+                stack[stackSize++] = leftEntry < rightEntry ? right : left;
+                stack[stackSize++] = leftEntry < rightEntry ? left : right;
+            } else if (leftEntry >= 0.0F) {
+                stack[stackSize++] = left;
+            } else if (rightEntry >= 0.0F) {
+                stack[stackSize++] = right;
+            }
+        }
+        return hit;
+    }
+
+    [[nodiscard]] bool isEmpty() const { return nodes_.empty(); }
+    [[nodiscard]] size_t getNodeCount() const { return nodes_.size(); }
+    [[nodiscard]] uint32_t getMaxDepth() const { return maxDepth_; }
+    [[nodiscard]] size_t getObjectCount() const { return objects_.size(); }
+    [[nodiscard]] const std::vector<BVHNode>& getNodes() const { return nodes_; }
+};
+
+} // mentalsdk
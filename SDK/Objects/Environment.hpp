@@ -30,6 +30,8 @@ public:
         this->color_[3] = alpha;
     }
 
+    [[nodiscard]] const float* getColor() const { return this->color_; }
+
     void renderClearColor() {
         glClearColor(this->color_[0], this->color_[1], this->color_[2], this->color_[3]);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
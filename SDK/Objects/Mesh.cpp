@@ -0,0 +1,153 @@
+#include "Mesh.hpp"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <istream>
+#include <streambuf>
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "tinyobjloader/tinyobjloader.h"
+
+namespace mentalsdk {
+
+static_assert(sizeof(Vertex) == 32, "Cooked meshes store vertices as they are in memory");
+static_assert(sizeof(CMentalMeshHeader) == 32, "Cooked mesh header layout changed");
+
+namespace {
+
+// Reads straight from the caller's bytes, no copy
+class MemoryBuffer : public std::streambuf
+{
+public:
+    MemoryBuffer(const uint8_t* data, size_t size) {
+        char* begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+        this->setg(begin, begin, begin + size);
+    }
+};
+
+bool buildFromObj(const tinyobj::attrib_t& attrib, const std::vector<tinyobj::shape_t>& shapes, const std::string& name,
+                  CMentalMeshData& mesh) {
+    mesh.vertices.clear();
+    mesh.indices.clear();
+    for (const auto& shape : shapes) {
+        for (const auto& index : shape.mesh.indices) {
+            Vertex vertex{ glm::vec3(0.0F), glm::vec3(0.0F, 0.0F, 1.0F), glm::vec2(0.0F) };
+            if (index.vertex_index >= 0) {
+                const size_t offset = static_cast<size_t>(index.vertex_index) * 3;
+                vertex.position = glm::vec3(attrib.vertices[offset], attrib.vertices[offset + 1], attrib.vertices[offset + 2]);
+            }
+            if (index.normal_index >= 0) {
+                const size_t offset = static_cast<size_t>(index.normal_index) * 3;
+                vertex.normal = glm::vec3(attrib.normals[offset], attrib.normals[offset + 1], attrib.normals[offset + 2]);
+            }
+            if (index.texcoord_index >= 0) {
+                const size_t offset = static_cast<size_t>(index.texcoord_index) * 2;
+                vertex.texCoord = glm::vec2(attrib.texcoords[offset], attrib.texcoords[offset + 1]);
+            }
+            mesh.indices.push_back(static_cast<unsigned int>(mesh.vertices.size()));
+            mesh.vertices.push_back(vertex);
+        }
+    }
+
+    if (mesh.vertices.empty()) {
+        std::cerr << "Error: OBJ model has no geometry: " << name << "\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool CMentalMeshData::loadObj(const std::string& filePath) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warning;
+    std::string error;
+
+    const std::string baseDirectory = filePath.substr(0, filePath.find_last_of("/\\") + 1);
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warning, &error, filePath.c_str(), baseDirectory.c_str())) {
+        std::cerr << "Error loading OBJ model " << filePath << ": " << error << "\n";
+        return false;
+    }
+    if (!warning.empty()) {
+        std::cerr << "Warning loading OBJ model " << filePath << ": " << warning << "\n";
+    }
+    return buildFromObj(attrib, shapes, filePath, *this);
+}
+
+bool CMentalMeshData::loadObj(const uint8_t* data, size_t size, const std::string& name) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warning;
+    std::string error;
+
+    MemoryBuffer buffer(data, size);
+    std::istream stream(&buffer);
+    if (data == nullptr || !tinyobj::LoadObj(&attrib, &shapes, &materials, &warning, &error, &stream)) {
+        std::cerr << "Error loading OBJ model " << name << ": " << error << "\n";
+        return false;
+    }
+    return buildFromObj(attrib, shapes, name, *this);
+}
+
+bool CMentalMeshData::saveBinary(const std::string& filePath, uint64_t sourceHash, uint32_t flags, uint32_t optimizerVersion) const {
+    CMentalMeshHeader header;
+    header.vertexCount = static_cast<uint32_t>(this->vertices.size());
+    header.indexCount = static_cast<uint32_t>(this->indices.size());
+    header.sourceHash = sourceHash;
+    header.flags = flags;
+    header.optimizerVersion = optimizerVersion;
+
+    std::ofstream file(filePath, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(this->vertices.data()), static_cast<std::streamsize>(this->vertices.size() * sizeof(Vertex)));
+    file.write(reinterpret_cast<const char*>(this->indices.data()),
+               static_cast<std::streamsize>(this->indices.size() * sizeof(unsigned int)));
+    return static_cast<bool>(file);
+}
+
+bool CMentalMeshData::isBinaryMesh(const uint8_t* data, size_t size) {
+    uint32_t magic = 0;
+    if (data == nullptr || size < sizeof(magic)) {
+        return false;
+    }
+    std::memcpy(&magic, data, sizeof(magic));
+    return magic == MESH_BINARY_MAGIC;
+}
+
+bool CMentalMeshData::readBinaryHeader(const uint8_t* data, size_t size, CMentalMeshHeader& header) {
+    if (data == nullptr || size < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    const uint64_t payload = static_cast<uint64_t>(header.vertexCount) * sizeof(Vertex) +
+                             static_cast<uint64_t>(header.indexCount) * sizeof(unsigned int);
+    return header.magic == MESH_BINARY_MAGIC && header.version == MESH_BINARY_VERSION && payload <= size - sizeof(header);
+}
+
+bool CMentalMeshData::loadBinary(const uint8_t* data, size_t size, const std::string& name) {
+    CMentalMeshHeader header;
+    if (!readBinaryHeader(data, size, header) || header.vertexCount == 0) {
+        std::cerr << "Error: " << name << " is not a readable cooked mesh\n";
+        return false;
+    }
+    const uint8_t* cursor = data + sizeof(header);
+    this->vertices.resize(header.vertexCount);
+    std::memcpy(this->vertices.data(), cursor, this->vertices.size() * sizeof(Vertex));
+    cursor += this->vertices.size() * sizeof(Vertex);
+    this->indices.resize(header.indexCount);
+    std::memcpy(this->indices.data(), cursor, this->indices.size() * sizeof(unsigned int));
+    for (const unsigned int index : this->indices) {
+        if (index >= header.vertexCount) {
+            std::cerr << "Error: Cooked mesh " << name << " has an index out of range\n";
+            this->vertices.clear();
+            this->indices.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace mentalsdk
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../Utils/Utils.hpp"
+
+namespace mentalsdk
+{
+
+const uint32_t MESH_BINARY_MAGIC = 0x48534D4DU; // "MMSH"
+const uint32_t MESH_BINARY_VERSION = 1;
+const uint32_t MESH_BINARY_OPTIMIZED = 1U << 0;
+
+// .mmsh: this header, the vertices as they are in memory, then 32-bit indices. Little
+// endian, like the other binary formats. sourceHash identifies the file it was cooked from,
+// optimizerVersion the CMentalMeshOptimizer that reordered it (0 when it was not)
+struct CMentalMeshHeader {
+    uint32_t magic = MESH_BINARY_MAGIC;
+    uint32_t version = MESH_BINARY_VERSION;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    uint64_t sourceHash = 0;
+    uint32_t flags = 0;
+    uint32_t optimizerVersion = 0;
+};
+
+// CPU-side geometry as loaders produce it. Parsing touches no GL state, so it can run on
+// worker threads; CMentalObject::setMesh uploads it on the GL thread
+struct CMentalMeshData {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+
+    // Triangulated OBJ, every face corner becomes its own vertex
+    bool loadObj(const std::string& filePath);
+    // Same from bytes in memory, e.g. an archive entry; materials are not read. name is for messages
+    bool loadObj(const uint8_t* data, size_t size, const std::string& name);
+
+    // Cooked meshes load with two copies and no parsing
+    bool saveBinary(const std::string& filePath, uint64_t sourceHash, uint32_t flags, uint32_t optimizerVersion = 0) const;
+    bool loadBinary(const uint8_t* data, size_t size, const std::string& name);
+    static bool isBinaryMesh(const uint8_t* data, size_t size);
+    // Header of a cooked mesh, to check it is current before loading it
+    static bool readBinaryHeader(const uint8_t* data, size_t size, CMentalMeshHeader& header);
+
+    [[nodiscard]] bool empty() const { return vertices.empty(); }
+    [[nodiscard]] int64_t getBytes() const {
+        return static_cast<int64_t>(vertices.size() * sizeof(Vertex) + indices.size() * sizeof(unsigned int));
+    }
+};
+
+} // mentalsdk
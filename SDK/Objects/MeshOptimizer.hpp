@@ -0,0 +1,369 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Mesh.hpp"
+
+namespace mentalsdk
+{
+
+const size_t MESH_VERTEX_CACHE_SIZE = 32; // Modelled LRU cache for reordering; real caches are this size or smaller
+const size_t MESH_ANALYSIS_CACHE_SIZE = 16; // FIFO, like the post-transform caches of most GPUs
+const float MESH_OVERDRAW_THRESHOLD = 1.05F; // Vertex cache efficiency given up to sort for overdraw
+const uint32_t MESH_NO_VERTEX = 0xFFFFFFFFU;
+const uint32_t MESH_OPTIMIZER_VERSION = 1; // Bump when optimize() orders anything differently; older cooked meshes get recooked
+
+// Before and after, as printed by the loaders
+struct CMentalMeshReport {
+    size_t vertices = 0;
+    size_t optimizedVertices = 0;
+    float acmr = 0.0F; // Vertex shader runs per triangle
+    float optimizedAcmr = 0.0F;
+};
+
+// Import-time reordering of indexed triangle lists. None of it changes what is drawn:
+//  - deduplicate() merges bit-identical vertices, which OBJ loading emits per face corner
+//  - optimizeVertexCache() orders triangles for post-transform cache reuse (Forsyth)
+//  - optimizeOverdraw() reorders clusters of those triangles so outward facing ones come
+//    first, giving up at most the threshold in cache efficiency (Sander et al.)
+//  - optimizeVertexFetch() orders vertices by first use, so fetches walk memory forwards
+// optimize() runs them in that order; each step expects the previous one.
+class CMentalMeshOptimizer
+{
+private:
+    struct VertexHash {
+        size_t operator()(const Vertex* vertex) const {
+            return std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(vertex), sizeof(Vertex)));
+        }
+    };
+    struct VertexEqual {
+        bool operator()(const Vertex* lhs, const Vertex* rhs) const { return std::memcmp(lhs, rhs, sizeof(Vertex)) == 0; }
+    };
+
+    static float scoreVertex(int cachePosition, uint32_t liveTriangles) {
+        if (liveTriangles == 0) {
+            return -1.0F; // Nothing left to draw with it
+        }
+        float score = 0.0F;
+        if (cachePosition >= 0) {
+            // The last triangle's vertices score a little lower so strips do not always win
+            score = cachePosition < 3 ? 0.75F
+                                      : std::pow(1.0F - static_cast<float>(cachePosition - 3) / static_cast<float>(MESH_VERTEX_CACHE_SIZE - 3), 1.5F);
+        }
+        return score + 2.0F / std::sqrt(static_cast<float>(liveTriangles)); // Finish off lonely vertices early
+    }
+
+    static glm::vec3 getFaceNormal(const std::vector<Vertex>& vertices, const unsigned int* triangle) {
+        const glm::vec3& first = vertices[triangle[0]].position;
+        return glm::cross(vertices[triangle[1]].position - first, vertices[triangle[2]].position - first);
+    }
+
+public:
+    // Non-indexed meshes become indexed
+    static void deduplicate(CMentalMeshData& mesh) {
+        std::vector<unsigned int> indices = mesh.indices;
+        if (indices.empty()) {
+            indices.resize(mesh.vertices.size());
+            for (size_t index = 0; index < indices.size(); ++index) {
+                indices[index] = static_cast<unsigned int>(index);
+            }
+        }
+        std::unordered_map<const Vertex*, unsigned int, VertexHash, VertexEqual> unique;
+        unique.reserve(mesh.vertices.size());
+        std::vector<unsigned int> remap(mesh.vertices.size());
+        std::vector<Vertex> vertices;
+        vertices.reserve(mesh.vertices.size());
+        for (size_t index = 0; index < mesh.vertices.size(); ++index) {
+            const auto [entry, inserted] = unique.try_emplace(&mesh.vertices[index], static_cast<unsigned int>(vertices.size()));
+            if (inserted) {
+                vertices.push_back(mesh.vertices[index]);
+            }
+            remap[index] = entry->second;
+        }
+        for (unsigned int& index : indices) {
+            index = remap[index];
+        }
+        mesh.vertices = std::move(vertices);
+        mesh.indices = std::move(indices);
+    }
+
+    // Forsyth's linear-speed vertex cache optimisation: greedily emits the best scoring
+    // triangle among those touching the modelled cache, rescoring only what it touched
+    static void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount) {
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount < 2) {
+            return;
+        }
+
+        // Triangles per vertex; the first liveTriangles[v] entries are the ones not yet emitted
+        std::vector<uint32_t> liveTriangles(vertexCount, 0);
+        for (const unsigned int index : indices) {
+            ++liveTriangles[index];
+        }
+        std::vector<uint32_t> offsets(vertexCount + 1, 0);
+        for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+            offsets[vertex + 1] = offsets[vertex] + liveTriangles[vertex];
+        }
+        std::vector<uint32_t> adjacency(indices.size());
+        {
+            std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+            for (size_t index = 0; index < triangleCount * 3; ++index) {
+                adjacency[cursor[indices[index]]++] = static_cast<uint32_t>(index / 3);
+            }
+        }
+
+        std::vector<int> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+            vertexScore[vertex] = scoreVertex(-1, liveTriangles[vertex]);
+        }
+        std::vector<float> triangleScore(triangleCount);
+        std::vector<uint8_t> emitted(triangleCount, 0);
+        size_t best = 0;
+        for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+            triangleScore[triangle] = vertexScore[indices[triangle * 3]] + vertexScore[indices[triangle * 3 + 1]] +
+                                      vertexScore[indices[triangle * 3 + 2]];
+            if (triangleScore[triangle] > triangleScore[best]) {
+                best = triangle;
+            }
+        }
+
+        std::vector<unsigned int> output;
+        output.reserve(triangleCount * 3);
+        std::vector<uint32_t> cache;
+        std::vector<uint32_t> nextCache;
+        cache.reserve(MESH_VERTEX_CACHE_SIZE + 3);
+        nextCache.reserve(MESH_VERTEX_CACHE_SIZE + 3);
+        size_t cursor = 0; // Dead ends restart from the first triangle not yet emitted
+        bool found = true;
+        while (output.size() < triangleCount * 3) {
+            if (!found) {
+                while (emitted[cursor] != 0) {
+                    ++cursor;
+                }
+                best = cursor;
+            }
+            emitted[best] = 1;
+            const unsigned int* triangle = &indices[best * 3];
+            output.insert(output.end(), triangle, triangle + 3);
+
+            nextCache.assign(triangle, triangle + 3);
+            for (size_t corner = 0; corner < 3; ++corner) {
+                const uint32_t vertex = triangle[corner];
+                uint32_t* live = &adjacency[offsets[vertex]];
+                const uint32_t count = liveTriangles[vertex];
+                const uint32_t slot = static_cast<uint32_t>(std::find(live, live + count, static_cast<uint32_t>(best)) - live);
+                if (slot < count) {
+                    std::swap(live[slot], live[count - 1]);
+                    --liveTriangles[vertex];
+                }
+            }
+            for (const uint32_t vertex : cache) {
+                if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2]) {
+                    nextCache.push_back(vertex);
+                }
+            }
+
+            for (size_t position = 0; position < nextCache.size(); ++position) {
+                const uint32_t vertex = nextCache[position];
+                cachePosition[vertex] = position < MESH_VERTEX_CACHE_SIZE ? static_cast<int>(position) : -1;
+                vertexScore[vertex] = scoreVertex(cachePosition[vertex], liveTriangles[vertex]);
+            }
+
+            found = false;
+            float bestScore = -1.0F;
+            for (const uint32_t vertex : nextCache) {
+                const uint32_t* live = &adjacency[offsets[vertex]];
+                for (uint32_t slot = 0; slot < liveTriangles[vertex]; ++slot) {
+                    const uint32_t candidate = live[slot];
+                    const unsigned int* corners = &indices[static_cast<size_t>(candidate) * 3];
+                    triangleScore[candidate] = vertexScore[corners[0]] + vertexScore[corners[1]] + vertexScore[corners[2]];
+                    if (triangleScore[candidate] > bestScore) {
+                        bestScore = triangleScore[candidate];
+                        best = candidate;
+                        found = true;
+                    }
+                }
+            }
+            if (nextCache.size() > MESH_VERTEX_CACHE_SIZE) {
+                nextCache.resize(MESH_VERTEX_CACHE_SIZE);
+            }
+            cache.swap(nextCache);
+        }
+        indices.swap(output);
+    }
+
+    // Splits the cache ordered list into clusters where cache efficiency stays within the
+    // threshold of the whole cluster's, then draws clusters facing away from the center first
+    static void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices,
+                                 float threshold = MESH_OVERDRAW_THRESHOLD) {
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount < 2 || vertices.empty()) {
+            return;
+        }
+
+        // One timestamp array for both passes: moving time on by more than the cache size
+        // empties the cache, so ranges and clusters start cold without clearing it
+        const auto cold = static_cast<uint32_t>(MESH_ANALYSIS_CACHE_SIZE) + 1;
+        std::vector<uint32_t> timestamps(vertices.size(), 0);
+        uint32_t time = cold;
+        const auto miss = [&timestamps, &time](unsigned int vertex) {
+            if (time - timestamps[vertex] > MESH_ANALYSIS_CACHE_SIZE) {
+                timestamps[vertex] = time++;
+                return true;
+            }
+            return false;
+        };
+
+        // Hard boundaries: triangles that miss the cache on every vertex start a new range.
+        // Each range's own ACMR comes out of the same pass
+        std::vector<size_t> hard{ 0 };
+        std::vector<float> hardAcmr;
+        size_t rangeMisses = 0;
+        for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+            const unsigned int* corners = &indices[triangle * 3];
+            size_t misses = 0;
+            for (size_t corner = 0; corner < 3; ++corner) {
+                misses += static_cast<size_t>(miss(corners[corner])); // In corner order, the stamps depend on it
+            }
+            if (misses == 3 && triangle > 0) {
+                hardAcmr.push_back(static_cast<float>(rangeMisses) / static_cast<float>(triangle - hard.back()));
+                hard.push_back(triangle);
+                rangeMisses = 0;
+                time += cold; // Restart cold with only this triangle cached
+                timestamps[corners[0]] = time++;
+                timestamps[corners[1]] = time++;
+                timestamps[corners[2]] = time++;
+            }
+            rangeMisses += misses;
+        }
+        hardAcmr.push_back(static_cast<float>(rangeMisses) / static_cast<float>(triangleCount - hard.back()));
+        hard.push_back(triangleCount);
+
+        // Soft boundaries inside each: cut wherever the running ACMR is back near the range's
+        std::vector<size_t> clusters;
+        for (size_t range = 0; range + 1 < hard.size(); ++range) {
+            const size_t begin = hard[range];
+            const size_t end = hard[range + 1];
+            time += cold;
+            size_t start = begin;
+            size_t misses = 0;
+            clusters.push_back(begin);
+            for (size_t triangle = begin; triangle < end; ++triangle) {
+                for (size_t corner = 0; corner < 3; ++corner) {
+                    misses += static_cast<size_t>(miss(indices[triangle * 3 + corner]));
+                }
+                const size_t drawn = triangle + 1 - start;
+                if (triangle + 1 < end && static_cast<float>(misses) / static_cast<float>(drawn) <= hardAcmr[range] * threshold) {
+                    clusters.push_back(triangle + 1);
+                    start = triangle + 1;
+                    misses = 0;
+                    time += cold; // Each cluster starts cold
+                }
+            }
+        }
+        clusters.push_back(triangleCount);
+
+        glm::vec3 meshCenter(0.0F);
+        float meshArea = 0.0F;
+        for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+            const unsigned int* corners = &indices[triangle * 3];
+            const float area = glm::length(getFaceNormal(vertices, corners));
+            meshCenter += (vertices[corners[0]].position + vertices[corners[1]].position + vertices[corners[2]].position) * (area / 3.0F);
+            meshArea += area;
+        }
+        meshCenter = meshArea > 0.0F ? meshCenter / meshArea : meshCenter;
+
+        struct Cluster {
+            size_t begin = 0;
+            size_t end = 0;
+            float key = 0.0F;
+        };
+        std::vector<Cluster> sorted;
+        sorted.reserve(clusters.size() - 1);
+        for (size_t cluster = 0; cluster + 1 < clusters.size(); ++cluster) {
+            Cluster entry{ clusters[cluster], clusters[cluster + 1], 0.0F };
+            glm::vec3 center(0.0F);
+            glm::vec3 normal(0.0F);
+            float area = 0.0F;
+            for (size_t triangle = entry.begin; triangle < entry.end; ++triangle) {
+                const unsigned int* corners = &indices[triangle * 3];
+                const glm::vec3 faceNormal = getFaceNormal(vertices, corners);
+                const float faceArea = glm::length(faceNormal);
+                center += (vertices[corners[0]].position + vertices[corners[1]].position + vertices[corners[2]].position) * (faceArea / 3.0F);
+                normal += faceNormal;
+                area += faceArea;
+            }
+            const float normalLength = glm::length(normal);
+            if (area > 0.0F && normalLength > 0.0F) {
+                entry.key = glm::dot(center / area - meshCenter, normal / normalLength);
+            }
+            sorted.push_back(entry);
+        }
+        std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& lhs, const Cluster& rhs) { return lhs.key > rhs.key; });
+
+        std::vector<unsigned int> output;
+        output.reserve(indices.size());
+        for (const Cluster& cluster : sorted) {
+            output.insert(output.end(), indices.begin() + static_cast<std::ptrdiff_t>(cluster.begin * 3),
+                          indices.begin() + static_cast<std::ptrdiff_t>(cluster.end * 3));
+        }
+        indices.swap(output);
+    }
+
+    // Also drops vertices no triangle uses
+    static void optimizeVertexFetch(CMentalMeshData& mesh) {
+        std::vector<unsigned int> remap(mesh.vertices.size(), MESH_NO_VERTEX);
+        std::vector<Vertex> vertices;
+        vertices.reserve(mesh.vertices.size());
+        for (unsigned int& index : mesh.indices) {
+            if (remap[index] == MESH_NO_VERTEX) {
+                remap[index] = static_cast<unsigned int>(vertices.size());
+                vertices.push_back(mesh.vertices[index]);
+            }
+            index = remap[index];
+        }
+        mesh.vertices = std::move(vertices);
+    }
+
+    // Average vertex shader invocations per triangle through a FIFO post-transform cache
+    static float getAcmr(const unsigned int* indices, size_t indexCount, size_t vertexCount,
+                         size_t cacheSize = MESH_ANALYSIS_CACHE_SIZE) {
+        if (indexCount < 3) {
+            return 0.0F;
+        }
+        std::vector<uint32_t> timestamps(vertexCount, 0);
+        uint32_t time = static_cast<uint32_t>(cacheSize) + 1;
+        size_t misses = 0;
+        for (size_t index = 0; index < indexCount; ++index) {
+            if (time - timestamps[indices[index]] > cacheSize) {
+                timestamps[indices[index]] = time++;
+                ++misses;
+            }
+        }
+        return static_cast<float>(misses) / static_cast<float>(indexCount / 3);
+    }
+
+    static CMentalMeshReport optimize(CMentalMeshData& mesh) {
+        CMentalMeshReport report;
+        report.vertices = mesh.vertices.size();
+        deduplicate(mesh);
+        report.acmr = getAcmr(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+        optimizeVertexCache(mesh.indices, mesh.vertices.size());
+        optimizeOverdraw(mesh.indices, mesh.vertices);
+        optimizeVertexFetch(mesh);
+        report.optimizedVertices = mesh.vertices.size();
+        report.optimizedAcmr = getAcmr(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+        return report;
+    }
+};
+
+} // mentalsdk
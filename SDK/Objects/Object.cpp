@@ -0,0 +1,19 @@
+#include "Object.hpp"
+#include "../Assets/AssetManager.hpp"
+
+namespace mentalsdk {
+
+bool CMentalObject::loadFromFile(const std::string& filePath) {
+    // Same import as the asset manager's: optimized, and cached next to the file
+    CMentalMeshData mesh;
+    if (!CMentalAssetLoader<CMentalMeshData>::decode(CMentalAssetSource{}, filePath, {}, mesh)) {
+        std::cerr << "Error: Could not load model " << filePath << "\n";
+        return false;
+    }
+
+    this->setMesh(mesh, filePath);
+    std::cout << "Loaded OBJ model '" << filePath << "' with " << this->vertices_.size() << " vertices\n";
+    return true;
+}
+
+} // namespace mentalsdk
@@ -4,15 +4,25 @@
 #include <string>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <utility>
 #include <vector>
 #include <memory>
 #include <iostream>
 #include "../Utils/Utils.hpp"
+#include "../Utils/Stats.hpp"
+#include "../Math/Bounds.hpp"
+#include "../Math/Math.hpp"
+#include "Mesh.hpp"
 #include "Texture.hpp"
+#include "TextureAtlas.hpp"
 #include "Environment.hpp"
 #include "../Renderer/Shader.hpp"
+#include "../Renderer/GLState.hpp"
+#include "../Renderer/GLRelease.hpp"
+#include "../Renderer/MeshArena.hpp"
 #include "Script.hpp"
 
 namespace mentalsdk
@@ -27,7 +37,30 @@ enum CMentalObjectType : uint8_t {
     Environment = 5,
 };
 
-class CMentalObject 
+// Objects whose transform changed, so an index refits only those. An object enters at most
+// once until the owner drains the list, so it never outgrows the slots reserved for it;
+// objects may enter from parallel script jobs
+class CMentalTransformListener
+{
+private:
+    std::vector<uint32_t> slots_;
+    std::atomic<uint32_t> count_{ 0 };
+
+public:
+    void reset(size_t capacity) {
+        slots_.assign(capacity, 0);
+        count_.store(0, std::memory_order_relaxed);
+    }
+    void push(uint32_t slot) { slots_[count_.fetch_add(1, std::memory_order_relaxed)] = slot; }
+    void clear() { count_.store(0, std::memory_order_relaxed); }
+
+    [[nodiscard]] const uint32_t* begin() const { return slots_.data(); }
+    [[nodiscard]] const uint32_t* end() const { return slots_.data() + count_.load(std::memory_order_relaxed); }
+    [[nodiscard]] bool empty() const { return count_.load(std::memory_order_relaxed) == 0; }
+};
+
+// Always owned by a shared_ptr: frame packets take their own reference while drawing
+class CMentalObject : public std::enable_shared_from_this<CMentalObject>
 {
 private:
     std::string name_;
@@ -38,24 +71,69 @@ private:
     std::vector<std::shared_ptr<CMentalObject>> nextNode_;
 
     GLuint vao_ = 0, vbo_ = 0, ebo_ = 0;
+    std::shared_ptr<CMentalMeshArena> meshArena_; // When set, geometry lives in the shared arena instead of vao_/vbo_/ebo_
+    CMentalMeshAllocation meshAllocation_;
+    int64_t vertexBytes_ = 0, indexBytes_ = 0; // Private buffer sizes as reported to the stats
     std::vector<Vertex> vertices_;
     std::vector<unsigned int> indices_;
+    AABB localBounds_;
 
     std::string modelPath_;
 
-    std::unique_ptr<CMentalShader> shader_ = nullptr;
-    std::unique_ptr<CMentalTexture> texture_ = nullptr;
+    std::shared_ptr<CMentalShader> shader_ = nullptr; // Shared when it comes from the asset manager
+    std::shared_ptr<CMentalTexture> texture_ = nullptr; // Shared with the texture cache and other objects
+    std::shared_ptr<CMentalTextureAtlas> atlas_ = nullptr; // Takes the place of texture_ when set
+    CMentalAtlasRegion atlasRegion_;
     std::unique_ptr<CMentalScript> script_ = nullptr;
 
     MentalEnvironmentType environmentType_ = MentalEnvironmentType::ClearColor;
     
     mutable bool scriptInitialized_ = false; // Flag to track if script init was called
+    uint64_t scriptTimeNs_ = 0; // Last update() script cost, only measured while script timing is enabled
+
+    bool static_ = false; // Static objects are indexed by the world BVH
+    uint32_t transformVersion_ = 0; // Bumped on every transform change, keys the world cache
+    CMentalTransformListener* transformListener_ = nullptr; // The BVH indexing this object, if any
+    uint32_t transformSlot_ = 0;
+    bool transformQueued_ = false;
+
+    void onTransformChanged() {
+        ++this->transformVersion_;
+        if (this->transformListener_ != nullptr && !this->transformQueued_) {
+            this->transformQueued_ = true;
+            this->transformListener_->push(this->transformSlot_);
+        }
+    }
+
+    // World-space cache refreshed by updateWorldTransform() during the transform stage
+    glm::mat4 worldMatrix_{ 1.0F };
+    AABB worldBounds_;
+    uint32_t worldCacheVersion_ = 0xFFFFFFFFU;
 
 public:
     explicit CMentalObject(std::string name_ = "Undefined node", CMentalObjectType type_ = CMentalObjectType::Triangle)
     : name_(std::move(name_)), objectType_(type_) {}
     
-    ~CMentalObject() = default;
+    // The last reference may drop on any thread (a retired frame packet on the simulation
+    // thread), so the buffers and the arena range go back on the GL thread
+    ~CMentalObject() {
+        if (meshAllocation_.isValid()) {
+            CMentalGLReleaseQueue::instance().defer([arena = meshArena_, allocation = meshAllocation_]() mutable {
+                arena->release(allocation);
+            });
+        }
+        if (vao_ == 0) {
+            return;
+        }
+        CMentalStats::instance().addGpuMemory(MentalGpuResource::VertexBuffer, -vertexBytes_);
+        CMentalStats::instance().addGpuMemory(MentalGpuResource::IndexBuffer, -indexBytes_);
+        CMentalGLReleaseQueue::instance().defer([vao = vao_, vbo = vbo_, ebo = ebo_]() {
+            CMentalGLState::onVertexArrayDeleted(vao);
+            glDeleteVertexArrays(1, &vao);
+            glDeleteBuffers(1, &vbo);
+            glDeleteBuffers(1, &ebo);
+        });
+    }
 
     CMentalObject(const CMentalObject&) = delete;
     CMentalObject& operator=(const CMentalObject&) = delete;
@@ -66,18 +144,97 @@ public:
     [[nodiscard]] const glm::vec3& getRotation() const { return this->rotation_; }
     [[nodiscard]] const glm::vec3& getScale() const { return this->scale_; }
 
-    void setPosition(const glm::vec3& position) { this->position_ = position; }
-    void setRotation(const glm::vec3& rotation) { this->rotation_ = rotation; }
-    void setScale(const glm::vec3& scale) { this->scale_ = scale; }
+    [[nodiscard]] const std::string& getName() const { return this->name_; }
+    [[nodiscard]] CMentalObjectType getType() const { return this->objectType_; }
+
+    void setPosition(const glm::vec3& position) { this->position_ = position; this->onTransformChanged(); }
+    void setRotation(const glm::vec3& rotation) { this->rotation_ = rotation; this->onTransformChanged(); }
+    void setScale(const glm::vec3& scale) { this->scale_ = scale; this->onTransformChanged(); }
+
+    [[nodiscard]] bool isStatic() const { return this->static_; }
+    void setStatic(bool isStatic) { this->static_ = isStatic; }
+    [[nodiscard]] uint32_t getTransformVersion() const { return this->transformVersion_; }
+
+    // One listener at a time; slot is what the object reports itself as
+    void setTransformListener(CMentalTransformListener* listener, uint32_t slot) {
+        this->transformListener_ = listener;
+        this->transformSlot_ = slot;
+        this->transformQueued_ = false;
+    }
+    // The listener took this object's change; the next one reports again
+    void acknowledgeTransform() { this->transformQueued_ = false; }
+
+    [[nodiscard]] const AABB& getLocalBounds() const { return this->localBounds_; }
+    [[nodiscard]] AABB getWorldBounds() const {
+        if (this->worldCacheVersion_ == this->transformVersion_) {
+            return this->worldBounds_;
+        }
+        return this->localBounds_.transformed(this->getTransformMatrix());
+    }
+
+    [[nodiscard]] glm::mat4 getWorldMatrix() const {
+        return this->worldCacheVersion_ == this->transformVersion_ ? this->worldMatrix_ : this->getTransformMatrix();
+    }
+
+    // Only touches this object, so it is safe to run for many objects in parallel
+    void updateWorldTransform() {
+        if (this->worldCacheVersion_ == this->transformVersion_) {
+            return;
+        }
+        this->worldMatrix_ = this->getTransformMatrix();
+        this->worldBounds_ = this->localBounds_.transformed(this->worldMatrix_);
+        this->worldCacheVersion_ = this->transformVersion_;
+    }
+
+    void computeLocalBounds() {
+        this->localBounds_ = AABB{};
+        for (const auto& vertex : this->vertices_) {
+            this->localBounds_.expand(vertex.position);
+        }
+        this->onTransformChanged();
+    }
+
+    // Draws sharing a program and texture end up adjacent once sorted by this key
+    [[nodiscard]] uint64_t getSortKey() const {
+        const uint64_t program = shader_ ? shader_->getProgramID() : 0;
+        const uint64_t texture = atlas_ ? atlas_->getID() : (texture_ ? texture_->getID() : 0);
+        return (program << 32U) | texture;
+    }
+
+    // Exact ray test against the object's triangles, ray is given in world space
+    [[nodiscard]] float intersectRay(const Ray& ray) const {
+        if (this->vertices_.empty()) {
+            return -1.0F;
+        }
+        const glm::mat4 inverse = glm::inverse(this->getWorldMatrix());
+        const Ray localRay{ glm::vec3(inverse * glm::vec4(ray.origin, 1.0F)),
+                            glm::vec3(inverse * glm::vec4(ray.direction, 0.0F)) };
+
+        float closest = -1.0F;
+        const auto testTriangle = [&](unsigned int first, unsigned int second, unsigned int third) {
+            const float distance = localRay.intersect(this->vertices_[first].position,
+                                                      this->vertices_[second].position,
+                                                      this->vertices_[third].position);
+            if (distance >= 0.0F && (closest < 0.0F || distance < closest)) {
+                closest = distance;
+            }
+        };
+
+        if (!this->indices_.empty()) {
+            for (size_t index = 0; index + 2 < this->indices_.size(); index += 3) {
+                testTriangle(this->indices_[index], this->indices_[index + 1], this->indices_[index + 2]);
+            }
+        } else {
+            for (unsigned int index = 0; index + 2 < this->vertices_.size(); index += 3) {
+                testTriangle(index, index + 1, index + 2);
+            }
+        }
+        return closest;
+    }
 
     [[nodiscard]] glm::mat4 getTransformMatrix() const {
-        auto transform = glm::mat4(1.0F);
-        transform = glm::translate(transform, position_);
-        transform = glm::rotate(transform, rotation_[0], glm::vec3(1.0F, 0.0F, 0.0F));
-        transform = glm::rotate(transform, rotation_[1], glm::vec3(0.0F, 1.0F, 0.0F));
-        transform = glm::rotate(transform, rotation_[2], glm::vec3(0.0F, 0.0F, 1.0F));
-        transform = glm::scale(transform, scale_);
-        return transform;
+        // Closed-form TRS instead of four generic matrix products
+        return toGlm(Matrix4::fromTRS(fromGlm(position_), fromGlm(rotation_), fromGlm(scale_)));
     }
 
     void render() const {
@@ -127,13 +284,20 @@ public:
     }
 
     void setupBuffers() {
+        this->computeLocalBounds();
+        this->releaseBuffers();
+
+        if (meshArena_ && this->uploadToArena()) {
+            return;
+        }
+
         // Generate buffers
         glGenVertexArrays(1, &vao_);
         glGenBuffers(1, &vbo_);
         glGenBuffers(1, &ebo_);
         
         // Bind VAO
-        glBindVertexArray(vao_);
+        CMentalGLState::bindVertexArray(vao_);
         
         // Bind and fill VBO
         glBindBuffer(GL_ARRAY_BUFFER, vbo_);
@@ -142,6 +306,10 @@ public:
         // Bind and fill EBO
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices_.size() * sizeof(unsigned int), indices_.data(), GL_STATIC_DRAW);
+        vertexBytes_ = static_cast<int64_t>(vertices_.size() * sizeof(Vertex));
+        indexBytes_ = static_cast<int64_t>(indices_.size() * sizeof(unsigned int));
+        CMentalStats::instance().addGpuMemory(MentalGpuResource::VertexBuffer, vertexBytes_);
+        CMentalStats::instance().addGpuMemory(MentalGpuResource::IndexBuffer, indexBytes_);
         
         // Set vertex attribute pointers
         // Position attribute (location = 0)
@@ -155,14 +323,60 @@ public:
         // Texture coordinate attribute (location = 2)
         glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, texCoord)));
         glEnableVertexAttribArray(2);
-        
-        // Unbind VAO
-        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // Non-indexed meshes get sequential indices, the arena only draws indexed
+    bool uploadToArena() {
+        if (this->indices_.empty()) {
+            std::vector<unsigned int> sequential(this->vertices_.size());
+            for (size_t index = 0; index < sequential.size(); ++index) {
+                sequential[index] = static_cast<unsigned int>(index);
+            }
+            this->meshAllocation_ = meshArena_->allocate(this->vertices_, sequential);
+        } else {
+            this->meshAllocation_ = meshArena_->allocate(this->vertices_, this->indices_);
+        }
+        return this->meshAllocation_.isValid();
     }
 
+    void releaseBuffers() {
+        if (meshAllocation_.isValid()) {
+            meshArena_->release(meshAllocation_);
+        }
+        if (vao_ == 0) {
+            return;
+        }
+        CMentalStats::instance().addGpuMemory(MentalGpuResource::VertexBuffer, -vertexBytes_);
+        CMentalStats::instance().addGpuMemory(MentalGpuResource::IndexBuffer, -indexBytes_);
+        vertexBytes_ = indexBytes_ = 0;
+        CMentalGLState::onVertexArrayDeleted(vao_);
+        glDeleteVertexArrays(1, &vao_);
+        glDeleteBuffers(1, &vbo_);
+        glDeleteBuffers(1, &ebo_);
+        vao_ = vbo_ = ebo_ = 0;
+    }
+
+    // Moves already uploaded geometry into the arena; objects set up later go there directly
+    void setMeshArena(std::shared_ptr<CMentalMeshArena> arena) {
+        if (arena == meshArena_) {
+            return;
+        }
+        const bool uploaded = vao_ != 0 || meshAllocation_.isValid();
+        this->releaseBuffers();
+        meshArena_ = std::move(arena);
+        if (uploaded) {
+            this->setupBuffers();
+        }
+    }
+
+    [[nodiscard]] const std::shared_ptr<CMentalMeshArena>& getMeshArena() const { return this->meshArena_; }
+    [[nodiscard]] const CMentalMeshAllocation& getMeshAllocation() const { return this->meshAllocation_; }
+
     void setNext(std::shared_ptr<CMentalObject> nextNode) { 
         this->nextNode_.emplace_back(std::move(nextNode)); 
     }
+    [[nodiscard]] const std::vector<std::shared_ptr<CMentalObject>>& getNext() const { return this->nextNode_; }
     
     void setObjModel(const std::string& filePath) {
         if (this->loadFromFile(filePath)) {
@@ -171,7 +385,7 @@ public:
     }
 
     void connectShader(const std::string& vertexShaderPath, const std::string& fragmentShaderPath) {
-        this->shader_ = std::make_unique<CMentalShader>(vertexShaderPath, fragmentShaderPath);
+        this->shader_ = std::make_shared<CMentalShader>(vertexShaderPath, fragmentShaderPath);
     }
 
     void connectScript(const std::string& scriptPath) {
@@ -179,20 +393,47 @@ public:
         this->scriptInitialized_ = false; // Reset initialization flag when connecting new script
     }
 
+    [[nodiscard]] CMentalScript* getScript() const { return this->script_.get(); }
+    [[nodiscard]] uint64_t getScriptTimeNs() const { return this->scriptTimeNs_; }
+
     void resetScriptInitialization() {
         this->scriptInitialized_ = false;
     }
 
     bool loadFromFile(const std::string& filePath);
 
-    void setShader(std::unique_ptr<CMentalShader> shader) { 
+    // Copies geometry loaded elsewhere, e.g. by the asset manager, and uploads it. The path
+    // is only recorded, for scenes to save
+    void setMesh(const CMentalMeshData& mesh, const std::string& path = {}) {
+        this->vertices_ = mesh.vertices;
+        this->indices_ = mesh.indices;
+        this->modelPath_ = path;
+        this->setupBuffers();
+    }
+    [[nodiscard]] const std::string& getModelPath() const { return this->modelPath_; }
+
+    void setShader(std::shared_ptr<CMentalShader> shader) { 
         this->shader_ = std::move(shader); 
     }
-    void setTexture(std::unique_ptr<CMentalTexture> texture) { this->texture_ = std::move(texture); }
+    void setTexture(std::shared_ptr<CMentalTexture> texture) { this->texture_ = std::move(texture); }
+    [[nodiscard]] const CMentalShader* getShader() const { return this->shader_.get(); }
+    [[nodiscard]] CMentalShader* getShader() { return this->shader_.get(); }
+    [[nodiscard]] const CMentalTexture* getTexture() const { return this->texture_.get(); }
+
+    // Samples a region of a shared texture array instead, so objects with different images batch together
+    void setAtlasTexture(std::shared_ptr<CMentalTextureAtlas> atlas, const CMentalAtlasRegion& region) {
+        this->atlas_ = region.isValid() ? std::move(atlas) : nullptr;
+        this->atlasRegion_ = region;
+    }
+    [[nodiscard]] const CMentalTextureAtlas* getAtlas() const { return this->atlas_.get(); }
+    [[nodiscard]] const CMentalAtlasRegion& getAtlasRegion() const { return this->atlasRegion_; }
     
-    void render(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection) const {
-        // Call script functions if script is available
+    // Runs the attached script and applies the transforms it returns
+    void update() {
         if (script_ && script_->hasScript()) {
+            const bool timed = CMentalStats::instance().isScriptTimingEnabled();
+            const auto start = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+
             // Call init only once
             if (!scriptInitialized_) {
                 script_->callInit();
@@ -209,70 +450,104 @@ public:
             float scriptRotation = script_->getRotationFromScript();
             if (scriptRotation != 0.0f) {
                 // Apply rotation around Y axis
-                const_cast<CMentalObject*>(this)->rotation_.y = scriptRotation;
+                this->rotation_.y = scriptRotation;
+                this->onTransformChanged();
             }
             
             // Try to get position and scale from script as well
             glm::vec3 scriptPosition = script_->getPositionFromScript();
             if (scriptPosition != glm::vec3(0.0f)) {
-                const_cast<CMentalObject*>(this)->position_ = scriptPosition;
+                this->position_ = scriptPosition;
+                this->onTransformChanged();
             }
             
             glm::vec3 scriptScale = script_->getScaleFromScript();
             if (scriptScale != glm::vec3(1.0f)) {
-                const_cast<CMentalObject*>(this)->scale_ = scriptScale;
+                this->scale_ = scriptScale;
+                this->onTransformChanged();
+            }
+
+            if (timed) {
+                this->scriptTimeNs_ = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count());
             }
         }
+    }
+
+    void render(const glm::mat4& /*model*/, const glm::mat4& view, const glm::mat4& projection) {
+        this->update();
+        this->updateWorldTransform();
+        this->draw(view, projection);
+    }
+
+    void draw(const glm::mat4& view, const glm::mat4& projection) const {
+        this->draw(this->getWorldMatrix(), view, projection);
+    }
+
+    // Program, camera matrices and texture; shared by single draws and batches. Expects a
+    // valid shader and returns the number of state changes made
+    uint64_t bindMaterial(const glm::mat4& view, const glm::mat4& projection) const {
+        // Use the shader, the state cache skips it when already current
+        const bool programChanged = shader_->use();
+        uint64_t stateChanges = programChanged ? 1 : 0;
         
+        // Set matrices
+        shader_->setMat4("view", view);
+        shader_->setMat4("projection", projection);
+        
+        // Bind texture if available; an atlas binds the same way, as a sampler2DArray
+        if (atlas_ && atlas_->isValid()) {
+            stateChanges += atlas_->bind(0) ? 1 : 0;
+            if (programChanged) {
+                shader_->setInt("texture1", 0);
+            }
+        } else if (texture_ && texture_->isValid()) {
+            stateChanges += texture_->bind(0) ? 1 : 0; // Bind to texture unit 0
+            if (programChanged) {
+                shader_->setInt("texture1", 0); // Sampler uniforms stick to the program
+            }
+        }
+        return stateChanges;
+    }
+
+    // Model matrix is passed in so a render thread can draw from a frame snapshot
+    void draw(const glm::mat4& objectModel, const glm::mat4& view, const glm::mat4& projection) const {
         if (!shader_ || !shader_->isValid()) {
             std::cerr << "Warning: No valid shader for object rendering\n";
             return; // No shader or invalid shader, can't render
         }
         
-        // Check for shader hot reload (const_cast needed for hot reload functionality)
-        const_cast<CMentalShader*>(shader_.get())->checkAndReload();
-        
-        // Use the shader
-        shader_->use();
-        
-        // Calculate model matrix with current transformations
-        glm::mat4 objectModel = getTransformMatrix();
-        
-        // Set matrices
+        uint64_t stateChanges = this->bindMaterial(view, projection);
         shader_->setMat4("model", objectModel);
-        shader_->setMat4("view", view);
-        shader_->setMat4("projection", projection);
-        
-        // Bind texture if available
-        if (texture_ && texture_->isValid()) {
-            texture_->bind(0); // Bind to texture unit 0
-            shader_->setInt("texture1", 0);
+        if (atlas_) {
+            // Generic attribute values stand in for the per-instance region of a batch
+            glVertexAttrib4fv(INSTANCE_ATLAS_LOCATION, &atlasRegion_.rect.x);
+            glVertexAttrib1f(INSTANCE_LAYER_LOCATION, atlasRegion_.layer);
         }
         
-        // Bind VAO and draw
-        glBindVertexArray(vao_);
-        
-        if (!indices_.empty()) {
-            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices_.size()), GL_UNSIGNED_INT, nullptr);
+        // Bind VAO and draw; arena meshes from the same pool share one VAO
+        if (meshAllocation_.isValid()) {
+            stateChanges += meshArena_->bind(meshAllocation_) ? 1 : 0;
+            CMentalMeshArena::draw(meshAllocation_);
         } else {
-            glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertices_.size()));
-        }
-        
-        glBindVertexArray(0);
-        
-        // Check for OpenGL errors
-        GLenum error = glGetError();
-        if (error != GL_NO_ERROR) {
-            std::cerr << "OpenGL error during rendering: " << error << "\n";
+            stateChanges += CMentalGLState::bindVertexArray(vao_) ? 1 : 0;
+            if (!indices_.empty()) {
+                glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices_.size()), GL_UNSIGNED_INT, nullptr);
+            } else {
+                glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertices_.size()));
+            }
         }
+        CMentalStats& stats = CMentalStats::instance();
+        stats.addDrawCall((indices_.empty() ? vertices_.size() : indices_.size()) / 3);
+        stats.addStateChanges(stateChanges);
+        // Errors are reported by the debug callback, see CMentalGLDebug
     }
 
     void cleanup() {
-        glDeleteVertexArrays(1, &vao_);
-        glDeleteBuffers(1, &vbo_);
-        glDeleteBuffers(1, &ebo_);
+        this->releaseBuffers();
         this->shader_.reset();
         this->texture_.reset();
+        this->atlas_.reset();
     }
 };
 
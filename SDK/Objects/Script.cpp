@@ -0,0 +1,73 @@
+#include "Script.hpp"
+#include "Object.hpp"
+#include "SpatialHash.hpp"
+#include <utility>
+#include <vector>
+
+namespace mentalsdk {
+
+namespace {
+
+const CMentalSpatialHash* spatialIndexOf(lua_State* L) {
+    return static_cast<const CMentalSpatialHash*>(lua_touserdata(L, lua_upvalueindex(1)));
+}
+
+glm::vec3 checkVec3(lua_State* L, int first) {
+    return { static_cast<float>(luaL_checknumber(L, first)),
+             static_cast<float>(luaL_checknumber(L, first + 1)),
+             static_cast<float>(luaL_checknumber(L, first + 2)) };
+}
+
+int pushObjectNames(lua_State* L, const std::vector<CMentalObject*>& objects) {
+    lua_createtable(L, static_cast<int>(objects.size()), 0);
+    for (size_t index = 0; index < objects.size(); ++index) {
+        lua_pushstring(L, objects[index]->getName().c_str());
+        lua_rawseti(L, -2, static_cast<lua_Integer>(index + 1));
+    }
+    return 1;
+}
+
+// queryRadius(x, y, z, radius)
+int luaQueryRadius(lua_State* L) {
+    std::vector<CMentalObject*> objects;
+    spatialIndexOf(L)->querySphere(checkVec3(L, 1), static_cast<float>(luaL_checknumber(L, 4)), objects);
+    return pushObjectNames(L, objects);
+}
+
+// queryBox(minX, minY, minZ, maxX, maxY, maxZ)
+int luaQueryBox(lua_State* L) {
+    std::vector<CMentalObject*> objects;
+    spatialIndexOf(L)->queryBox(AABB{ checkVec3(L, 1), checkVec3(L, 4) }, objects);
+    return pushObjectNames(L, objects);
+}
+
+// queryNearest(x, y, z, count), sorted by distance, without the object running the script
+int luaQueryNearest(lua_State* L) {
+    std::vector<CMentalObject*> objects;
+    const lua_Integer count = luaL_checkinteger(L, 4);
+    const auto* self = static_cast<const CMentalObject*>(lua_touserdata(L, lua_upvalueindex(2)));
+    spatialIndexOf(L)->queryNearest(checkVec3(L, 1), count > 0 ? static_cast<size_t>(count) : 0, objects, self);
+    return pushObjectNames(L, objects);
+}
+
+} // namespace
+
+void CMentalScript::bindSpatialIndex(const CMentalSpatialHash* index, const CMentalObject* self) {
+    if (!L_ || index == nullptr) {
+        return;
+    }
+
+    const std::pair<const char*, lua_CFunction> functions[] = {
+        { "queryRadius", luaQueryRadius },
+        { "queryBox", luaQueryBox },
+        { "queryNearest", luaQueryNearest },
+    };
+    for (const auto& [name, function] : functions) {
+        lua_pushlightuserdata(L_, const_cast<CMentalSpatialHash*>(index));
+        lua_pushlightuserdata(L_, const_cast<CMentalObject*>(self));
+        lua_pushcclosure(L_, function, 2);
+        lua_setglobal(L_, name);
+    }
+}
+
+} // namespace mentalsdk
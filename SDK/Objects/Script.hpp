@@ -2,6 +2,7 @@
 #include <string>
 #include <utility>
 #include <iostream>
+#include <glm/glm.hpp>
 
 extern "C" {
     #include <lua/lua.h>
@@ -12,6 +13,9 @@ extern "C" {
 namespace mentalsdk
 {
 
+class CMentalObject;
+class CMentalSpatialHash;
+
 class CMentalScript
 {
 private:
@@ -38,6 +42,8 @@ public:
     CMentalScript(CMentalScript&&) = delete;
     CMentalScript& operator=(CMentalScript&&) = delete;
 
+    [[nodiscard]] const std::string& getScriptFile() const { return this->scriptFile_; }
+
     void loadScript(const std::string& scriptFile) {
         if (!L_) {
             std::cerr << "Lua state not initialized\n";
@@ -83,6 +89,10 @@ public:
         // For now, we'll just call Lua functions from C++
     }
 
+    // Exposes queryRadius/queryBox/queryNearest to the script, each returning a table of object names.
+    // queryNearest leaves out self, the object running the script
+    void bindSpatialIndex(const CMentalSpatialHash* index, const CMentalObject* self = nullptr);
+
     void callInit() {
         if (!L_ || !scriptExists_) {
             return;
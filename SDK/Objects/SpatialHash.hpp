@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+#include "../Math/Bounds.hpp"
+
+namespace mentalsdk
+{
+
+class CMentalObject;
+
+const float DEFAULT_SPATIAL_CELL_SIZE = 4.0F;
+const uint32_t SPATIAL_INVALID_ENTRY = 0xFFFFFFFFU;
+const double SPATIAL_CELL_LIMIT = 1 << 30; // Cell coordinates are clamped to this, ring and range loops stay in int
+
+// Uniform spatial hash over object positions. Moving an object inside its cell is a
+// position write, crossing a cell is an O(1) swap-remove plus push.
+class CMentalSpatialHash
+{
+private:
+    struct Entry {
+        CMentalObject* object = nullptr;
+        glm::vec3 position{ 0.0F };
+        uint64_t cell = 0;
+        uint32_t slot = 0; // Index inside the cell's entry list
+    };
+
+    float cellSize_ = DEFAULT_SPATIAL_CELL_SIZE;
+    float inverseCellSize_ = 1.0F / DEFAULT_SPATIAL_CELL_SIZE;
+    std::vector<Entry> entries_;
+    std::vector<uint32_t> freeEntries_;
+    std::unordered_map<const CMentalObject*, uint32_t> lookup_;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells_;
+    size_t size_ = 0;
+
+    // In double and clamped, far-away positions and huge bounds land in the outermost cells
+    // instead of overflowing; NaN goes to cell 0
+    [[nodiscard]] int cellCoordinate(float value) const {
+        const double cell = std::floor(static_cast<double>(value) * inverseCellSize_);
+        return cell == cell ? static_cast<int>(std::clamp(cell, -SPATIAL_CELL_LIMIT, SPATIAL_CELL_LIMIT)) : 0;
+    }
+
+    [[nodiscard]] glm::ivec3 cellOf(const glm::vec3& position) const {
+        return { this->cellCoordinate(position.x), this->cellCoordinate(position.y), this->cellCoordinate(position.z) };
+    }
+
+    // 21 bits per axis, far-away cells may alias which only costs extra distance checks
+    static uint64_t keyOf(const glm::ivec3& cell) {
+        const uint64_t mask = 0x1FFFFFU;
+        return ((static_cast<uint64_t>(cell.x) & mask) << 42U) |
+               ((static_cast<uint64_t>(cell.y) & mask) << 21U) |
+               (static_cast<uint64_t>(cell.z) & mask);
+    }
+
+    void link(uint32_t entryIndex, uint64_t cell) {
+        auto& list = cells_[cell];
+        entries_[entryIndex].cell = cell;
+        entries_[entryIndex].slot = static_cast<uint32_t>(list.size());
+        list.push_back(entryIndex);
+    }
+
+    void unlink(uint32_t entryIndex) {
+        const Entry& entry = entries_[entryIndex];
+        auto found = cells_.find(entry.cell);
+        if (found == cells_.end()) {
+            return;
+        }
+        auto& list = found->second;
+        const uint32_t moved = list.back();
+        list[entry.slot] = moved;
+        entries_[moved].slot = entry.slot;
+        list.pop_back();
+        if (list.empty()) {
+            cells_.erase(found);
+        }
+    }
+
+    template <typename Visitor>
+    void forEachInCell(const glm::ivec3& cell, Visitor&& visitor) const {
+        auto found = cells_.find(keyOf(cell));
+        if (found == cells_.end()) {
+            return;
+        }
+        for (const uint32_t entryIndex : found->second) {
+            visitor(entries_[entryIndex]);
+        }
+    }
+
+    // Visits every entry in cells overlapping [lower, upper], or all entries when that is cheaper
+    template <typename Visitor>
+    void forEachInRange(const glm::vec3& lower, const glm::vec3& upper, Visitor&& visitor) const {
+        const glm::ivec3 first = this->cellOf(lower);
+        const glm::ivec3 last = this->cellOf(upper);
+        const double cellCount = (static_cast<double>(last.x) - first.x + 1) *
+                                 (static_cast<double>(last.y) - first.y + 1) *
+                                 (static_cast<double>(last.z) - first.z + 1);
+        if (cellCount > static_cast<double>(cells_.size())) {
+            for (const auto& [key, list] : cells_) {
+                for (const uint32_t entryIndex : list) {
+                    visitor(entries_[entryIndex]);
+                }
+            }
+            return;
+        }
+        for (int x = first.x; x <= last.x; ++x) {
+            for (int y = first.y; y <= last.y; ++y) {
+                for (int z = first.z; z <= last.z; ++z) {
+                    this->forEachInCell(glm::ivec3(x, y, z), visitor);
+                }
+            }
+        }
+    }
+
+public:
+    explicit CMentalSpatialHash(float cellSize = DEFAULT_SPATIAL_CELL_SIZE) { this->setCellSize(cellSize); }
+    ~CMentalSpatialHash() = default;
+
+    CMentalSpatialHash(const CMentalSpatialHash&) = delete;
+    CMentalSpatialHash& operator=(const CMentalSpatialHash&) = delete;
+    CMentalSpatialHash(CMentalSpatialHash&&) = delete;
+    CMentalSpatialHash& operator=(CMentalSpatialHash&&) = delete;
+
+    // Cell size should be close to the typical query radius; changing it rehashes everything
+    void setCellSize(float cellSize) {
+        cellSize_ = cellSize > 0.0F ? cellSize : DEFAULT_SPATIAL_CELL_SIZE;
+        inverseCellSize_ = 1.0F / cellSize_;
+        cells_.clear();
+        for (uint32_t index = 0; index < entries_.size(); ++index) {
+            if (entries_[index].object != nullptr) {
+                this->link(index, keyOf(this->cellOf(entries_[index].position)));
+            }
+        }
+    }
+    [[nodiscard]] float getCellSize() const { return cellSize_; }
+    [[nodiscard]] size_t size() const { return size_; }
+
+    void clear() {
+        entries_.clear();
+        freeEntries_.clear();
+        lookup_.clear();
+        cells_.clear();
+        size_ = 0;
+    }
+
+    // Inserts the object or moves it when already present
+    void update(CMentalObject* object, const glm::vec3& position) {
+        auto found = lookup_.find(object);
+        if (found == lookup_.end()) {
+            uint32_t entryIndex = 0;
+            if (!freeEntries_.empty()) {
+                entryIndex = freeEntries_.back();
+                freeEntries_.pop_back();
+            } else {
+                entryIndex = static_cast<uint32_t>(entries_.size());
+                entries_.emplace_back();
+            }
+            entries_[entryIndex].object = object;
+            entries_[entryIndex].position = position;
+            this->link(entryIndex, keyOf(this->cellOf(position)));
+            lookup_.emplace(object, entryIndex);
+            ++size_;
+            return;
+        }
+
+        Entry& entry = entries_[found->second];
+        entry.position = position;
+        const uint64_t cell = keyOf(this->cellOf(position));
+        if (cell != entry.cell) {
+            this->unlink(found->second);
+            this->link(found->second, cell);
+        }
+    }
+
+    void remove(const CMentalObject* object) {
+        auto found = lookup_.find(object);
+        if (found == lookup_.end()) {
+            return;
+        }
+        this->unlink(found->second);
+        entries_[found->second] = Entry{};
+        freeEntries_.push_back(found->second);
+        lookup_.erase(found);
+        --size_;
+    }
+
+    void querySphere(const glm::vec3& center, float radius, std::vector<CMentalObject*>& result) const {
+        const float radiusSquared = radius * radius;
+        this->forEachInRange(center - glm::vec3(radius), center + glm::vec3(radius), [&](const Entry& entry) {
+            const glm::vec3 delta = entry.position - center;
+            if (glm::dot(delta, delta) <= radiusSquared) {
+                result.push_back(entry.object);
+            }
+        });
+    }
+
+    void queryBox(const AABB& box, std::vector<CMentalObject*>& result) const {
+        if (!box.isValid()) {
+            return;
+        }
+        this->forEachInRange(box.min, box.max, [&](const Entry& entry) {
+            const glm::vec3& point = entry.position;
+            if (point.x >= box.min.x && point.y >= box.min.y && point.z >= box.min.z &&
+                point.x <= box.max.x && point.y <= box.max.y && point.z <= box.max.z) {
+                result.push_back(entry.object);
+            }
+        });
+    }
+
+    // Expands cell rings around the query point until the k-th candidate is provably closest.
+    // An object standing at point is its own nearest neighbour unless passed as exclude
+    void queryNearest(const glm::vec3& point, size_t count, std::vector<CMentalObject*>& result,
+                      const CMentalObject* exclude = nullptr) const {
+        if (count == 0 || size_ == 0) {
+            return;
+        }
+
+        using Candidate = std::pair<float, CMentalObject*>;
+        std::vector<Candidate> heap;
+        heap.reserve(count + 1);
+        const auto consider = [&](const Entry& entry) {
+            if (entry.object == exclude) {
+                return;
+            }
+            const glm::vec3 delta = entry.position - point;
+            const float distanceSquared = glm::dot(delta, delta);
+            if (heap.size() < count) {
+                heap.emplace_back(distanceSquared, entry.object);
+                std::push_heap(heap.begin(), heap.end());
+            } else if (distanceSquared < heap.front().first) {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.back() = Candidate{ distanceSquared, entry.object };
+                std::push_heap(heap.begin(), heap.end());
+            }
+        };
+
+        const glm::ivec3 center = this->cellOf(point);
+        for (int ring = 0;; ++ring) {
+            // Once the shell covers more cells than are occupied, a flat scan is cheaper
+            const double shellCells = std::pow(2.0 * ring + 1.0, 3.0);
+            if (shellCells > static_cast<double>(cells_.size()) * 2.0) {
+                heap.clear();
+                for (const auto& [key, list] : cells_) {
+                    for (const uint32_t entryIndex : list) {
+                        consider(entries_[entryIndex]);
+                    }
+                }
+                break;
+            }
+
+            for (int x = -ring; x <= ring; ++x) {
+                for (int y = -ring; y <= ring; ++y) {
+                    const bool onFace = std::abs(x) == ring || std::abs(y) == ring;
+                    for (int z = -ring; z <= ring; z += (onFace ? 1 : std::max(1, 2 * ring))) {
+                        this->forEachInCell(glm::ivec3(center.x + x, center.y + y, center.z + z), consider);
+                    }
+                }
+            }
+
+            // Anything outside this shell is at least ring * cellSize away
+            const float reach = static_cast<float>(ring) * cellSize_;
+            if (heap.size() == count && heap.front().first <= reach * reach) {
+                break;
+            }
+        }
+
+        std::sort_heap(heap.begin(), heap.end());
+        for (const auto& candidate : heap) {
+            result.push_back(candidate.second);
+        }
+    }
+};
+
+} // mentalsdk
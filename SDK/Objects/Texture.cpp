@@ -0,0 +1,213 @@
+#include "Texture.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <utility>
+#include <vector>
+#include "../Renderer/DDS.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image/stb_image.h"
+
+namespace mentalsdk {
+
+namespace {
+
+GLenum compressedFormat(MentalBlockFormat format, bool srgb) {
+    switch (format) {
+        case BC3: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case BC5: return GL_COMPRESSED_RG_RGTC2;
+        default: return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    }
+}
+
+} // namespace
+
+bool CMentalTexture::loadFromFile(const std::string& filePath, const CMentalTextureParams& params) {
+    CMentalMipChain chain;
+    const bool loaded = std::filesystem::path(filePath).extension() == ".dds"
+                            ? this->loadCompressed(CMentalFileBytes::map(filePath), filePath, params)
+                            : decodeFile(filePath, params, chain) && this->upload(std::move(chain), params);
+    if (loaded) {
+        sourcePath_ = filePath;
+    }
+    return loaded;
+}
+
+bool CMentalTexture::loadFromMemory(CMentalFileBytes bytes, const std::string& name, const CMentalTextureParams& params) {
+    CMentalMipChain chain;
+    const bool loaded = isCompressedFile(bytes.data, bytes.size)
+                            ? this->loadCompressed(std::move(bytes), name, params)
+                            : decodeMemory(bytes.data, bytes.size, name, params, chain) && this->upload(std::move(chain), params);
+    if (loaded) {
+        sourcePath_ = name;
+    }
+    return loaded;
+}
+
+bool CMentalTexture::isCompressedFile(const uint8_t* data, size_t size) {
+    uint32_t magic = 0;
+    if (data == nullptr || size < sizeof(magic)) {
+        return false;
+    }
+    std::memcpy(&magic, data, sizeof(magic));
+    return magic == DDS_MAGIC;
+}
+
+bool CMentalTexture::decodeFile(const std::string& filePath, const CMentalTextureParams& params, CMentalMipChain& chain) {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    stbi_set_flip_vertically_on_load_thread(1);
+    unsigned char* pixels = stbi_load(filePath.c_str(), &width, &height, &channels, 4);
+    if (pixels == nullptr) {
+        std::cerr << "Error loading texture " << filePath << ": " << stbi_failure_reason() << "\n";
+        return false;
+    }
+    std::vector<uint8_t> base(pixels, pixels + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(pixels);
+    chain = CMentalMipBuilder::build(std::move(base), width, height, params.mipFilter, params.srgb, params.mipmaps);
+    return true;
+}
+
+bool CMentalTexture::decodeMemory(const uint8_t* data, size_t size, const std::string& name, const CMentalTextureParams& params,
+                                  CMentalMipChain& chain) {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    stbi_set_flip_vertically_on_load_thread(1);
+    unsigned char* pixels = data != nullptr && size <= static_cast<size_t>(INT32_MAX)
+                                ? stbi_load_from_memory(data, static_cast<int>(size), &width, &height, &channels, 4)
+                                : nullptr;
+    if (pixels == nullptr) {
+        std::cerr << "Error loading texture " << name << ": " << (data != nullptr ? stbi_failure_reason() : "no data") << "\n";
+        return false;
+    }
+    std::vector<uint8_t> base(pixels, pixels + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(pixels);
+    chain = CMentalMipBuilder::build(std::move(base), width, height, params.mipFilter, params.srgb, params.mipmaps);
+    return true;
+}
+
+bool CMentalTexture::upload(CMentalMipChain chain, const CMentalTextureParams& params) {
+    if (chain.levels.empty()) {
+        return false;
+    }
+    auto source = std::make_unique<Source>();
+    source->chain = std::move(chain);
+    source->internalFormat = params.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+    for (const CMentalMipLevel& level : source->chain.levels) {
+        source->levels.push_back({ level.pixels.data(), level.pixels.size(), level.width, level.height });
+    }
+    channels_ = 4;
+    return this->applySource(std::move(source), params);
+}
+
+// Cooked by mental_texcook: blocks go from the mapped bytes to the driver, no decode and no mip generation
+bool CMentalTexture::loadCompressed(CMentalFileBytes bytes, const std::string& name, const CMentalTextureParams& params) {
+    auto source = std::make_unique<Source>();
+    source->bytes = std::move(bytes);
+    CMentalDDSImage image;
+    if (!CMentalDDS::parse(source->bytes.data, source->bytes.size, image)) {
+        std::cerr << "Error loading texture " << name << ": not a readable BC1/BC3/BC5 DDS file\n";
+        return false;
+    }
+    if (image.format != BC5 && !GLEW_EXT_texture_compression_s3tc) { // RGTC is core since GL 3.0
+        std::cerr << "Error loading texture " << name << ": S3TC compression is not supported\n";
+        return false;
+    }
+
+    source->internalFormat = compressedFormat(image.format, params.srgb);
+    source->compressed = true;
+    const size_t levelCount = params.mipmaps ? image.levels.size() : 1;
+    for (size_t level = 0; level < levelCount; ++level) {
+        const CMentalDDSLevel& stored = image.levels[level];
+        source->levels.push_back({ stored.data, stored.size, stored.width, stored.height });
+    }
+    channels_ = image.format == BC5 ? 2 : (image.format == BC3 ? 4 : 3);
+    return this->applySource(std::move(source), params);
+}
+
+bool CMentalTexture::applySource(std::unique_ptr<Source> source, const CMentalTextureParams& params) {
+    params_ = params;
+    if (textureID_ == 0) {
+        glGenTextures(1, &textureID_);
+    }
+    width_ = source->levels.front().width;
+    height_ = source->levels.front().height;
+    levelCount_ = static_cast<int>(source->levels.size());
+    levelBytes_.clear();
+    for (const Level& level : source->levels) {
+        levelBytes_.push_back(static_cast<int64_t>(level.size));
+    }
+
+    // Streaming starts from the small levels only; the streamer brings in the rest as needed
+    floorLevel_ = 0;
+    if (params.streaming && levelCount_ > 1) {
+        while (floorLevel_ + 1 < levelCount_ && std::max(source->levels[static_cast<size_t>(floorLevel_)].width,
+                                                         source->levels[static_cast<size_t>(floorLevel_)].height) > TEXTURE_STREAMING_RESIDENT_SIZE) {
+            ++floorLevel_;
+        }
+    }
+
+    CMentalGLState::bindTexture(0, textureID_);
+    for (int level = floorLevel_; level < levelCount_; ++level) {
+        this->uploadLevel(*source, level);
+    }
+    residentLevel_ = floorLevel_;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, residentLevel_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount_ - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, params.wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, params.wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelCount_ > 1 ? params.minFilter : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, params.magFilter);
+    CMentalGLState::bindTexture(0, 0);
+
+    source_ = params.streaming && levelCount_ > 1 ? std::move(source) : nullptr;
+    this->setGpuBytes(this->getBytesFrom(residentLevel_));
+    return true;
+}
+
+void CMentalTexture::uploadLevel(const Source& source, int level) const {
+    const Level& data = source.levels[static_cast<size_t>(level)];
+    if (source.compressed) {
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, source.internalFormat, data.width, data.height, 0,
+                               static_cast<GLsizei>(data.size), data.data);
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, level, static_cast<GLint>(source.internalFormat), data.width, data.height, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, data.data);
+    }
+}
+
+void CMentalTexture::makeResident(int level) {
+    level = std::max(level, 0);
+    if (!source_ || level >= residentLevel_) {
+        return;
+    }
+    CMentalGLState::bindTexture(0, textureID_);
+    for (int index = residentLevel_ - 1; index >= level; --index) {
+        this->uploadLevel(*source_, index);
+    }
+    residentLevel_ = level;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, residentLevel_);
+    CMentalGLState::bindTexture(0, 0);
+    this->setGpuBytes(this->getBytesFrom(residentLevel_));
+}
+
+void CMentalTexture::evict(int level) {
+    level = std::min(level, floorLevel_);
+    if (!source_ || level <= residentLevel_) {
+        return;
+    }
+    CMentalGLState::bindTexture(0, textureID_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level); // Stop sampling the levels before freeing them
+    for (int index = residentLevel_; index < level; ++index) {
+        glTexImage2D(GL_TEXTURE_2D, index, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+    residentLevel_ = level;
+    CMentalGLState::bindTexture(0, 0);
+    this->setGpuBytes(this->getBytesFrom(residentLevel_));
+}
+
+} // namespace mentalsdk
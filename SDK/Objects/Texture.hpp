@@ -1,25 +1,95 @@
 #pragma once
 
 #include <GL/glew.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
+#include "../Utils/MappedFile.hpp"
+#include "../Utils/Stats.hpp"
+#include "../Renderer/GLState.hpp"
+#include "../Renderer/GLRelease.hpp"
+#include "../Renderer/MipBuilder.hpp"
 
 namespace mentalsdk
 {
 
+const int TEXTURE_STREAMING_RESIDENT_SIZE = 64; // Streaming textures keep every level this small resident
+const int TEXTURE_LEVEL_NOT_REQUESTED = 1 << 30;
+
+// Sampler and format choices made at upload; part of the texture cache key
+struct CMentalTextureParams {
+    GLint wrap = GL_REPEAT;
+    GLint minFilter = GL_LINEAR_MIPMAP_LINEAR;
+    GLint magFilter = GL_LINEAR;
+    bool mipmaps = true;
+    bool srgb = false;
+    MentalMipFilter mipFilter = Box;
+    bool streaming = false; // Keep the levels in memory and make large mips resident on demand
+
+    [[nodiscard]] std::string getKey() const {
+        return std::to_string(wrap) + ":" + std::to_string(minFilter) + ":" + std::to_string(magFilter) + ":" +
+               (mipmaps ? "m" : "-") + (srgb ? "s" : "-") + (mipFilter == Kaiser ? "k" : "b") + (streaming ? "t" : "-");
+    }
+};
+
 class CMentalTexture
 {
 private:
+    struct Level {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    // Where level data comes from: decoded pixels or the bytes of a cooked file
+    struct Source {
+        CMentalMipChain chain;
+        CMentalFileBytes bytes;
+        std::vector<Level> levels;
+        GLenum internalFormat = GL_RGBA8;
+        bool compressed = false;
+    };
+
     GLuint textureID_ = 0;
     int width_ = 0;
     int height_ = 0;
     int channels_ = 0;
+    int64_t gpuBytes_ = 0; // Reported to CMentalStats as texture memory
+    std::string sourcePath_; // What scenes save to reload it
+    CMentalTextureParams params_;
+
+    // Residency, levels [residentLevel_, levelCount_) are in GL. source_ is kept only while streaming
+    std::unique_ptr<Source> source_;
+    std::vector<int64_t> levelBytes_;
+    int levelCount_ = 0;
+    int residentLevel_ = 0;
+    int floorLevel_ = 0;
+    mutable std::atomic<int> requestedLevel_{ TEXTURE_LEVEL_NOT_REQUESTED }; // A hint from culling, not texture state
+
+    void setGpuBytes(int64_t bytes) {
+        CMentalStats::instance().addGpuMemory(MentalGpuResource::TextureMemory, bytes - gpuBytes_);
+        gpuBytes_ = bytes;
+    }
+
+    bool loadCompressed(CMentalFileBytes bytes, const std::string& name, const CMentalTextureParams& params);
+    bool applySource(std::unique_ptr<Source> source, const CMentalTextureParams& params);
+    void uploadLevel(const Source& source, int level) const;
 
 public:
     CMentalTexture() = default;
     ~CMentalTexture() {
         if (textureID_ != 0) {
-            glDeleteTextures(1, &textureID_);
+            CMentalGLReleaseQueue::instance().defer([texture = textureID_]() {
+                CMentalGLState::onTextureDeleted(texture);
+                glDeleteTextures(1, &texture);
+            });
         }
+        this->setGpuBytes(0);
     }
 
     CMentalTexture(const CMentalTexture&) = delete;
@@ -27,21 +97,65 @@ public:
     CMentalTexture(CMentalTexture&&) = delete;
     CMentalTexture& operator=(CMentalTexture&&) = delete;
 
-    bool loadFromFile(const std::string& filePath);
+    // .dds files cooked by mental_texcook upload their stored mips as is; anything else goes through stb_image
+    bool loadFromFile(const std::string& filePath, const CMentalTextureParams& params = CMentalTextureParams{});
+
+    // Same from bytes already in memory, e.g. an archive entry; name is for messages. A DDS
+    // keeps the bytes (and whatever owns them) for as long as it streams from them
+    bool loadFromMemory(CMentalFileBytes bytes, const std::string& name, const CMentalTextureParams& params = CMentalTextureParams{});
+
+    // Decoding and mip building touch no GL state, so loaders run them on worker threads
+    static bool decodeFile(const std::string& filePath, const CMentalTextureParams& params, CMentalMipChain& chain);
+    static bool decodeMemory(const uint8_t* data, size_t size, const std::string& name, const CMentalTextureParams& params,
+                             CMentalMipChain& chain);
+    [[nodiscard]] static bool isCompressedFile(const uint8_t* data, size_t size);
+    bool upload(CMentalMipChain chain, const CMentalTextureParams& params);
+
+    // Any thread, typically culling: asks for the given level or a finer one this frame
+    void requestLevel(int level) const {
+        int current = requestedLevel_.load(std::memory_order_relaxed);
+        while (level < current && !requestedLevel_.compare_exchange_weak(current, level, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Returns the finest level asked for since the last call and forgets it
+    int takeRequestedLevel() { return requestedLevel_.exchange(TEXTURE_LEVEL_NOT_REQUESTED, std::memory_order_relaxed); }
+
+    // GL thread: uploads every level down to the given one, or releases every finer level
+    void makeResident(int level);
+    void evict(int level);
+
+    [[nodiscard]] int64_t getBytesFrom(int level) const {
+        int64_t bytes = 0;
+        for (int index = std::max(level, 0); index < levelCount_; ++index) {
+            bytes += levelBytes_[static_cast<size_t>(index)];
+        }
+        return bytes;
+    }
     
-    void bind(unsigned int unit = 0) const {
-        glActiveTexture(GL_TEXTURE0 + unit);
-        glBindTexture(GL_TEXTURE_2D, textureID_);
+    // Returns true when the binding actually changed
+    bool bind(unsigned int unit = 0) const {
+        return CMentalGLState::bindTexture(unit, textureID_);
     }
     
-    void unbind() const {
-        glBindTexture(GL_TEXTURE_2D, 0);
+    void unbind(unsigned int unit = 0) const {
+        CMentalGLState::bindTexture(unit, 0);
     }
     
     [[nodiscard]] GLuint getID() const { return textureID_; }
     [[nodiscard]] bool isValid() const { return textureID_ != 0; }
     [[nodiscard]] int getWidth() const { return width_; }
     [[nodiscard]] int getHeight() const { return height_; }
+    [[nodiscard]] int64_t getGpuBytes() const { return gpuBytes_; }
+    [[nodiscard]] bool isStreaming() const { return source_ != nullptr; }
+    [[nodiscard]] int getLevelCount() const { return levelCount_; }
+    [[nodiscard]] int getResidentLevel() const { return residentLevel_; }
+    [[nodiscard]] int getFloorLevel() const { return floorLevel_; }
+    [[nodiscard]] const CMentalTextureParams& getParams() const { return params_; }
+
+    // Set by the file loaders; textures uploaded from a chain get it from whoever decoded it
+    void setSourcePath(std::string path) { sourcePath_ = std::move(path); }
+    [[nodiscard]] const std::string& getSourcePath() const { return sourcePath_; }
 };
 
 } // mentalsdk
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Texture.hpp"
+#include "../Renderer/GLState.hpp"
+#include "../Renderer/GLRelease.hpp"
+#include "../Renderer/MipBuilder.hpp"
+#include "../Utils/SkylinePacker.hpp"
+#include "../Utils/Stats.hpp"
+
+namespace mentalsdk
+{
+
+const int TEXTURE_ATLAS_PAGE_SIZE = 1024;
+const int TEXTURE_ATLAS_LAYERS = 8;
+const int TEXTURE_ATLAS_LEVELS = 3;
+const int TEXTURE_ATLAS_GUTTER = 1 << (TEXTURE_ATLAS_LEVELS - 1); // Leaves a texel of replicated edge on the last level
+const int TEXTURE_ATLAS_MAX_SIZE = 256; // Larger images gain little from sharing and stay separate textures
+
+// Shaders sampling an atlas read the region with `layout (location = 7) in vec4 aInstanceAtlas;`
+// (xy offset, zw scale) and `layout (location = 8) in float aInstanceLayer;`, and sample a
+// sampler2DArray at vec3(fract(uv) * aInstanceAtlas.zw + aInstanceAtlas.xy, aInstanceLayer)
+const GLuint INSTANCE_ATLAS_LOCATION = 7;
+const GLuint INSTANCE_LAYER_LOCATION = 8;
+
+// Where a packed image lives, in the layout the batch renderer streams per instance
+struct CMentalAtlasRegion {
+    glm::vec4 rect{ 0.0F, 0.0F, 1.0F, 1.0F };
+    float layer = -1.0F;
+
+    [[nodiscard]] bool isValid() const { return layer >= 0.0F; }
+};
+
+// Packs small RGBA8 images into the layers of one GL_TEXTURE_2D_ARRAY, so objects with
+// different images keep one texture binding and batch together. Each image is placed by a
+// skyline packer with a replicated gutter and aligned so its first TEXTURE_ATLAS_LEVELS mips
+// stay inside it; wrapping is done in the shader with fract(). GL thread only.
+class CMentalTextureAtlas
+{
+private:
+    GLuint textureID_ = 0;
+    GLenum internalFormat_ = GL_RGBA8;
+    int pageSize_ = TEXTURE_ATLAS_PAGE_SIZE;
+    int capacity_ = TEXTURE_ATLAS_LAYERS;
+    std::vector<CMentalSkylinePacker> pages_; // One per layer in use
+    std::vector<uint8_t> scratch_;
+    size_t regionCount_ = 0;
+    int64_t gpuBytes_ = 0;
+
+    static int alignUp(int value) {
+        return (value + TEXTURE_ATLAS_GUTTER - 1) / TEXTURE_ATLAS_GUTTER * TEXTURE_ATLAS_GUTTER;
+    }
+
+    // Places one level with its edge texels repeated into the gutter
+    void uploadLevel(const CMentalMipLevel& level, int gutter, int x, int y, int width, int height, int layer, int mip) {
+        scratch_.resize(static_cast<size_t>(width) * static_cast<size_t>(height) * 4);
+        for (int row = 0; row < height; ++row) {
+            const int sourceRow = std::clamp(row - gutter, 0, level.height - 1);
+            const uint8_t* source = level.pixels.data() + static_cast<size_t>(sourceRow) * static_cast<size_t>(level.width) * 4;
+            uint8_t* target = scratch_.data() + static_cast<size_t>(row) * static_cast<size_t>(width) * 4;
+            for (int column = 0; column < width; ++column) {
+                const int sourceColumn = std::clamp(column - gutter, 0, level.width - 1);
+                std::memcpy(target + static_cast<size_t>(column) * 4, source + static_cast<size_t>(sourceColumn) * 4, 4);
+            }
+        }
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, mip, x, y, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, scratch_.data());
+    }
+
+public:
+    CMentalTextureAtlas() = default;
+    ~CMentalTextureAtlas() {
+        if (textureID_ != 0) {
+            CMentalGLReleaseQueue::instance().defer([texture = textureID_]() {
+                CMentalGLState::onTextureDeleted(texture);
+                glDeleteTextures(1, &texture);
+            });
+            textureID_ = 0;
+        }
+        this->destroy();
+    }
+
+    CMentalTextureAtlas(const CMentalTextureAtlas&) = delete;
+    CMentalTextureAtlas& operator=(const CMentalTextureAtlas&) = delete;
+    CMentalTextureAtlas(CMentalTextureAtlas&&) = delete;
+    CMentalTextureAtlas& operator=(CMentalTextureAtlas&&) = delete;
+
+    // Storage for every layer is allocated up front: 4/3 * pageSize^2 * 4 bytes per layer
+    bool create(bool srgb = false, int pageSize = TEXTURE_ATLAS_PAGE_SIZE, int layers = TEXTURE_ATLAS_LAYERS) {
+        this->destroy();
+        GLint maxLayers = 0;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+        if (pageSize < TEXTURE_ATLAS_GUTTER * 4 || layers <= 0 || layers > maxLayers) {
+            std::cerr << "Error: Unsupported texture atlas size " << pageSize << " x " << layers << " layers\n";
+            return false;
+        }
+        internalFormat_ = srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+        pageSize_ = alignUp(pageSize);
+        capacity_ = layers;
+
+        glGenTextures(1, &textureID_);
+        CMentalGLState::bindTexture(0, textureID_, GL_TEXTURE_2D_ARRAY);
+        int64_t bytes = 0;
+        for (int mip = 0; mip < TEXTURE_ATLAS_LEVELS; ++mip) {
+            const int size = pageSize_ >> mip;
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, mip, static_cast<GLint>(internalFormat_), size, size, layers, 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            bytes += static_cast<int64_t>(size) * size * layers * 4;
+        }
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, TEXTURE_ATLAS_LEVELS - 1);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        CMentalGLState::bindTexture(0, 0, GL_TEXTURE_2D_ARRAY);
+
+        CMentalStats::instance().addGpuMemory(MentalGpuResource::TextureMemory, bytes);
+        gpuBytes_ = bytes;
+        return true;
+    }
+
+    void destroy() {
+        if (textureID_ != 0) {
+            CMentalGLState::onTextureDeleted(textureID_);
+            glDeleteTextures(1, &textureID_);
+            textureID_ = 0;
+        }
+        CMentalStats::instance().addGpuMemory(MentalGpuResource::TextureMemory, -gpuBytes_);
+        gpuBytes_ = 0;
+        pages_.clear();
+        regionCount_ = 0;
+    }
+
+    // Images from 4 to TEXTURE_ATLAS_MAX_SIZE texels a side with a full mip chain
+    [[nodiscard]] static bool canPack(const CMentalMipChain& chain) {
+        if (chain.levels.size() < static_cast<size_t>(TEXTURE_ATLAS_LEVELS)) {
+            return false;
+        }
+        const CMentalMipLevel& base = chain.levels.front();
+        return base.width >= TEXTURE_ATLAS_GUTTER && base.height >= TEXTURE_ATLAS_GUTTER &&
+               base.width <= TEXTURE_ATLAS_MAX_SIZE && base.height <= TEXTURE_ATLAS_MAX_SIZE;
+    }
+
+    // Returns an invalid region when the image cannot be packed or every layer is full;
+    // callers then keep it as a texture of its own
+    CMentalAtlasRegion add(const CMentalMipChain& chain) {
+        if (textureID_ == 0 || !canPack(chain)) {
+            return CMentalAtlasRegion{};
+        }
+        const CMentalMipLevel& base = chain.levels.front();
+        const int width = alignUp(base.width + TEXTURE_ATLAS_GUTTER * 2);
+        const int height = alignUp(base.height + TEXTURE_ATLAS_GUTTER * 2);
+
+        int x = 0;
+        int y = 0;
+        int layer = 0;
+        while (layer < static_cast<int>(pages_.size()) && !pages_[static_cast<size_t>(layer)].pack(width, height, x, y)) {
+            ++layer;
+        }
+        if (layer == static_cast<int>(pages_.size())) {
+            if (layer == capacity_) {
+                return CMentalAtlasRegion{};
+            }
+            pages_.emplace_back(pageSize_, pageSize_);
+            if (!pages_.back().pack(width, height, x, y)) {
+                pages_.pop_back();
+                return CMentalAtlasRegion{};
+            }
+        }
+
+        // Positions and sizes are gutter multiples, so each mip lands exactly at (x, y) >> mip
+        CMentalGLState::bindTexture(0, textureID_, GL_TEXTURE_2D_ARRAY);
+        for (int mip = 0; mip < TEXTURE_ATLAS_LEVELS; ++mip) {
+            this->uploadLevel(chain.levels[static_cast<size_t>(mip)], TEXTURE_ATLAS_GUTTER >> mip,
+                              x >> mip, y >> mip, width >> mip, height >> mip, layer, mip);
+        }
+        CMentalGLState::bindTexture(0, 0, GL_TEXTURE_2D_ARRAY);
+        ++regionCount_;
+
+        const auto page = static_cast<float>(pageSize_);
+        CMentalAtlasRegion region;
+        region.rect = glm::vec4(static_cast<float>(x + TEXTURE_ATLAS_GUTTER) / page, static_cast<float>(y + TEXTURE_ATLAS_GUTTER) / page,
+                                static_cast<float>(base.width) / page, static_cast<float>(base.height) / page);
+        region.layer = static_cast<float>(layer);
+        return region;
+    }
+
+    // Decodes and builds mips on the calling thread, in the atlas' color space
+    CMentalAtlasRegion addFile(const std::string& filePath, MentalMipFilter filter = Box) {
+        CMentalTextureParams params;
+        params.srgb = internalFormat_ == GL_SRGB8_ALPHA8;
+        params.mipFilter = filter;
+        CMentalMipChain chain;
+        if (!CMentalTexture::decodeFile(filePath, params, chain)) {
+            return CMentalAtlasRegion{};
+        }
+        return this->add(chain);
+    }
+
+    // Returns true when the binding actually changed
+    bool bind(unsigned int unit = 0) const {
+        return CMentalGLState::bindTexture(unit, textureID_, GL_TEXTURE_2D_ARRAY);
+    }
+
+    [[nodiscard]] GLuint getID() const { return textureID_; }
+    [[nodiscard]] bool isValid() const { return textureID_ != 0; }
+    [[nodiscard]] int getPageSize() const { return pageSize_; }
+    [[nodiscard]] int getCapacity() const { return capacity_; }
+    [[nodiscard]] int getLayerCount() const { return static_cast<int>(pages_.size()); }
+    [[nodiscard]] size_t getRegionCount() const { return regionCount_; }
+    [[nodiscard]] int64_t getGpuBytes() const { return gpuBytes_; }
+    [[nodiscard]] float getOccupancy(int layer) const {
+        return layer >= 0 && layer < static_cast<int>(pages_.size()) ? pages_[static_cast<size_t>(layer)].getOccupancy() : 0.0F;
+    }
+};
+
+} // mentalsdk
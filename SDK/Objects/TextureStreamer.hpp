@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Texture.hpp"
+
+namespace mentalsdk
+{
+
+const int64_t DEFAULT_TEXTURE_STREAMING_BUDGET = 256LL * 1024 * 1024;
+const int64_t DEFAULT_TEXTURE_UPLOAD_BYTES = 16LL * 1024 * 1024; // Per frame, bounds the upload hitch
+const int TEXTURE_STREAMING_MAX_BIAS = 16;
+const int TEXTURE_STREAMING_HYSTERESIS = 1; // Extra resident levels kept while there is room
+
+// Global mip residency for streaming textures. Culling requests a level per visible texture
+// every frame; update() fits those requests into the VRAM budget by coarsening every visible
+// texture by the same bias, drops what is no longer wanted at once and uploads missing
+// levels one per texture per frame, furthest behind first. GL thread only.
+class CMentalTextureStreamer
+{
+private:
+    struct Candidate {
+        std::shared_ptr<CMentalTexture> texture;
+        int requested = TEXTURE_LEVEL_NOT_REQUESTED;
+        int wanted = 0;
+    };
+
+    std::vector<std::weak_ptr<CMentalTexture>> textures_;
+    std::vector<Candidate> candidates_;
+    int64_t budget_ = DEFAULT_TEXTURE_STREAMING_BUDGET;
+    int64_t uploadBytes_ = DEFAULT_TEXTURE_UPLOAD_BYTES;
+    int64_t residentBytes_ = 0;
+    int bias_ = 0;
+
+    [[nodiscard]] int64_t wantedBytes() const {
+        int64_t bytes = 0;
+        for (const Candidate& candidate : candidates_) {
+            bytes += candidate.texture->getBytesFrom(candidate.wanted);
+        }
+        return bytes;
+    }
+
+    void collect() {
+        candidates_.clear();
+        for (size_t index = 0; index < textures_.size();) {
+            std::shared_ptr<CMentalTexture> texture = textures_[index].lock();
+            if (!texture || !texture->isStreaming()) {
+                textures_[index] = std::move(textures_.back());
+                textures_.pop_back();
+                continue;
+            }
+            const int requested = texture->takeRequestedLevel();
+            candidates_.push_back({ std::move(texture), requested, 0 });
+            ++index;
+        }
+    }
+
+public:
+    CMentalTextureStreamer() = default;
+    ~CMentalTextureStreamer() = default;
+
+    CMentalTextureStreamer(const CMentalTextureStreamer&) = delete;
+    CMentalTextureStreamer& operator=(const CMentalTextureStreamer&) = delete;
+    CMentalTextureStreamer(CMentalTextureStreamer&&) = delete;
+    CMentalTextureStreamer& operator=(CMentalTextureStreamer&&) = delete;
+
+    void track(const std::shared_ptr<CMentalTexture>& texture) {
+        if (texture && texture->isStreaming()) {
+            textures_.push_back(texture);
+        }
+    }
+
+    // Call once per frame on the GL thread after the frame's culling requested levels
+    void update() {
+        this->collect();
+
+        // Visible textures want what culling asked for, the rest keep what they have
+        for (Candidate& candidate : candidates_) {
+            const CMentalTexture& texture = *candidate.texture;
+            candidate.wanted = candidate.requested == TEXTURE_LEVEL_NOT_REQUESTED
+                                   ? texture.getResidentLevel()
+                                   : std::clamp(candidate.requested, 0, texture.getFloorLevel());
+        }
+        bool pressure = this->wantedBytes() > budget_;
+        if (pressure) {
+            for (Candidate& candidate : candidates_) {
+                if (candidate.requested == TEXTURE_LEVEL_NOT_REQUESTED) {
+                    candidate.wanted = candidate.texture->getFloorLevel();
+                }
+            }
+        }
+        bias_ = 0;
+        while (this->wantedBytes() > budget_ && bias_ < TEXTURE_STREAMING_MAX_BIAS) {
+            ++bias_;
+            for (Candidate& candidate : candidates_) {
+                if (candidate.requested != TEXTURE_LEVEL_NOT_REQUESTED) {
+                    candidate.wanted = std::clamp(candidate.requested + bias_, 0, candidate.texture->getFloorLevel());
+                }
+            }
+        }
+        pressure = pressure || bias_ > 0;
+
+        // Dropping frees memory at once; without pressure a level of slack avoids thrashing
+        const int slack = pressure ? 0 : TEXTURE_STREAMING_HYSTERESIS;
+        for (Candidate& candidate : candidates_) {
+            if (candidate.texture->getResidentLevel() < candidate.wanted - slack) {
+                candidate.texture->evict(candidate.wanted - slack);
+            }
+        }
+
+        std::sort(candidates_.begin(), candidates_.end(), [](const Candidate& lhs, const Candidate& rhs) {
+            return lhs.texture->getResidentLevel() - lhs.wanted > rhs.texture->getResidentLevel() - rhs.wanted;
+        });
+        int64_t uploaded = 0;
+        for (Candidate& candidate : candidates_) {
+            CMentalTexture& texture = *candidate.texture;
+            const int next = texture.getResidentLevel() - 1;
+            if (next < candidate.wanted) {
+                break; // Sorted, nobody after this one is missing levels
+            }
+            const int64_t bytes = texture.getBytesFrom(next) - texture.getBytesFrom(next + 1);
+            if (uploaded > 0 && uploaded + bytes > uploadBytes_) {
+                break;
+            }
+            texture.makeResident(next);
+            uploaded += bytes;
+        }
+
+        residentBytes_ = 0;
+        for (const Candidate& candidate : candidates_) {
+            residentBytes_ += candidate.texture->getGpuBytes();
+        }
+        candidates_.clear(); // Holds no references between frames
+    }
+
+    void setBudget(int64_t budget) { budget_ = budget; }
+    void setUploadBytesPerFrame(int64_t bytes) { uploadBytes_ = bytes; }
+
+    [[nodiscard]] int64_t getBudget() const { return budget_; }
+    [[nodiscard]] int64_t getUploadBytesPerFrame() const { return uploadBytes_; }
+    [[nodiscard]] int64_t getResidentBytes() const { return residentBytes_; }
+    [[nodiscard]] size_t getTrackedCount() const { return textures_.size(); }
+    [[nodiscard]] int getBias() const { return bias_; }
+};
+
+} // mentalsdk
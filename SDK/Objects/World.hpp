@@ -1,20 +1,150 @@
 #pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "Objects/Object.hpp"
 #include "Environment.hpp"
+#include "BVH.hpp"
+#include "SpatialHash.hpp"
+#include "../Utils/JobSystem.hpp"
+#include "../Renderer/FramePacket.hpp"
+#include "../Renderer/BatchRenderer.hpp"
+#include "TextureStreamer.hpp"
+#include "../Utils/Profiler.hpp"
+#include "../Utils/Stats.hpp"
 
 namespace mentalsdk
 {
 
+const auto SHADER_RELOAD_INTERVAL = std::chrono::milliseconds(250); // Edited shader files are picked up this often
 
 class CMentalWorld
 {
 private:
     std::shared_ptr<std::map<std::string, std::shared_ptr<CMentalObject>>> hierarchy_ = std::make_shared<std::map<std::string, std::shared_ptr<CMentalObject>>>();
     std::shared_ptr<CMentalEnvironment> environment_ = nullptr;
+    std::mutex nodeMutex_;
+    std::vector<std::pair<std::string, std::shared_ptr<CMentalObject>>> pendingNodes_; // Null removes, applied at the frame boundary
+
+    CMentalBVH staticBVH_;
+    CMentalSpatialHash dynamicIndex_;
+    bool spatialDirty_ = true; // Set when the object set changes, forces a rebuild of both indices
+    std::vector<std::shared_ptr<CMentalObject>> dynamicObjects_;
+    std::vector<CMentalObject*> sceneObjects_;
+    std::vector<CMentalObject*> visibleObjects_;
+    std::vector<std::vector<CMentalObject*>> visibleChunks_;
+    std::vector<CMentalShader*> reloadShaders_;
+    std::unordered_set<const CMentalObject*> visited_; // Rebuild scratch
+    std::vector<std::shared_ptr<CMentalObject>> pending_;
+    CMentalFramePacket framePacket_; // Used by render() when simulating and submitting on one thread
+    uint64_t frameIndex_ = 0;
+    uint64_t syncedFrame_ = UINT64_MAX;
+    std::chrono::steady_clock::time_point lastReloadCheck_;
+
+    std::shared_ptr<CMentalJobSystem> jobSystem_ = nullptr;
+    std::shared_ptr<CMentalBatchRenderer> batchRenderer_ = nullptr;
+    std::shared_ptr<CMentalTextureStreamer> textureStreamer_ = nullptr;
+    float viewportHeight_ = 600.0F; // Pixels, for the screen size of streaming textures
+
+    // Runs function(begin, end) over [0, count) on the job system, or inline without one
+    template <typename Function>
+    void parallelFor(size_t count, Function&& function) {
+        if (jobSystem_) {
+            jobSystem_->parallelFor(count, DEFAULT_JOB_GRAIN_SIZE, std::forward<Function>(function));
+        } else if (count > 0) {
+            function(size_t{ 0 }, count);
+        }
+    }
+
+    // Finest mip a streaming texture needs: one texel per pixel across the object's projected size
+    void requestTextureLevel(const CMentalObject& object, const glm::mat4& view, const glm::mat4& projection) const {
+        const CMentalTexture* texture = object.getTexture();
+        if (texture == nullptr || !texture->isStreaming()) {
+            return;
+        }
+        const AABB bounds = object.getWorldBounds();
+        const float depth = -(view * glm::vec4(bounds.getCenter(), 1.0F)).z;
+        const float radius = glm::length(bounds.getExtent()) * 0.5F;
+        const float pixels = radius * projection[1][1] * viewportHeight_ / std::max(depth - radius, 1e-3F);
+        const float texels = static_cast<float>(std::max(texture->getWidth(), texture->getHeight()));
+        texture->requestLevel(pixels >= texels ? 0 : static_cast<int>(std::log2(texels / std::max(pixels, 1.0F))));
+    }
+
+    // Children linked with setNext belong to the world as much as the nodes themselves; each
+    // object is taken once however many ways it is reached, so links may even form cycles
+    void rebuildSpatialIndices() {
+        std::vector<std::shared_ptr<CMentalObject>> staticObjects;
+        this->dynamicObjects_.clear();
+        this->sceneObjects_.clear();
+        this->dynamicIndex_.clear();
+        this->visited_.clear();
+        this->pending_.clear();
+        for (const auto& [name, object] : *hierarchy_) {
+            this->pending_.push_back(object);
+        }
+        while (!this->pending_.empty()) {
+            const std::shared_ptr<CMentalObject> object = std::move(this->pending_.back());
+            this->pending_.pop_back();
+            if (!object || !this->visited_.insert(object.get()).second) {
+                continue;
+            }
+            this->pending_.insert(this->pending_.end(), object->getNext().begin(), object->getNext().end());
+            this->sceneObjects_.push_back(object.get());
+            if (object->isStatic()) {
+                staticObjects.push_back(object);
+            } else {
+                this->dynamicObjects_.push_back(object);
+                this->dynamicIndex_.update(object.get(), object->getPosition());
+            }
+            if (CMentalScript* script = object->getScript()) {
+                script->bindSpatialIndex(&this->dynamicIndex_, object.get());
+            }
+        }
+        this->staticBVH_.build(std::move(staticObjects));
+        this->spatialDirty_ = false;
+    }
+
+    // Sums the per-object script cost by file for the stats overlay
+    void publishScriptTimes() const {
+        std::map<std::string, CMentalScriptTime> byFile;
+        for (const CMentalObject* object : sceneObjects_) {
+            const CMentalScript* script = object->getScript();
+            if (script == nullptr || !script->hasScript()) {
+                continue;
+            }
+            CMentalScriptTime& entry = byFile[script->getScriptFile()];
+            entry.objects += 1;
+            entry.milliseconds += static_cast<double>(object->getScriptTimeNs()) / 1e6;
+        }
+        std::vector<CMentalScriptTime> times;
+        times.reserve(byFile.size());
+        for (auto& [file, entry] : byFile) {
+            entry.file = file;
+            times.push_back(std::move(entry));
+        }
+        CMentalStats::instance().setScriptTimes(std::move(times));
+    }
+
+    void updateSpatialIndices() {
+        if (spatialDirty_) {
+            this->rebuildSpatialIndices();
+            return;
+        }
+        this->staticBVH_.refit();
+        for (const auto& object : this->dynamicObjects_) {
+            this->dynamicIndex_.update(object.get(), object->getPosition());
+        }
+    }
+
 public:
     CMentalWorld() = default;
     ~CMentalWorld() = default;
@@ -26,20 +156,153 @@ public:
 
 
     [[nodiscard]] std::shared_ptr<std::map<std::string, std::shared_ptr<CMentalObject>>> getHierarchy() const { return this->hierarchy_; }
-    void setNode(const std::string& name, const std::shared_ptr<CMentalObject>& object) {  if (hierarchy_) { (*hierarchy_)[name] = object; } }
-    std::shared_ptr<CMentalObject> getNode(const std::string& name) { return hierarchy_ ? (*hierarchy_)[name] : nullptr; }
+
+    // Inserts and removes are queued from any thread and take effect at the next frame
+    // boundary (synchronize(), or simulate() without a frame sync stage), never mid-frame.
+    // getHierarchy() shows the applied state, getNode() the queued one too
+    void setNode(const std::string& name, const std::shared_ptr<CMentalObject>& object) {
+        if (object) {
+            std::lock_guard<std::mutex> lock(nodeMutex_);
+            this->pendingNodes_.emplace_back(name, object);
+        }
+    }
+    void removeNode(const std::string& name) {
+        std::lock_guard<std::mutex> lock(nodeMutex_);
+        this->pendingNodes_.emplace_back(name, nullptr);
+    }
+    std::shared_ptr<CMentalObject> getNode(const std::string& name) {
+        {
+            std::lock_guard<std::mutex> lock(nodeMutex_);
+            for (auto change = this->pendingNodes_.rbegin(); change != this->pendingNodes_.rend(); ++change) {
+                if (change->first == name) {
+                    return change->second;
+                }
+            }
+        }
+        const auto found = hierarchy_->find(name);
+        return found != hierarchy_->end() ? found->second : nullptr;
+    }
+
+    // Applies the queued node changes; synchronize() and simulate() do this at the frame
+    // boundary, code without a frame loop calls it directly. Removed objects stay alive until
+    // the next index rebuild and the packets still drawing them let go
+    void applyNodeChanges() {
+        std::vector<std::pair<std::string, std::shared_ptr<CMentalObject>>> changes;
+        {
+            std::lock_guard<std::mutex> lock(nodeMutex_);
+            changes.swap(this->pendingNodes_);
+        }
+        for (auto& [name, object] : changes) {
+            if (object) {
+                (*hierarchy_)[name] = std::move(object);
+            } else {
+                hierarchy_->erase(name);
+            }
+        }
+        if (!changes.empty()) {
+            this->spatialDirty_ = true;
+        }
+    }
+
+    // Call after toggling CMentalObject::setStatic or connecting scripts on objects already in the world
+    void invalidateSpatialIndices() { spatialDirty_ = true; }
+    [[nodiscard]] const CMentalBVH& getStaticBVH() const { return staticBVH_; }
+    [[nodiscard]] CMentalSpatialHash& getDynamicIndex() { return dynamicIndex_; }
+
+    // Proximity queries over dynamic objects, positions are as of the last render()
+    void queryRadius(const glm::vec3& center, float radius, std::vector<CMentalObject*>& result) const {
+        this->dynamicIndex_.querySphere(center, radius, result);
+    }
+    void queryBox(const AABB& box, std::vector<CMentalObject*>& result) const {
+        this->dynamicIndex_.queryBox(box, result);
+    }
+    // Pass the asking object as exclude, or it comes back as its own nearest neighbour
+    void queryNearest(const glm::vec3& point, size_t count, std::vector<CMentalObject*>& result,
+                      const CMentalObject* exclude = nullptr) const {
+        this->dynamicIndex_.queryNearest(point, count, result, exclude);
+    }
+
+    // Picking query over static (BVH) and dynamic (linear) objects
+    CMentalRayHit raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance = 1000.0F) {
+        this->updateSpatialIndices();
+
+        const Ray ray{ origin, direction };
+        CMentalRayHit hit = this->staticBVH_.raycast(ray, maxDistance);
+        const glm::vec3 inverseDirection = 1.0F / direction;
+        for (const auto& object : this->dynamicObjects_) {
+            const float limit = hit.hasHit() ? hit.distance : maxDistance;
+            if (ray.intersect(object->getWorldBounds(), inverseDirection, limit) < 0.0F) {
+                continue;
+            }
+            const float distance = object->intersectRay(ray);
+            if (distance >= 0.0F && distance < limit) {
+                hit.object = object;
+                hit.distance = distance;
+            }
+        }
+        return hit;
+    }
     
+    // Without a job system every frame stage runs on the calling thread
+    void setJobSystem(const std::shared_ptr<CMentalJobSystem>& jobSystem) { jobSystem_ = jobSystem; }
+    [[nodiscard]] std::shared_ptr<CMentalJobSystem> getJobSystem() const { return jobSystem_; }
+
+    // With a batch renderer render() submits arena meshes in batches instead of one by one
+    void setBatchRenderer(const std::shared_ptr<CMentalBatchRenderer>& batchRenderer) { batchRenderer_ = batchRenderer; }
+    [[nodiscard]] std::shared_ptr<CMentalBatchRenderer> getBatchRenderer() const { return batchRenderer_; }
+
+    // With a texture streamer culling requests mip levels and render() keeps them resident
+    void setTextureStreamer(const std::shared_ptr<CMentalTextureStreamer>& textureStreamer) { textureStreamer_ = textureStreamer; }
+    [[nodiscard]] std::shared_ptr<CMentalTextureStreamer> getTextureStreamer() const { return textureStreamer_; }
+    void setViewportHeight(float height) { viewportHeight_ = height; }
+
     void setEnvironment(const std::shared_ptr<CMentalEnvironment>& environment) { environment_ = environment; }
     std::shared_ptr<CMentalEnvironment> getEnvironment() const { return environment_; }
     
-    void render() {
-        // Render environment first (clear color, etc.)
+    // Frame sync stage: GL thread, at the frame boundary (see CMentalRenderer::setFrameSync).
+    // Applies queued inserts and removes and reloads edited shaders here, so neither the
+    // object set nor a program changes while a frame is recorded or drawn. Runs once per
+    // frame however often it is called; streaming and asset finalizing go before it
+    void synchronize() {
+        if (this->syncedFrame_ == this->frameIndex_) {
+            return;
+        }
+        this->syncedFrame_ = this->frameIndex_;
+        MENTAL_PROFILE_SCOPE("World Sync");
+        this->applyNodeChanges();
+        const auto now = std::chrono::steady_clock::now();
+        if (now - this->lastReloadCheck_ < SHADER_RELOAD_INTERVAL) {
+            return;
+        }
+        this->lastReloadCheck_ = now;
+
+        if (spatialDirty_) {
+            this->rebuildSpatialIndices();
+        }
+        this->reloadShaders_.clear();
+        for (CMentalObject* object : sceneObjects_) {
+            CMentalShader* shader = object->getShader();
+            if (shader != nullptr && (this->reloadShaders_.empty() || this->reloadShaders_.back() != shader)) {
+                this->reloadShaders_.push_back(shader);
+            }
+        }
+        std::sort(this->reloadShaders_.begin(), this->reloadShaders_.end());
+        this->reloadShaders_.erase(std::unique(this->reloadShaders_.begin(), this->reloadShaders_.end()), this->reloadShaders_.end());
+        for (CMentalShader* shader : this->reloadShaders_) {
+            shader->checkAndReload();
+        }
+    }
+
+    // Runs every CPU stage of the frame and records the result, touches no GL state
+    void simulate(CMentalFramePacket& packet) {
+        MENTAL_PROFILE_SCOPE("Simulate");
+        packet.frameIndex = frameIndex_++;
+        packet.clearEnabled = environment_ != nullptr;
         if (environment_) {
-            environment_->renderClearColor();
+            std::copy(environment_->getColor(), environment_->getColor() + 4, packet.clearColor);
         }
-        
+
         // Set up basic matrices (you'll want to make these configurable later)
-        glm::mat4 model = glm::mat4(1.0f);
         glm::mat4 view = glm::lookAt(
             glm::vec3(0.0f, 0.0f, 3.0f),   // Camera position
             glm::vec3(0.0f, 0.0f, 0.0f),   // Look at origin
@@ -52,12 +315,122 @@ public:
             100.0f                         // Far plane
         );
         
-        // Render all objects with proper matrices
-        for (const auto& [name, object]: *hierarchy_) {
-            if (object) { 
-                object->render(model, view, projection);
+        // Without a frame sync stage queued node changes land here. Rebuilding first binds
+        // spatial queries to newly added scripts before they run
+        if (this->syncedFrame_ != packet.frameIndex) {
+            this->applyNodeChanges();
+        }
+        if (spatialDirty_) {
+            this->rebuildSpatialIndices();
+        }
+
+        // Stage 1: scripts. Every script owns its Lua state, so objects update independently
+        this->parallelFor(sceneObjects_.size(), [this](size_t begin, size_t end) {
+            MENTAL_PROFILE_SCOPE("Scripts");
+            for (size_t index = begin; index < end; ++index) {
+                sceneObjects_[index]->update();
             }
+        });
+        if (CMentalStats::instance().isScriptTimingEnabled()) {
+            this->publishScriptTimes();
         }
+
+        // Stage 2: transform propagation into the per-object world cache
+        this->parallelFor(sceneObjects_.size(), [this](size_t begin, size_t end) {
+            MENTAL_PROFILE_SCOPE("Transforms");
+            for (size_t index = begin; index < end; ++index) {
+                sceneObjects_[index]->updateWorldTransform();
+            }
+        });
+
+        // Stage 3: culling. Index maintenance is serial, dynamic frustum tests are chunked
+        {
+            MENTAL_PROFILE_SCOPE("Spatial Update");
+            this->updateSpatialIndices();
+        }
+
+        const Frustum frustum = Frustum::fromMatrix(projection * view);
+        this->visibleObjects_.clear();
+
+        // With GPU culling arena meshes all go into the packet, the compute pass culls them
+        // from records it keeps resident; only the rest is tested here
+        const bool gpuCulling = batchRenderer_ != nullptr && batchRenderer_->isGpuCullingEnabled();
+        const size_t tested = gpuCulling ? sceneObjects_.size() : dynamicObjects_.size();
+        if (!gpuCulling) {
+            MENTAL_PROFILE_SCOPE("BVH Cull");
+            this->staticBVH_.cullFrustum(frustum, this->visibleObjects_);
+        }
+
+        const size_t chunkCount = (tested + DEFAULT_JOB_GRAIN_SIZE - 1) / DEFAULT_JOB_GRAIN_SIZE;
+        if (visibleChunks_.size() < chunkCount) {
+            visibleChunks_.resize(chunkCount);
+        }
+        this->parallelFor(tested, [this, &frustum, gpuCulling](size_t begin, size_t end) {
+            MENTAL_PROFILE_SCOPE("Dynamic Cull");
+            for (size_t chunkBegin = begin; chunkBegin < end; chunkBegin += DEFAULT_JOB_GRAIN_SIZE) {
+                auto& chunk = visibleChunks_[chunkBegin / DEFAULT_JOB_GRAIN_SIZE];
+                chunk.clear();
+                for (size_t index = chunkBegin; index < std::min(chunkBegin + DEFAULT_JOB_GRAIN_SIZE, end); ++index) {
+                    CMentalObject* object = gpuCulling ? sceneObjects_[index] : dynamicObjects_[index].get();
+                    if ((gpuCulling && object->getMeshAllocation().isValid()) ||
+                        frustum.classify(object->getWorldBounds()) != MentalCullResult::Outside) {
+                        chunk.push_back(object);
+                    }
+                }
+            }
+        });
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            this->visibleObjects_.insert(this->visibleObjects_.end(), visibleChunks_[chunk].begin(), visibleChunks_[chunk].end());
+        }
+        CMentalStats::instance().setCulling(visibleObjects_.size(), sceneObjects_.size() - visibleObjects_.size());
+
+        // Stage 4: command generation, sorted so program and texture switches are minimal
+        packet.view = view;
+        packet.projection = projection;
+        packet.frustumCulled = !gpuCulling;
+        packet.draws.clear(); // Last references to removed objects go here, on this thread
+        packet.draws.resize(this->visibleObjects_.size());
+        const bool streaming = textureStreamer_ != nullptr;
+        this->parallelFor(this->visibleObjects_.size(), [this, &packet, streaming](size_t begin, size_t end) {
+            MENTAL_PROFILE_SCOPE("Commands");
+            for (size_t index = begin; index < end; ++index) {
+                CMentalObject* object = visibleObjects_[index];
+                packet.draws[index] = CMentalDrawItem{ object->getSortKey(), object->shared_from_this(), object->getWorldMatrix(),
+                                                       object->getTransformVersion() };
+                if (streaming) {
+                    this->requestTextureLevel(*object, packet.view, packet.projection);
+                }
+            }
+        });
+        std::sort(packet.draws.begin(), packet.draws.end());
+    }
+
+    // GL submission of a recorded frame, must run on the thread that owns the context
+    static void submit(const CMentalFramePacket& packet, CMentalBatchRenderer* batchRenderer = nullptr,
+                       CMentalTextureStreamer* textureStreamer = nullptr) {
+        MENTAL_PROFILE_SCOPE("Submit");
+        if (textureStreamer != nullptr) {
+            MENTAL_PROFILE_SCOPE("Texture Streaming");
+            textureStreamer->update();
+        }
+        if (packet.clearEnabled) {
+            glClearColor(packet.clearColor[0], packet.clearColor[1], packet.clearColor[2], packet.clearColor[3]);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
+        if (batchRenderer != nullptr) {
+            batchRenderer->submit(packet);
+            return;
+        }
+        for (const auto& item : packet.draws) {
+            item.object->draw(item.model, packet.view, packet.projection);
+        }
+    }
+
+    // Everything on the calling thread, frame sync included
+    void render() {
+        this->synchronize();
+        this->simulate(this->framePacket_);
+        this->submit(this->framePacket_, this->batchRenderer_.get(), this->textureStreamer_.get());
     }
 };
 
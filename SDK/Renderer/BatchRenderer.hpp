@@ -0,0 +1,485 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "FramePacket.hpp"
+#include "GLState.hpp"
+#include "GpuCuller.hpp"
+#include "MeshArena.hpp"
+#include "StreamBuffer.hpp"
+#include "../Objects/Object.hpp"
+#include "../Utils/Profiler.hpp"
+#include "../Utils/Stats.hpp"
+
+namespace mentalsdk
+{
+
+// Shaders opt into batching with `layout (location = 3) in mat4 aInstanceModel;`, which
+// takes locations 3 to 6 and replaces the model uniform. Objects sampling a texture atlas
+// also get their region per instance, see INSTANCE_ATLAS_LOCATION
+const GLuint INSTANCE_MODEL_LOCATION = 3;
+const char* const INSTANCE_MODEL_ATTRIBUTE = "aInstanceModel";
+const size_t BATCH_INSTANCE_BUDGET = 65536; // Instances per frame, the rest is drawn one by one
+
+// Layout fixed by glMultiDrawElementsIndirect
+struct CMentalDrawElementsIndirectCommand {
+    GLuint count = 0;
+    GLuint instanceCount = 0;
+    GLuint firstIndex = 0;
+    GLint baseVertex = 0;
+    GLuint baseInstance = 0;
+};
+
+// Submits a frame packet in a handful of calls. Visible arena meshes that share a material
+// and a pool become one batch: their model matrices go into a per-frame instance stream,
+// and on GL 4.3 / ARB_multi_draw_indirect the whole batch is a single
+// glMultiDrawElementsIndirect. On 3.3 each run of identical meshes in a batch is one
+// glDrawElementsInstancedBaseVertex. Objects with different images in one texture atlas
+// share a material. Everything else goes through CMentalObject::draw. With GPU culling the
+// instances are resident object records instead, see CMentalGpuObjectTable.
+class CMentalBatchRenderer
+{
+private:
+    struct Batch {
+        const CMentalObject* material = nullptr; // First object, supplies program, texture and arena
+        size_t first = 0;                        // Range in batched_
+        size_t count = 0;
+        GLintptr matrices = 0;
+        GLintptr commands = 0;
+        GLintptr regions = 0;                    // Atlas regions, parallel to matrices
+    };
+
+    struct Single {
+        const CMentalDrawItem* item = nullptr;
+        bool instanced = false; // Shader reads aInstanceModel instead of the model uniform
+    };
+
+    bool multiDrawIndirect_ = false;
+    bool gpuCulling_ = false;
+    size_t instanceBudget_ = BATCH_INSTANCE_BUDGET;
+    CMentalStreamBuffer instances_;
+    CMentalStreamBuffer commands_;
+    CMentalStreamBuffer regions_; // Atlas regions of instances that sample a texture atlas
+    CMentalStreamBuffer slots_;   // GPU culling: the frame's instances as resident object slots
+    CMentalGpuObjectTable objects_;
+    CMentalGpuCuller culler_;
+    size_t frameInstances_ = 0;
+    CMentalStreamAllocation frameSlots_;
+    CMentalStreamAllocation frameCommands_;
+    std::vector<const CMentalDrawItem*> batched_;
+    std::vector<Single> singles_;
+    std::vector<Batch> batches_;
+    std::vector<GLuint> instancedVertexArrays_; // Pool VAOs whose instance attributes are enabled this frame
+
+    static bool acceptsInstances(const CMentalShader* shader) {
+        return shader != nullptr && shader->isValid() &&
+               glGetAttribLocation(shader->getProgramID(), INSTANCE_MODEL_ATTRIBUTE) == static_cast<GLint>(INSTANCE_MODEL_LOCATION);
+    }
+
+    static bool sameMesh(const CMentalMeshAllocation& first, const CMentalMeshAllocation& second) {
+        return first.vertices.offset == second.vertices.offset && first.indices.offset == second.indices.offset;
+    }
+
+    // Splits one material run into per-pool batches, identical meshes adjacent
+    void collectRun(const CMentalFramePacket& packet, size_t begin, size_t end) {
+        if (!acceptsInstances(packet.draws[begin].object->getShader())) {
+            for (size_t index = begin; index < end; ++index) {
+                singles_.push_back(Single{ &packet.draws[index], false });
+            }
+            return;
+        }
+
+        // Batches draw through one arena, objects in any other arena are drawn singly
+        const CMentalMeshArena* arena = nullptr;
+        const size_t runStart = batched_.size();
+        for (size_t index = begin; index < end; ++index) {
+            const CMentalDrawItem& item = packet.draws[index];
+            if (item.object->getMeshAllocation().isValid() && arena == nullptr) {
+                arena = item.object->getMeshArena().get();
+            }
+            if (item.object->getMeshAllocation().isValid() && item.object->getMeshArena().get() == arena) {
+                batched_.push_back(&item);
+            } else {
+                singles_.push_back(Single{ &item, true });
+            }
+        }
+        std::sort(batched_.begin() + static_cast<std::ptrdiff_t>(runStart), batched_.end(),
+                  [](const CMentalDrawItem* first, const CMentalDrawItem* second) {
+                      const CMentalMeshAllocation& a = first->object->getMeshAllocation();
+                      const CMentalMeshAllocation& b = second->object->getMeshAllocation();
+                      if (a.pool != b.pool) {
+                          return a.pool < b.pool;
+                      }
+                      return a.vertices.offset != b.vertices.offset ? a.vertices.offset < b.vertices.offset
+                                                                    : a.indices.offset < b.indices.offset;
+                  });
+
+        for (size_t index = runStart; index < batched_.size(); ++index) {
+            const uint32_t pool = batched_[index]->object->getMeshAllocation().pool;
+            if (index == runStart || batched_[index - 1]->object->getMeshAllocation().pool != pool) {
+                batches_.push_back(Batch{ batched_[index]->object.get(), index, 0, 0, 0, 0 });
+            }
+            ++batches_.back().count;
+        }
+    }
+
+    void drawBatchesSingly() {
+        for (Batch& batch : batches_) {
+            for (size_t index = 0; index < batch.count; ++index) {
+                singles_.push_back(Single{ batched_[batch.first + index], true });
+            }
+            batch.count = 0;
+        }
+    }
+
+    // Instances that fit the budget; batches past it are drawn singly
+    size_t fitBatches(size_t capacity) {
+        size_t total = 0;
+        for (Batch& batch : batches_) {
+            if (total + batch.count > capacity) {
+                for (size_t index = 0; index < batch.count; ++index) {
+                    singles_.push_back(Single{ batched_[batch.first + index], true });
+                }
+                batch.count = 0;
+            }
+            total += batch.count;
+        }
+        return total;
+    }
+
+    // GPU culling: the frame writes one slot index per instance and the culling pass builds
+    // the commands from the resident records. Objects that get no slot are drawn singly.
+    void writeResidentBatches() {
+        const size_t total = this->fitBatches(std::min(slots_.getRegionSize() / sizeof(GLuint), static_cast<size_t>(objects_.getCapacity())));
+        frameInstances_ = 0;
+        objects_.beginFrame();
+        const CMentalStreamAllocation slots = total > 0 ? slots_.allocate(total * sizeof(GLuint), sizeof(GLuint)) : CMentalStreamAllocation{};
+        const CMentalStreamAllocation commands =
+            total > 0 ? commands_.allocate(total * sizeof(CMentalDrawElementsIndirectCommand), sizeof(GLuint)) : CMentalStreamAllocation{};
+        if (total > 0 && (!slots.isValid() || !commands.isValid())) {
+            std::cerr << "Error: Batch streams are out of space, drawing " << total << " instances singly\n";
+            this->drawBatchesSingly();
+        }
+
+        auto* slotData = static_cast<GLuint*>(slots.data);
+        size_t written = 0;
+        for (Batch& batch : batches_) {
+            batch.commands = commands.offset + static_cast<GLintptr>(written * sizeof(CMentalDrawElementsIndirectCommand));
+            size_t kept = 0;
+            for (size_t index = 0; index < batch.count; ++index) {
+                const CMentalDrawItem* item = batched_[batch.first + index];
+                const uint32_t slot = objects_.acquire(*item);
+                if (slot == GPU_OBJECT_NO_SLOT) {
+                    singles_.push_back(Single{ item, true });
+                    continue;
+                }
+                batched_[batch.first + kept++] = item;
+                slotData[written++] = slot;
+            }
+            batch.count = kept;
+        }
+        objects_.upload();
+        frameInstances_ = written;
+        frameSlots_ = slots;
+        frameCommands_ = commands;
+    }
+
+    // Fills the instance, command and region streams with one allocation each
+    void writeBatches() {
+        const size_t total = this->fitBatches(instances_.getRegionSize() / sizeof(glm::mat4));
+        if (total == 0) {
+            return;
+        }
+        size_t atlased = 0;
+        for (const Batch& batch : batches_) {
+            atlased += batch.material->getAtlas() != nullptr ? batch.count : 0;
+        }
+
+        const CMentalStreamAllocation matrices = instances_.allocate(total * sizeof(glm::mat4), sizeof(glm::mat4));
+        CMentalStreamAllocation commands;
+        CMentalStreamAllocation regions;
+        if (atlased > 0) {
+            regions = regions_.allocate(atlased * sizeof(CMentalAtlasRegion), sizeof(glm::vec4));
+        }
+        if (multiDrawIndirect_) {
+            commands = commands_.allocate(total * sizeof(CMentalDrawElementsIndirectCommand), sizeof(GLuint));
+        }
+        if (!matrices.isValid() || (multiDrawIndirect_ && !commands.isValid()) || (atlased > 0 && !regions.isValid())) {
+            std::cerr << "Error: Batch streams are out of space, drawing " << total << " instances singly\n";
+            this->drawBatchesSingly();
+            return;
+        }
+
+        auto* matrixData = static_cast<glm::mat4*>(matrices.data);
+        auto* commandData = static_cast<CMentalDrawElementsIndirectCommand*>(commands.data);
+        auto* regionData = static_cast<CMentalAtlasRegion*>(regions.data);
+        size_t written = 0;
+        size_t regionsWritten = 0;
+        for (Batch& batch : batches_) {
+            batch.matrices = matrices.offset + static_cast<GLintptr>(written * sizeof(glm::mat4));
+            batch.commands = commands.offset + static_cast<GLintptr>(written * sizeof(CMentalDrawElementsIndirectCommand));
+            batch.regions = regions.offset + static_cast<GLintptr>(regionsWritten * sizeof(CMentalAtlasRegion));
+            const bool atlas = batch.material->getAtlas() != nullptr;
+            for (size_t index = 0; index < batch.count; ++index, ++written) {
+                const CMentalDrawItem& item = *batched_[batch.first + index];
+                matrixData[written] = item.model;
+                if (atlas) {
+                    regionData[regionsWritten++] = item.object->getAtlasRegion();
+                }
+                if (commandData != nullptr) {
+                    const CMentalMeshAllocation& mesh = item.object->getMeshAllocation();
+                    commandData[written] = CMentalDrawElementsIndirectCommand{ mesh.indexCount, 1, mesh.getFirstIndex(),
+                                                                               mesh.getBaseVertex(), static_cast<GLuint>(index) };
+                }
+            }
+        }
+    }
+
+    // Instance attributes live in the bound VAO, pointed at the given matrix
+    void pointInstances(GLuint vertexArray, GLuint buffer, GLintptr offset) {
+        if (std::find(instancedVertexArrays_.begin(), instancedVertexArrays_.end(), vertexArray) == instancedVertexArrays_.end()) {
+            instancedVertexArrays_.push_back(vertexArray);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        for (GLuint column = 0; column < 4; ++column) {
+            const GLuint location = INSTANCE_MODEL_LOCATION + column;
+            glEnableVertexAttribArray(location);
+            glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                                  reinterpret_cast<void*>(offset + static_cast<GLintptr>(column * sizeof(glm::vec4))));
+            glVertexAttribDivisor(location, 1);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // Atlas regions follow the same instance indexing as the matrices
+    static void pointRegions(GLuint buffer, GLintptr offset) {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glEnableVertexAttribArray(INSTANCE_ATLAS_LOCATION);
+        glVertexAttribPointer(INSTANCE_ATLAS_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(CMentalAtlasRegion),
+                              reinterpret_cast<void*>(offset + static_cast<GLintptr>(offsetof(CMentalAtlasRegion, rect))));
+        glVertexAttribDivisor(INSTANCE_ATLAS_LOCATION, 1);
+        glEnableVertexAttribArray(INSTANCE_LAYER_LOCATION);
+        glVertexAttribPointer(INSTANCE_LAYER_LOCATION, 1, GL_FLOAT, GL_FALSE, sizeof(CMentalAtlasRegion),
+                              reinterpret_cast<void*>(offset + static_cast<GLintptr>(offsetof(CMentalAtlasRegion, layer))));
+        glVertexAttribDivisor(INSTANCE_LAYER_LOCATION, 1);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void drawBatch(const Batch& batch, const glm::mat4& view, const glm::mat4& projection) {
+        CMentalStats& stats = CMentalStats::instance();
+        const std::shared_ptr<CMentalMeshArena>& arena = batch.material->getMeshArena();
+        const CMentalMeshAllocation& first = batch.material->getMeshAllocation();
+        uint64_t stateChanges = batch.material->bindMaterial(view, projection);
+        stateChanges += arena->bind(first) ? 1 : 0;
+        const GLuint vertexArray = arena->getVertexArray(first.pool);
+        const bool atlas = batch.material->getAtlas() != nullptr;
+
+        if (gpuCulling_) {
+            // Commands carry the slot as base instance, so attributes index the resident records
+            this->pointInstances(vertexArray, objects_.getTransformBuffer(), 0);
+            if (atlas) {
+                pointRegions(objects_.getRegionBuffer(), 0);
+            }
+        } else if (multiDrawIndirect_) {
+            this->pointInstances(vertexArray, instances_.getBuffer(), batch.matrices);
+            if (atlas) {
+                pointRegions(regions_.getBuffer(), batch.regions);
+            }
+        }
+        if (multiDrawIndirect_) {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commands_.getBuffer());
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<void*>(batch.commands),
+                                        static_cast<GLsizei>(batch.count), 0);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+            uint64_t triangles = 0;
+            for (size_t index = 0; index < batch.count; ++index) {
+                triangles += batched_[batch.first + index]->object->getMeshAllocation().indexCount / 3;
+            }
+            stats.addDrawCall(triangles);
+            stats.addStateChanges(stateChanges + 1);
+            return;
+        }
+
+        // No base instance before 4.2, so every run re-points the instance attributes
+        size_t runStart = 0;
+        while (runStart < batch.count) {
+            const CMentalMeshAllocation& mesh = batched_[batch.first + runStart]->object->getMeshAllocation();
+            size_t runEnd = runStart + 1;
+            while (runEnd < batch.count && sameMesh(batched_[batch.first + runEnd]->object->getMeshAllocation(), mesh)) {
+                ++runEnd;
+            }
+            this->pointInstances(vertexArray, instances_.getBuffer(), batch.matrices + static_cast<GLintptr>(runStart * sizeof(glm::mat4)));
+            if (atlas) {
+                pointRegions(regions_.getBuffer(), batch.regions + static_cast<GLintptr>(runStart * sizeof(CMentalAtlasRegion)));
+            }
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(mesh.indexCount), GL_UNSIGNED_INT,
+                                              reinterpret_cast<void*>(static_cast<uintptr_t>(mesh.getFirstIndex()) * sizeof(unsigned int)),
+                                              static_cast<GLsizei>(runEnd - runStart), mesh.getBaseVertex());
+            stats.addDrawCall(static_cast<uint64_t>(mesh.indexCount / 3) * (runEnd - runStart));
+            ++stateChanges;
+            runStart = runEnd;
+        }
+        stats.addStateChanges(stateChanges);
+    }
+
+    // Single draws with an instancing shader read the matrix from the generic attribute value
+    static void drawSingle(const Single& single, const glm::mat4& view, const glm::mat4& projection) {
+        const CMentalDrawItem& item = *single.item;
+        if (single.instanced) {
+            for (GLuint column = 0; column < 4; ++column) {
+                glVertexAttrib4fv(INSTANCE_MODEL_LOCATION + column, glm::value_ptr(item.model) + column * 4);
+            }
+        }
+        item.object->draw(item.model, view, projection);
+    }
+
+public:
+    CMentalBatchRenderer() = default;
+    ~CMentalBatchRenderer() = default; // destroy() must run on the GL thread
+
+    CMentalBatchRenderer(const CMentalBatchRenderer&) = delete;
+    CMentalBatchRenderer& operator=(const CMentalBatchRenderer&) = delete;
+    CMentalBatchRenderer(CMentalBatchRenderer&&) = delete;
+    CMentalBatchRenderer& operator=(CMentalBatchRenderer&&) = delete;
+
+    // GL thread, after the context and GLEW are up
+    bool initialize(size_t instanceBudget = BATCH_INSTANCE_BUDGET) {
+        instanceBudget_ = instanceBudget;
+        multiDrawIndirect_ = GLEW_VERSION_4_3 || (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance);
+        if (!instances_.create(instanceBudget * sizeof(glm::mat4), GL_ARRAY_BUFFER) ||
+            !regions_.create(instanceBudget * sizeof(CMentalAtlasRegion), GL_ARRAY_BUFFER)) {
+            return false;
+        }
+        if (multiDrawIndirect_ && !commands_.create(instanceBudget * sizeof(CMentalDrawElementsIndirectCommand), GL_DRAW_INDIRECT_BUFFER)) {
+            multiDrawIndirect_ = false;
+        }
+        std::cout << "Batch renderer: " << (multiDrawIndirect_ ? "multi-draw indirect" : "instanced fallback") << "\n";
+        return true;
+    }
+
+    void destroy() {
+        instances_.destroy();
+        regions_.destroy();
+        commands_.destroy();
+        slots_.destroy();
+        objects_.destroy();
+        culler_.destroy();
+        gpuCulling_ = false;
+    }
+
+    // Frustum and Hi-Z occlusion culling of batched instances in a compute pass. Needs the
+    // multi-draw indirect path; returns whether culling is on afterwards. While it is on the
+    // world leaves arena meshes unculled and the packet carries them all (frustumCulled is false).
+    bool setGpuCulling(bool enabled, bool occlusion = true) {
+        if (!enabled || !multiDrawIndirect_) {
+            gpuCulling_ = false;
+            objects_.destroy();
+            return false;
+        }
+        if (!culler_.isValid() && !culler_.initialize()) {
+            std::cerr << "Warning: GPU culling is not available on this context\n";
+            return false;
+        }
+        if (slots_.getBuffer() == 0 && !slots_.create(instanceBudget_ * sizeof(GLuint), GL_SHADER_STORAGE_BUFFER)) {
+            return false;
+        }
+        if (objects_.getCapacity() == 0 && !objects_.create(static_cast<uint32_t>(instanceBudget_))) {
+            return false;
+        }
+        culler_.setOcclusion(occlusion);
+        gpuCulling_ = true;
+        return true;
+    }
+
+    [[nodiscard]] bool isGpuCullingEnabled() const { return gpuCulling_; }
+
+    // GL thread; expects packet.draws sorted by material, as CMentalWorld::simulate leaves them
+    void submit(const CMentalFramePacket& packet) {
+        MENTAL_PROFILE_SCOPE("Batch Submit");
+        batched_.clear();
+        singles_.clear();
+        batches_.clear();
+        instancedVertexArrays_.clear();
+
+        size_t runBegin = 0;
+        for (size_t index = 1; index <= packet.draws.size(); ++index) {
+            if (index == packet.draws.size() || packet.draws[index].sortKey != packet.draws[runBegin].sortKey) {
+                this->collectRun(packet, runBegin, index);
+                runBegin = index;
+            }
+        }
+
+        instances_.beginFrame();
+        regions_.beginFrame();
+        if (multiDrawIndirect_) {
+            commands_.beginFrame();
+        }
+        if (gpuCulling_) {
+            slots_.beginFrame();
+            this->writeResidentBatches();
+        } else {
+            this->writeBatches();
+        }
+        instances_.flush();
+        regions_.flush();
+        if (multiDrawIndirect_) {
+            commands_.flush();
+        }
+        if (gpuCulling_) {
+            slots_.flush();
+            culler_.cull(objects_, slots_.getBuffer(), commands_.getBuffer(),
+                         static_cast<GLuint>(frameSlots_.offset / static_cast<GLintptr>(sizeof(GLuint))),
+                         static_cast<GLuint>(frameCommands_.offset / static_cast<GLintptr>(sizeof(GLuint))),
+                         static_cast<GLuint>(frameInstances_), packet.projection * packet.view);
+        }
+
+        for (const Batch& batch : batches_) {
+            if (batch.count > 0) {
+                this->drawBatch(batch, packet.view, packet.projection);
+            }
+        }
+        // Leave pool VAOs as single draws expect them
+        for (const GLuint vertexArray : instancedVertexArrays_) {
+            CMentalGLState::bindVertexArray(vertexArray);
+            for (GLuint column = 0; column < 4; ++column) {
+                glDisableVertexAttribArray(INSTANCE_MODEL_LOCATION + column);
+            }
+            glDisableVertexAttribArray(INSTANCE_ATLAS_LOCATION);
+            glDisableVertexAttribArray(INSTANCE_LAYER_LOCATION);
+        }
+        // Arena meshes the world left to the GPU but that ended up here still need a frustum test
+        const Frustum frustum = Frustum::fromMatrix(packet.projection * packet.view);
+        for (const Single& single : singles_) {
+            const CMentalObject& object = *single.item->object;
+            if (!packet.frustumCulled && object.getMeshAllocation().isValid() &&
+                frustum.classify(object.getLocalBounds().transformed(single.item->model)) == MentalCullResult::Outside) {
+                continue;
+            }
+            drawSingle(single, packet.view, packet.projection);
+        }
+
+        if (gpuCulling_ && culler_.isOcclusionEnabled()) {
+            culler_.buildPyramid();
+        }
+
+        instances_.endFrame();
+        regions_.endFrame();
+        if (multiDrawIndirect_) {
+            commands_.endFrame();
+        }
+        if (gpuCulling_) {
+            slots_.endFrame();
+        }
+    }
+
+    [[nodiscard]] bool usesMultiDrawIndirect() const { return multiDrawIndirect_; }
+};
+
+} // mentalsdk
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mentalsdk
+{
+
+enum MentalBlockFormat : uint8_t {
+    BC1 = 0, // RGB, 4 bits per pixel
+    BC3 = 1, // RGBA with interpolated alpha, 8 bits per pixel
+    BC5 = 2, // Two independent channels for normal maps, 8 bits per pixel
+};
+
+const int BLOCK_DIMENSION = 4;
+const size_t BLOCK_PIXELS = 16;
+
+// CPU encoder for the 4x4 block formats every desktop GL driver samples directly. Quality
+// is range fit along the principal axis, which is what offline cooking needs: fast enough
+// for whole mip chains and free of any dependency. Used by mental_texcook, not at runtime.
+class CMentalBlockCompressor
+{
+private:
+    using Block = std::array<std::array<uint8_t, 4>, BLOCK_PIXELS>;
+
+    static uint16_t packColor(const float color[3]) {
+        const auto quantize = [](float value, int maximum) {
+            return static_cast<uint16_t>(std::clamp(static_cast<int>(std::lround(value * maximum / 255.0F)), 0, maximum));
+        };
+        return static_cast<uint16_t>((quantize(color[0], 31) << 11) | (quantize(color[1], 63) << 5) | quantize(color[2], 31));
+    }
+
+    static void unpackColor(uint16_t packed, int color[3]) {
+        const int red = (packed >> 11) & 31;
+        const int green = (packed >> 5) & 63;
+        const int blue = packed & 31;
+        color[0] = (red << 3) | (red >> 2);
+        color[1] = (green << 2) | (green >> 4);
+        color[2] = (blue << 3) | (blue >> 2);
+    }
+
+    static void encodeColorBlock(const Block& block, uint8_t* output) {
+        float mean[3] = { 0.0F, 0.0F, 0.0F };
+        for (const auto& pixel : block) {
+            for (int channel = 0; channel < 3; ++channel) {
+                mean[channel] += pixel[channel] / static_cast<float>(BLOCK_PIXELS);
+            }
+        }
+        float covariance[6] = {}; // rr, rg, rb, gg, gb, bb
+        for (const auto& pixel : block) {
+            const float red = pixel[0] - mean[0];
+            const float green = pixel[1] - mean[1];
+            const float blue = pixel[2] - mean[2];
+            covariance[0] += red * red;
+            covariance[1] += red * green;
+            covariance[2] += red * blue;
+            covariance[3] += green * green;
+            covariance[4] += green * blue;
+            covariance[5] += blue * blue;
+        }
+
+        // Power iteration for the principal axis of the block's colors
+        float axis[3] = { 1.0F, 1.0F, 1.0F };
+        for (int iteration = 0; iteration < 8; ++iteration) {
+            const float next[3] = {
+                covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+                covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+                covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2],
+            };
+            const float length = std::max({ std::fabs(next[0]), std::fabs(next[1]), std::fabs(next[2]) });
+            if (length <= 0.0F) {
+                break;
+            }
+            for (int channel = 0; channel < 3; ++channel) {
+                axis[channel] = next[channel] / length;
+            }
+        }
+
+        float lowest = 0.0F;
+        float highest = 0.0F;
+        for (const auto& pixel : block) {
+            const float projection = (pixel[0] - mean[0]) * axis[0] + (pixel[1] - mean[1]) * axis[1] + (pixel[2] - mean[2]) * axis[2];
+            lowest = std::min(lowest, projection);
+            highest = std::max(highest, projection);
+        }
+        const float lengthSquared = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+        const float inset = (highest - lowest) / 16.0F; // Endpoints slightly inside the range lower the average error
+        float maximum[3];
+        float minimum[3];
+        for (int channel = 0; channel < 3; ++channel) {
+            maximum[channel] = mean[channel] + axis[channel] * (highest - inset) / lengthSquared;
+            minimum[channel] = mean[channel] + axis[channel] * (lowest + inset) / lengthSquared;
+        }
+
+        uint16_t color0 = packColor(maximum);
+        uint16_t color1 = packColor(minimum);
+        if (color0 < color1) {
+            std::swap(color0, color1);
+        }
+        uint32_t indices = 0;
+        if (color0 != color1) { // Equal endpoints select the three color mode, index 0 covers it
+            int palette[4][3];
+            unpackColor(color0, palette[0]);
+            unpackColor(color1, palette[1]);
+            for (int channel = 0; channel < 3; ++channel) {
+                palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+                palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+            }
+            for (size_t index = 0; index < BLOCK_PIXELS; ++index) {
+                uint32_t best = 0;
+                int bestError = 0x7FFFFFFF;
+                for (uint32_t entry = 0; entry < 4; ++entry) {
+                    int error = 0;
+                    for (int channel = 0; channel < 3; ++channel) {
+                        const int difference = block[index][channel] - palette[entry][channel];
+                        error += difference * difference;
+                    }
+                    if (error < bestError) {
+                        bestError = error;
+                        best = entry;
+                    }
+                }
+                indices |= best << (index * 2);
+            }
+        }
+        output[0] = static_cast<uint8_t>(color0 & 0xFF);
+        output[1] = static_cast<uint8_t>(color0 >> 8);
+        output[2] = static_cast<uint8_t>(color1 & 0xFF);
+        output[3] = static_cast<uint8_t>(color1 >> 8);
+        for (int byte = 0; byte < 4; ++byte) {
+            output[4 + byte] = static_cast<uint8_t>(indices >> (byte * 8));
+        }
+    }
+
+    // BC4 block, also the alpha half of BC3 and each half of BC5
+    static void encodeChannelBlock(const Block& block, int channel, uint8_t* output) {
+        uint8_t lowest = 255;
+        uint8_t highest = 0;
+        for (const auto& pixel : block) {
+            lowest = std::min(lowest, pixel[channel]);
+            highest = std::max(highest, pixel[channel]);
+        }
+        uint64_t indices = 0;
+        if (highest != lowest) { // First endpoint larger selects the eight value mode
+            const int range = highest - lowest;
+            for (size_t index = 0; index < BLOCK_PIXELS; ++index) {
+                const int step = ((block[index][channel] - lowest) * 7 + range / 2) / range;
+                const uint64_t code = step == 7 ? 0 : (step == 0 ? 1 : static_cast<uint64_t>(8 - step));
+                indices |= code << (index * 3);
+            }
+        }
+        output[0] = highest;
+        output[1] = lowest;
+        for (int byte = 0; byte < 6; ++byte) {
+            output[2 + byte] = static_cast<uint8_t>(indices >> (byte * 8));
+        }
+    }
+
+public:
+    [[nodiscard]] static size_t getBlockBytes(MentalBlockFormat format) { return format == BC1 ? 8 : 16; }
+
+    [[nodiscard]] static size_t getCompressedSize(MentalBlockFormat format, int width, int height) {
+        const size_t blocksWide = static_cast<size_t>(std::max(1, (width + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION));
+        const size_t blocksHigh = static_cast<size_t>(std::max(1, (height + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION));
+        return blocksWide * blocksHigh * getBlockBytes(format);
+    }
+
+    // Tightly packed RGBA8 in, blocks in row order out; partial edge blocks repeat the last pixel
+    static std::vector<uint8_t> compress(const uint8_t* rgba, int width, int height, MentalBlockFormat format) {
+        std::vector<uint8_t> output(getCompressedSize(format, width, height));
+        const size_t blockBytes = getBlockBytes(format);
+        uint8_t* cursor = output.data();
+        Block block{};
+        for (int blockY = 0; blockY < height; blockY += BLOCK_DIMENSION) {
+            for (int blockX = 0; blockX < width; blockX += BLOCK_DIMENSION) {
+                for (int row = 0; row < BLOCK_DIMENSION; ++row) {
+                    const int y = std::min(blockY + row, height - 1);
+                    for (int column = 0; column < BLOCK_DIMENSION; ++column) {
+                        const int x = std::min(blockX + column, width - 1);
+                        const uint8_t* pixel = rgba + (static_cast<size_t>(y) * width + x) * 4;
+                        std::copy(pixel, pixel + 4, block[row * BLOCK_DIMENSION + column].begin());
+                    }
+                }
+                switch (format) {
+                    case BC1:
+                        encodeColorBlock(block, cursor);
+                        break;
+                    case BC3:
+                        encodeChannelBlock(block, 3, cursor);
+                        encodeColorBlock(block, cursor + 8);
+                        break;
+                    case BC5:
+                        encodeChannelBlock(block, 0, cursor);
+                        encodeChannelBlock(block, 1, cursor + 8);
+                        break;
+                }
+                cursor += blockBytes;
+            }
+        }
+        return output;
+    }
+};
+
+} // mentalsdk
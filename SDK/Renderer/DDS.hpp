@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <vector>
+#include "BlockCompression.hpp"
+
+namespace mentalsdk
+{
+
+const uint32_t DDS_MAGIC = 0x20534444U; // "DDS "
+const uint32_t DDS_HEADER_SIZE = 124;
+const uint32_t DDS_MAX_LEVELS = 16;
+
+struct CMentalDDSLevel {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    int width = 0;
+    int height = 0;
+};
+
+struct CMentalDDSImage {
+    MentalBlockFormat format = BC1;
+    int width = 0;
+    int height = 0;
+    std::vector<CMentalDDSLevel> levels; // Point into the parsed bytes, largest first
+};
+
+// Legacy DDS container with FourCC formats (DXT1, DXT5, ATI2), which every DDS reader
+// understands. Levels are stored back to back after the header, so a mapped file can be
+// handed to glCompressedTexImage2D level by level without copying.
+class CMentalDDS
+{
+private:
+    static const uint32_t FLAGS = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000; // caps, size, pixel format, mips, linear size
+    static const uint32_t PIXEL_FORMAT_FOURCC = 0x4;
+    static const uint32_t CAPS_COMPLEX = 0x8;
+    static const uint32_t CAPS_TEXTURE = 0x1000;
+    static const uint32_t CAPS_MIPMAP = 0x400000;
+
+    static constexpr uint32_t fourCC(char first, char second, char third, char fourth) {
+        return static_cast<uint32_t>(first) | (static_cast<uint32_t>(second) << 8) |
+               (static_cast<uint32_t>(third) << 16) | (static_cast<uint32_t>(fourth) << 24);
+    }
+
+    static uint32_t formatCode(MentalBlockFormat format) {
+        switch (format) {
+            case BC3: return fourCC('D', 'X', 'T', '5');
+            case BC5: return fourCC('A', 'T', 'I', '2');
+            default: return fourCC('D', 'X', 'T', '1');
+        }
+    }
+
+    static uint32_t readWord(const uint8_t* data, size_t word) {
+        uint32_t value = 0;
+        std::memcpy(&value, data + word * 4, sizeof(value));
+        return value;
+    }
+
+public:
+    static bool write(std::ostream& stream, MentalBlockFormat format, int width, int height, const std::vector<std::vector<uint8_t>>& levels) {
+        uint32_t header[1 + DDS_HEADER_SIZE / 4] = {};
+        header[0] = DDS_MAGIC;
+        header[1] = DDS_HEADER_SIZE;
+        header[2] = FLAGS;
+        header[3] = static_cast<uint32_t>(height);
+        header[4] = static_cast<uint32_t>(width);
+        header[5] = levels.empty() ? 0 : static_cast<uint32_t>(levels.front().size());
+        header[7] = static_cast<uint32_t>(levels.size());
+        header[19] = 32; // Pixel format block size
+        header[20] = PIXEL_FORMAT_FOURCC;
+        header[21] = formatCode(format);
+        header[27] = CAPS_TEXTURE | (levels.size() > 1 ? CAPS_COMPLEX | CAPS_MIPMAP : 0);
+        stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+        for (const std::vector<uint8_t>& level : levels) {
+            stream.write(reinterpret_cast<const char*>(level.data()), static_cast<std::streamsize>(level.size()));
+        }
+        return static_cast<bool>(stream);
+    }
+
+    // Fails on anything but the block formats written by write()
+    static bool parse(const uint8_t* data, size_t size, CMentalDDSImage& image) {
+        const size_t headerBytes = 4 + DDS_HEADER_SIZE;
+        if (data == nullptr || size < headerBytes || readWord(data, 0) != DDS_MAGIC || readWord(data, 1) != DDS_HEADER_SIZE) {
+            return false;
+        }
+        if ((readWord(data, 20) & PIXEL_FORMAT_FOURCC) == 0) {
+            return false;
+        }
+        const uint32_t code = readWord(data, 21);
+        if (code == formatCode(BC1)) {
+            image.format = BC1;
+        } else if (code == formatCode(BC3)) {
+            image.format = BC3;
+        } else if (code == formatCode(BC5) || code == fourCC('B', 'C', '5', 'U')) {
+            image.format = BC5;
+        } else {
+            return false;
+        }
+
+        image.height = static_cast<int>(readWord(data, 3));
+        image.width = static_cast<int>(readWord(data, 4));
+        const uint32_t levelCount = std::min(std::max(readWord(data, 7), 1U), DDS_MAX_LEVELS);
+        if (image.width <= 0 || image.height <= 0) {
+            return false;
+        }
+
+        image.levels.clear();
+        size_t offset = headerBytes;
+        int width = image.width;
+        int height = image.height;
+        for (uint32_t level = 0; level < levelCount; ++level) {
+            const size_t bytes = CMentalBlockCompressor::getCompressedSize(image.format, width, height);
+            if (offset + bytes > size) {
+                return false;
+            }
+            image.levels.push_back({ data + offset, bytes, width, height });
+            offset += bytes;
+            if (width == 1 && height == 1) {
+                break;
+            }
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+        return true;
+    }
+};
+
+} // mentalsdk
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace mentalsdk
+{
+
+class CMentalObject;
+
+struct CMentalDrawItem {
+    uint64_t sortKey = 0;
+    std::shared_ptr<const CMentalObject> object; // Owned until the slot is recorded again, so removal cannot free it mid-draw
+    glm::mat4 model{ 1.0F };
+    uint32_t transformVersion = 0; // Of the object when model was taken, lets GPU records skip unchanged transforms
+
+    bool operator<(const CMentalDrawItem& other) const { return sortKey < other.sortKey; }
+};
+
+// Everything the render thread needs to draw one frame. Simulation fills it, the renderer
+// only reads it, so the live objects can keep moving while the packet is being submitted.
+// Drawing reads transforms from here and everything else from the objects, which only
+// changes in the frame sync stage (see CMentalFrameQueue::publish).
+struct CMentalFramePacket {
+    uint64_t frameIndex = 0;
+    glm::mat4 view{ 1.0F };
+    glm::mat4 projection{ 1.0F };
+    bool clearEnabled = false;
+    float clearColor[4] = {0.0F, 0.0F, 0.0F, 1.0F};
+    bool frustumCulled = true; // False when arena meshes were left to the GPU culling pass
+    std::vector<CMentalDrawItem> draws;
+};
+
+// Triple buffer between one producer (simulation) and one consumer (render thread).
+// The producer is paced to stay at most one published frame ahead of the consumer.
+class CMentalFrameQueue
+{
+private:
+    CMentalFramePacket packets_[3];
+    int back_ = 0;   // Being written by simulation
+    int ready_ = 1;  // Published, waiting for the renderer
+    int front_ = 2;  // Being read by the renderer
+    bool hasReady_ = false;
+    bool stopped_ = false;
+    const std::function<void()>* sync_ = nullptr; // Published with the ready packet, run by the consumer as it takes it
+    std::mutex mutex_;
+    std::condition_variable changed_;
+
+public:
+    CMentalFrameQueue() = default;
+    ~CMentalFrameQueue() = default;
+
+    CMentalFrameQueue(const CMentalFrameQueue&) = delete;
+    CMentalFrameQueue& operator=(const CMentalFrameQueue&) = delete;
+    CMentalFrameQueue(CMentalFrameQueue&&) = delete;
+    CMentalFrameQueue& operator=(CMentalFrameQueue&&) = delete;
+
+    CMentalFramePacket& getBackPacket() { return packets_[back_]; }
+
+    // Blocks while the previous frame has not been picked up yet. With a sync task it also
+    // blocks until the consumer has taken this frame and run the task on its thread, before
+    // drawing it: the producer is between frames and the consumer has presented the last
+    // one, so the task may use GL and change the world. Only the hand-off is waited for,
+    // the producer simulates the next frame while this one is drawn
+    void publish(const std::function<void()>& sync = nullptr) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [this]() { return !hasReady_ || stopped_; });
+        std::swap(back_, ready_);
+        hasReady_ = true;
+        sync_ = sync ? &sync : nullptr;
+        changed_.notify_all();
+        if (sync_ != nullptr) {
+            changed_.wait(lock, [this]() { return sync_ == nullptr || stopped_; });
+            sync_ = nullptr;
+        }
+    }
+
+    // Returns nullptr once stopped, the packet stays valid until the next acquire. Runs the
+    // sync task published with it first
+    const CMentalFramePacket* acquire() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [this]() { return hasReady_ || stopped_; });
+        if (!hasReady_) {
+            return nullptr;
+        }
+        std::swap(front_, ready_);
+        hasReady_ = false;
+        if (const std::function<void()>* task = sync_) {
+            lock.unlock();
+            (*task)();
+            lock.lock();
+            sync_ = nullptr;
+        }
+        changed_.notify_all();
+        return &packets_[front_];
+    }
+
+    void stop() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+        changed_.notify_all();
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        hasReady_ = false;
+        stopped_ = false;
+        sync_ = nullptr;
+    }
+};
+
+} // mentalsdk
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <iostream>
+
+namespace mentalsdk
+{
+
+// GL error reporting for debug builds (MENTAL_GL_DEBUG). With KHR_debug the driver calls
+// back on the offending call, so nothing polls; without it the window drains glGetError
+// once per frame instead of once per draw.
+class CMentalGLDebug
+{
+private:
+    static bool& installed() {
+        static bool value = false;
+        return value;
+    }
+
+    static const char* severityName(GLenum severity) {
+        switch (severity) {
+            case GL_DEBUG_SEVERITY_HIGH: return "high";
+            case GL_DEBUG_SEVERITY_MEDIUM: return "medium";
+            case GL_DEBUG_SEVERITY_LOW: return "low";
+            default: return "info";
+        }
+    }
+
+    static void GLAPIENTRY callback(GLenum /*source*/, GLenum type, GLuint id, GLenum severity,
+                                    GLsizei /*length*/, const GLchar* message, const void* /*userParam*/) {
+        const char* kind = type == GL_DEBUG_TYPE_ERROR ? "error" : "message";
+        std::cerr << "OpenGL " << kind << " " << id << " (" << severityName(severity) << "): " << message << "\n";
+    }
+
+public:
+    // Needs a current context; returns false when it has no debug output
+    static bool install() {
+        if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug) {
+            return false;
+        }
+        glEnable(GL_DEBUG_OUTPUT);
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS); // Report from inside the failing call
+        glDebugMessageCallback(&CMentalGLDebug::callback, nullptr);
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+        installed() = true;
+        return true;
+    }
+
+    [[nodiscard]] static bool isInstalled() { return installed(); }
+
+    static void checkErrors(const char* where) {
+        for (GLenum error = glGetError(); error != GL_NO_ERROR; error = glGetError()) {
+            std::cerr << "OpenGL error " << error << " during " << where << "\n";
+        }
+    }
+};
+
+} // mentalsdk
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace mentalsdk
+{
+
+using GLRelease = std::function<void()>;
+
+// GL objects whose owner died away from the GL thread. With threaded rendering the last
+// reference to an object can go with a frame packet on the simulation thread, so owners
+// hand their glDelete* calls to defer() and the window runs them with collect() on the GL
+// thread between frames. Nothing queued here is still referenced by a packet in flight.
+class CMentalGLReleaseQueue
+{
+private:
+    std::mutex mutex_;
+    std::vector<GLRelease> pending_;
+    std::vector<GLRelease> running_; // Swapped with pending_ so releases run without the lock
+
+    CMentalGLReleaseQueue() = default;
+
+public:
+    ~CMentalGLReleaseQueue() = default;
+
+    CMentalGLReleaseQueue(const CMentalGLReleaseQueue&) = delete;
+    CMentalGLReleaseQueue& operator=(const CMentalGLReleaseQueue&) = delete;
+    CMentalGLReleaseQueue(CMentalGLReleaseQueue&&) = delete;
+    CMentalGLReleaseQueue& operator=(CMentalGLReleaseQueue&&) = delete;
+
+    static CMentalGLReleaseQueue& instance() {
+        static CMentalGLReleaseQueue queue;
+        return queue;
+    }
+
+    // Any thread
+    void defer(GLRelease release) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        this->pending_.push_back(std::move(release));
+    }
+
+    // GL thread, with the context current. A release may defer more, those run next time
+    void collect() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (this->pending_.empty()) {
+                return;
+            }
+            std::swap(this->pending_, this->running_);
+        }
+        for (GLRelease& release : this->running_) {
+            release();
+        }
+        this->running_.clear();
+    }
+};
+
+} // mentalsdk
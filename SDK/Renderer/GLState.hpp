@@ -0,0 +1,116 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <array>
+#include <cstdint>
+#include "../Utils/Stats.hpp"
+
+namespace mentalsdk
+{
+
+const size_t GL_STATE_TEXTURE_UNITS = 16;
+const GLuint GL_STATE_UNKNOWN = 0xFFFFFFFFU;
+
+// Shadow of GL binding state for the context current on the calling thread, so redundant
+// binds are skipped and counted. Every bind that should be cached has to go through here;
+// code that binds behind its back calls invalidate() afterwards.
+class CMentalGLState
+{
+private:
+    struct Bindings {
+        GLuint program = 0;
+        GLuint vertexArray = 0;
+        GLuint activeUnit = 0;
+        std::array<GLuint, GL_STATE_TEXTURE_UNITS> textures{};
+    };
+
+    static Bindings& bindings() {
+        thread_local Bindings current;
+        return current;
+    }
+
+    static bool skip() {
+        CMentalStats::instance().addSavedBinds(1);
+        return false;
+    }
+
+    static void activateUnit(GLuint unit) {
+        Bindings& state = bindings();
+        if (state.activeUnit != unit) {
+            glActiveTexture(GL_TEXTURE0 + unit);
+            state.activeUnit = unit;
+        }
+    }
+
+public:
+    // Each bind returns true when the binding actually changed
+    static bool useProgram(GLuint program) {
+        Bindings& state = bindings();
+        if (state.program == program) {
+            return skip();
+        }
+        glUseProgram(program);
+        state.program = program;
+        return true;
+    }
+
+    static bool bindVertexArray(GLuint vao) {
+        Bindings& state = bindings();
+        if (state.vertexArray == vao) {
+            return skip();
+        }
+        glBindVertexArray(vao);
+        state.vertexArray = vao;
+        return true;
+    }
+
+    // Texture names are unique across targets, so one slot per unit tracks the last bind of
+    // any target. Units past GL_STATE_TEXTURE_UNITS are bound uncached
+    static bool bindTexture(GLuint unit, GLuint texture, GLenum target = GL_TEXTURE_2D) {
+        Bindings& state = bindings();
+        if (unit >= GL_STATE_TEXTURE_UNITS) {
+            glActiveTexture(GL_TEXTURE0 + unit);
+            glBindTexture(target, texture);
+            state.activeUnit = GL_STATE_UNKNOWN;
+            return true;
+        }
+        if (state.textures[unit] == texture) {
+            return skip();
+        }
+        activateUnit(unit);
+        glBindTexture(target, texture);
+        state.textures[unit] = texture;
+        return true;
+    }
+
+    // Deleting a bound object resets that binding in GL, and its name may come back
+    static void onProgramDeleted(GLuint program) {
+        if (bindings().program == program) {
+            bindings().program = GL_STATE_UNKNOWN;
+        }
+    }
+
+    static void onVertexArrayDeleted(GLuint vao) {
+        if (bindings().vertexArray == vao) {
+            bindings().vertexArray = 0;
+        }
+    }
+
+    static void onTextureDeleted(GLuint texture) {
+        for (GLuint& bound : bindings().textures) {
+            if (bound == texture) {
+                bound = 0;
+            }
+        }
+    }
+
+    static void invalidate() {
+        Bindings& state = bindings();
+        state.program = GL_STATE_UNKNOWN;
+        state.vertexArray = GL_STATE_UNKNOWN;
+        state.activeUnit = GL_STATE_UNKNOWN;
+        state.textures.fill(GL_STATE_UNKNOWN);
+    }
+};
+
+} // mentalsdk
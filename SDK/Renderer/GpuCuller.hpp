@@ -0,0 +1,547 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "../Math/Bounds.hpp"
+#include "../Utils/Profiler.hpp"
+#include "../Utils/Stats.hpp"
+#include "../Objects/Object.hpp"
+#include "FramePacket.hpp"
+#include "Shader.hpp"
+
+namespace mentalsdk
+{
+
+const GLuint GPU_CULL_GROUP_SIZE = 64;
+const GLuint HIZ_GROUP_SIZE = 8;
+const uint32_t GPU_OBJECT_NO_SLOT = 0xFFFFFFFFU;
+
+// Mesh range of a resident object, read as a uvec4 by the culling pass
+struct CMentalGpuMesh {
+    uint32_t indexCount = 0;
+    uint32_t firstIndex = 0;
+    int32_t baseVertex = 0;
+    uint32_t padding = 0;
+
+    bool operator!=(const CMentalGpuMesh& other) const {
+        return indexCount != other.indexCount || firstIndex != other.firstIndex || baseVertex != other.baseVertex;
+    }
+};
+
+// One thread per instance. The frame only lists object slots; transform, local bounds and
+// mesh range come from the resident object records (CMentalGpuObjectTable). Each thread
+// tests the frustum and then the previous frame's depth pyramid and writes the whole
+// indirect command, with the slot as base instance so vertex shaders read the resident
+// transform too.
+const char* const GPU_CULL_SHADER = R"(#version 430 core
+layout (local_size_x = 64) in;
+layout (std430, binding = 0) readonly buffer Transforms { mat4 models[]; };
+layout (std430, binding = 1) readonly buffer Bounds { vec4 bounds[]; };
+layout (std430, binding = 2) readonly buffer Meshes { uvec4 meshes[]; };
+layout (std430, binding = 3) readonly buffer Instances { uint slots[]; };
+layout (std430, binding = 4) writeonly buffer Commands { uint commands[]; };
+uniform uint instanceCount;
+uniform uint instanceBase;
+uniform uint commandBase;
+uniform vec4 planes[6];
+uniform mat4 viewProjection;
+uniform bool occlusion;
+uniform vec2 pyramidSize;
+uniform sampler2D pyramid;
+
+bool occluded(vec3 center, vec3 extent) {
+    vec3 screenMin = vec3(1.0);
+    vec3 screenMax = vec3(-1.0);
+    for (int corner = 0; corner < 8; ++corner) {
+        vec3 offset = vec3((corner & 1) != 0 ? 1.0 : -1.0, (corner & 2) != 0 ? 1.0 : -1.0, (corner & 4) != 0 ? 1.0 : -1.0);
+        vec4 clip = viewProjection * vec4(center + extent * offset, 1.0);
+        if (clip.w <= 0.0) {
+            return false; // Crosses the camera plane, keep it
+        }
+        vec3 ndc = clip.xyz / clip.w;
+        screenMin = min(screenMin, ndc);
+        screenMax = max(screenMax, ndc);
+    }
+    vec2 uvMin = clamp(screenMin.xy * 0.5 + 0.5, 0.0, 1.0);
+    vec2 uvMax = clamp(screenMax.xy * 0.5 + 0.5, 0.0, 1.0);
+    vec2 size = (uvMax - uvMin) * pyramidSize;
+    float level = ceil(log2(max(max(size.x, size.y), 1.0)));
+    float farthest = max(max(textureLod(pyramid, uvMin, level).r, textureLod(pyramid, vec2(uvMax.x, uvMin.y), level).r),
+                         max(textureLod(pyramid, vec2(uvMin.x, uvMax.y), level).r, textureLod(pyramid, uvMax, level).r));
+    return screenMin.z * 0.5 + 0.5 > farthest;
+}
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= instanceCount) {
+        return;
+    }
+    uint slot = slots[instanceBase + index];
+    mat4 model = models[slot];
+    vec3 localMin = bounds[slot * 2u].xyz;
+    vec3 localMax = bounds[slot * 2u + 1u].xyz;
+    vec3 localCenter = (localMin + localMax) * 0.5;
+    vec3 localExtent = (localMax - localMin) * 0.5;
+    vec3 center = (model * vec4(localCenter, 1.0)).xyz;
+    vec3 extent = abs(model[0].xyz) * localExtent.x + abs(model[1].xyz) * localExtent.y + abs(model[2].xyz) * localExtent.z;
+
+    bool visible = true;
+    for (int plane = 0; plane < 6; ++plane) {
+        if (dot(planes[plane].xyz, center) + planes[plane].w < -dot(abs(planes[plane].xyz), extent)) {
+            visible = false;
+        }
+    }
+    if (visible && occlusion) {
+        visible = !occluded(center, extent);
+    }
+    uvec4 mesh = meshes[slot];
+    uint command = commandBase + index * 5u;
+    commands[command] = mesh.x;
+    commands[command + 1u] = visible ? 1u : 0u;
+    commands[command + 2u] = mesh.y;
+    commands[command + 3u] = mesh.z;
+    commands[command + 4u] = slot;
+}
+)";
+
+// Level 0 of the pyramid from the depth copy, every further level keeps the farthest depth
+// of the texels it covers (odd sizes fold the extra row and column in)
+const char* const HIZ_SHADER = R"(#version 430 core
+layout (local_size_x = 8, local_size_y = 8) in;
+layout (r32f, binding = 0) uniform writeonly image2D destination;
+uniform sampler2D depth;
+uniform sampler2D source;
+uniform int sourceLevel;
+uniform ivec2 destinationSize;
+
+void main() {
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if (texel.x >= destinationSize.x || texel.y >= destinationSize.y) {
+        return;
+    }
+    if (sourceLevel < 0) {
+        imageStore(destination, texel, vec4(texelFetch(depth, texel, 0).r));
+        return;
+    }
+    ivec2 sourceSize = textureSize(source, sourceLevel);
+    ivec2 first = texel * 2;
+    ivec2 last = min(first + ivec2(1) + ivec2(sourceSize.x & 1, sourceSize.y & 1) * ivec2(texel.x == destinationSize.x - 1 ? 1 : 0, texel.y == destinationSize.y - 1 ? 1 : 0),
+                     sourceSize - ivec2(1));
+    float farthest = 0.0;
+    for (int y = first.y; y <= last.y; ++y) {
+        for (int x = first.x; x <= last.x; ++x) {
+            farthest = max(farthest, texelFetch(source, ivec2(x, y), sourceLevel).r);
+        }
+    }
+    imageStore(destination, texel, vec4(farthest));
+}
+)";
+
+// GPU-resident record of every object the culling pass draws, one slot per object. Records
+// are uploaded when an object first shows up and again only when its transform, mesh range
+// or atlas region changed; a frame then costs one slot index per instance. Slots of objects
+// missing from a frame are reclaimed at the next upload. All calls belong to the GL thread.
+class CMentalGpuObjectTable
+{
+private:
+    struct Resident {
+        std::shared_ptr<const CMentalObject> object; // Keeps the address from being reused while the slot is mapped
+        uint32_t transformVersion = 0;
+        uint64_t frame = 0;
+    };
+
+    GLuint transforms_ = 0; // mat4 per slot, also the instance attribute source
+    GLuint bounds_ = 0;     // Local min and max, two vec4 per slot
+    GLuint meshes_ = 0;     // Index count, first index, base vertex
+    GLuint regions_ = 0;    // Atlas region per slot
+    uint32_t capacity_ = 0;
+    uint64_t frame_ = 0;
+    std::unordered_map<const CMentalObject*, uint32_t> slots_;
+    std::vector<Resident> residents_;
+    std::vector<uint32_t> freeSlots_;
+    std::vector<uint32_t> dirty_;
+    std::vector<glm::mat4> transformData_; // CPU mirrors, so dirty runs upload in one call each
+    std::vector<glm::vec4> boundsData_;
+    std::vector<CMentalGpuMesh> meshData_;
+    std::vector<CMentalAtlasRegion> regionData_;
+
+    static GLuint createBuffer(size_t bytes) {
+        GLuint buffer = 0;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return buffer;
+    }
+
+    template <typename Type>
+    static void uploadRun(GLuint buffer, const std::vector<Type>& data, size_t first, size_t count) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(first * sizeof(Type)),
+                        static_cast<GLsizeiptr>(count * sizeof(Type)), data.data() + first);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    [[nodiscard]] int64_t totalBytes() const {
+        return static_cast<int64_t>(capacity_) *
+               static_cast<int64_t>(sizeof(glm::mat4) + sizeof(glm::vec4) * 2 + sizeof(CMentalGpuMesh) + sizeof(CMentalAtlasRegion));
+    }
+
+public:
+    CMentalGpuObjectTable() = default;
+    ~CMentalGpuObjectTable() = default; // destroy() must run on the GL thread
+
+    CMentalGpuObjectTable(const CMentalGpuObjectTable&) = delete;
+    CMentalGpuObjectTable& operator=(const CMentalGpuObjectTable&) = delete;
+    CMentalGpuObjectTable(CMentalGpuObjectTable&&) = delete;
+    CMentalGpuObjectTable& operator=(CMentalGpuObjectTable&&) = delete;
+
+    bool create(uint32_t capacity) {
+        this->destroy();
+        capacity_ = capacity;
+        transforms_ = createBuffer(capacity * sizeof(glm::mat4));
+        bounds_ = createBuffer(capacity * sizeof(glm::vec4) * 2);
+        meshes_ = createBuffer(capacity * sizeof(CMentalGpuMesh));
+        regions_ = createBuffer(capacity * sizeof(CMentalAtlasRegion));
+        if (transforms_ == 0 || bounds_ == 0 || meshes_ == 0 || regions_ == 0) {
+            this->destroy();
+            return false;
+        }
+        residents_.resize(capacity);
+        transformData_.resize(capacity);
+        boundsData_.resize(static_cast<size_t>(capacity) * 2);
+        meshData_.resize(capacity);
+        regionData_.resize(capacity);
+        freeSlots_.reserve(capacity);
+        for (uint32_t slot = capacity; slot > 0; --slot) {
+            freeSlots_.push_back(slot - 1);
+        }
+        CMentalStats::instance().addGpuMemory(MentalGpuResource::VertexBuffer, this->totalBytes());
+        return true;
+    }
+
+    void destroy() {
+        if (capacity_ == 0) {
+            return;
+        }
+        const GLuint buffers[] = { transforms_, bounds_, meshes_, regions_ };
+        glDeleteBuffers(4, buffers);
+        CMentalStats::instance().addGpuMemory(MentalGpuResource::VertexBuffer, -this->totalBytes());
+        transforms_ = bounds_ = meshes_ = regions_ = 0;
+        capacity_ = 0;
+        slots_.clear();
+        residents_.clear();
+        freeSlots_.clear();
+        dirty_.clear();
+        transformData_.clear();
+        boundsData_.clear();
+        meshData_.clear();
+        regionData_.clear();
+    }
+
+    void beginFrame() { ++frame_; }
+
+    // Slot of the item's object for this frame, GPU_OBJECT_NO_SLOT once the table is full
+    uint32_t acquire(const CMentalDrawItem& item) {
+        const CMentalObject& object = *item.object;
+        auto found = slots_.find(&object);
+        if (found == slots_.end()) {
+            if (freeSlots_.empty()) {
+                return GPU_OBJECT_NO_SLOT;
+            }
+            found = slots_.emplace(&object, freeSlots_.back()).first;
+            freeSlots_.pop_back();
+            Resident& resident = residents_[found->second];
+            resident.object = item.object;
+            resident.transformVersion = item.transformVersion + 1; // Anything but the current one
+        }
+
+        const uint32_t slot = found->second;
+        Resident& resident = residents_[slot];
+        resident.frame = frame_;
+        const CMentalMeshAllocation& mesh = object.getMeshAllocation();
+        const CMentalGpuMesh meshRecord{ mesh.indexCount, mesh.getFirstIndex(), mesh.getBaseVertex(), 0U };
+        const CMentalAtlasRegion& region = object.getAtlasRegion();
+        const bool regionChanged = region.rect != regionData_[slot].rect || region.layer != regionData_[slot].layer;
+        if (resident.transformVersion != item.transformVersion || meshRecord != meshData_[slot] || regionChanged) {
+            resident.transformVersion = item.transformVersion;
+            transformData_[slot] = item.model;
+            const AABB& local = object.getLocalBounds();
+            boundsData_[static_cast<size_t>(slot) * 2] = glm::vec4(local.min, 1.0F);
+            boundsData_[static_cast<size_t>(slot) * 2 + 1] = glm::vec4(local.max, 1.0F);
+            meshData_[slot] = meshRecord;
+            regionData_[slot] = region;
+            dirty_.push_back(slot);
+        }
+        return slot;
+    }
+
+    // Reclaims slots not acquired this frame and uploads the changed records, before culling
+    void upload() {
+        MENTAL_PROFILE_SCOPE("GPU Object Upload");
+        for (auto iterator = slots_.begin(); iterator != slots_.end();) {
+            Resident& resident = residents_[iterator->second];
+            if (resident.frame == frame_) {
+                ++iterator;
+                continue;
+            }
+            resident.object.reset();
+            freeSlots_.push_back(iterator->second);
+            iterator = slots_.erase(iterator);
+        }
+        if (dirty_.empty()) {
+            return;
+        }
+        std::sort(dirty_.begin(), dirty_.end());
+        size_t runStart = 0;
+        while (runStart < dirty_.size()) {
+            size_t runEnd = runStart + 1;
+            while (runEnd < dirty_.size() && dirty_[runEnd] == dirty_[runEnd - 1] + 1) {
+                ++runEnd;
+            }
+            const size_t first = dirty_[runStart];
+            const size_t count = runEnd - runStart;
+            uploadRun(transforms_, transformData_, first, count);
+            uploadRun(bounds_, boundsData_, first * 2, count * 2);
+            uploadRun(meshes_, meshData_, first, count);
+            uploadRun(regions_, regionData_, first, count);
+            runStart = runEnd;
+        }
+        dirty_.clear();
+    }
+
+    [[nodiscard]] GLuint getTransformBuffer() const { return transforms_; }
+    [[nodiscard]] GLuint getBoundsBuffer() const { return bounds_; }
+    [[nodiscard]] GLuint getMeshBuffer() const { return meshes_; }
+    [[nodiscard]] GLuint getRegionBuffer() const { return regions_; }
+    [[nodiscard]] uint32_t getCapacity() const { return capacity_; }
+    [[nodiscard]] size_t getResidentCount() const { return slots_.size(); }
+};
+
+// Compute culling for the batch renderer on GL 4.3. The pyramid comes from the previous
+// frame, so something uncovered this frame can stay hidden for one frame.
+class CMentalGpuCuller
+{
+private:
+    GLuint cullProgram_ = 0;
+    GLuint pyramidProgram_ = 0;
+    GLuint depthFramebuffer_ = 0;
+    GLuint depthTexture_ = 0;   // Copy of the frame's depth, D24S8 to match the blit source
+    GLuint pyramid_ = 0;        // R32F, farthest depth per texel and level
+    GLint width_ = 0;
+    GLint height_ = 0;
+    GLint levels_ = 0;
+    bool pyramidValid_ = false;
+    bool occlusion_ = true;
+
+    static GLuint compileProgram(const char* source) {
+        const GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+
+        int success = 0;
+        char logInfo[MAX_LOG_INFO_LENGTH];
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (success == 0) {
+            glGetShaderInfoLog(shader, MAX_LOG_INFO_LENGTH, nullptr, logInfo);
+            std::cerr << "Compute shader compilation error:\n" << logInfo << "\n";
+            glDeleteShader(shader);
+            return 0;
+        }
+
+        const GLuint program = glCreateProgram();
+        glAttachShader(program, shader);
+        glLinkProgram(program);
+        glDeleteShader(shader);
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (success == 0) {
+            glGetProgramInfoLog(program, MAX_LOG_INFO_LENGTH, nullptr, logInfo);
+            std::cerr << "Compute program linking error:\n" << logInfo << "\n";
+            glDeleteProgram(program);
+            return 0;
+        }
+        return program;
+    }
+
+    [[nodiscard]] int64_t targetBytes() const {
+        int64_t bytes = static_cast<int64_t>(width_) * height_ * 4;
+        for (GLint level = 0, width = width_, height = height_; level < levels_; ++level) {
+            bytes += static_cast<int64_t>(width) * height * 4;
+            width = std::max(width / 2, 1);
+            height = std::max(height / 2, 1);
+        }
+        return bytes;
+    }
+
+    void destroyTargets() {
+        if (depthFramebuffer_ == 0) {
+            return;
+        }
+        glDeleteFramebuffers(1, &depthFramebuffer_);
+        glDeleteTextures(1, &depthTexture_);
+        glDeleteTextures(1, &pyramid_);
+        CMentalStats::instance().addGpuMemory(MentalGpuResource::TextureMemory, -this->targetBytes());
+        depthFramebuffer_ = depthTexture_ = pyramid_ = 0;
+        pyramidValid_ = false;
+    }
+
+    void createTargets(GLint width, GLint height) {
+        this->destroyTargets();
+        width_ = width;
+        height_ = height;
+        levels_ = 1;
+        while ((std::max(width, height) >> levels_) > 0) {
+            ++levels_;
+        }
+
+        glGenTextures(1, &depthTexture_);
+        glBindTexture(GL_TEXTURE_2D, depthTexture_);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH24_STENCIL8, width, height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        glGenTextures(1, &pyramid_);
+        glBindTexture(GL_TEXTURE_2D, pyramid_);
+        glTexStorage2D(GL_TEXTURE_2D, levels_, GL_R32F, width, height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenFramebuffers(1, &depthFramebuffer_);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, depthFramebuffer_);
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthTexture_, 0);
+        CMentalGLState::invalidate();
+        CMentalStats::instance().addGpuMemory(MentalGpuResource::TextureMemory, this->targetBytes());
+    }
+
+public:
+    CMentalGpuCuller() = default;
+    ~CMentalGpuCuller() = default; // destroy() must run on the GL thread
+
+    CMentalGpuCuller(const CMentalGpuCuller&) = delete;
+    CMentalGpuCuller& operator=(const CMentalGpuCuller&) = delete;
+    CMentalGpuCuller(CMentalGpuCuller&&) = delete;
+    CMentalGpuCuller& operator=(CMentalGpuCuller&&) = delete;
+
+    static bool isSupported() {
+        return GLEW_VERSION_4_3 || (GLEW_ARB_compute_shader && GLEW_ARB_shader_storage_buffer_object);
+    }
+
+    bool initialize() {
+        if (!isSupported()) {
+            return false;
+        }
+        cullProgram_ = compileProgram(GPU_CULL_SHADER);
+        pyramidProgram_ = compileProgram(HIZ_SHADER);
+        if (cullProgram_ == 0 || pyramidProgram_ == 0) {
+            this->destroy();
+            return false;
+        }
+        return true;
+    }
+
+    void destroy() {
+        this->destroyTargets();
+        glDeleteProgram(cullProgram_);
+        glDeleteProgram(pyramidProgram_);
+        cullProgram_ = pyramidProgram_ = 0;
+    }
+
+    [[nodiscard]] bool isValid() const { return cullProgram_ != 0; }
+    void setOcclusion(bool enabled) { occlusion_ = enabled; }
+    [[nodiscard]] bool isOcclusionEnabled() const { return occlusion_; }
+
+    // Culls instanceCount slots listed in the instances buffer from instanceBase (in uints) and
+    // writes one indirect command each from commandBase (in uints, five per command).
+    // Commands are ready for drawing when this returns.
+    void cull(const CMentalGpuObjectTable& objects, GLuint instances, GLuint commands, GLuint instanceBase, GLuint commandBase,
+              GLuint instanceCount, const glm::mat4& viewProjection) {
+        if (instanceCount == 0) {
+            return;
+        }
+        MENTAL_PROFILE_SCOPE("GPU Cull");
+        const Frustum frustum = Frustum::fromMatrix(viewProjection);
+        glUseProgram(cullProgram_);
+        glUniform1ui(glGetUniformLocation(cullProgram_, "instanceCount"), instanceCount);
+        glUniform1ui(glGetUniformLocation(cullProgram_, "instanceBase"), instanceBase);
+        glUniform1ui(glGetUniformLocation(cullProgram_, "commandBase"), commandBase);
+        glUniform4fv(glGetUniformLocation(cullProgram_, "planes"), 6, glm::value_ptr(frustum.planes[0]));
+        glUniformMatrix4fv(glGetUniformLocation(cullProgram_, "viewProjection"), 1, GL_FALSE, glm::value_ptr(viewProjection));
+        glUniform1i(glGetUniformLocation(cullProgram_, "occlusion"), occlusion_ && pyramidValid_ ? 1 : 0);
+        glUniform2f(glGetUniformLocation(cullProgram_, "pyramidSize"), static_cast<float>(width_), static_cast<float>(height_));
+        glUniform1i(glGetUniformLocation(cullProgram_, "pyramid"), 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, pyramid_);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, objects.getTransformBuffer());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, objects.getBoundsBuffer());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, objects.getMeshBuffer());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, instances);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, commands);
+        glDispatchCompute((instanceCount + GPU_CULL_GROUP_SIZE - 1) / GPU_CULL_GROUP_SIZE, 1, 1);
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glUseProgram(0);
+        CMentalGLState::invalidate();
+    }
+
+    // Copies the depth of the framebuffer bound for drawing and reduces it into the pyramid
+    // the next frame tests against. Call once the occluders of this frame are drawn.
+    void buildPyramid() {
+        MENTAL_PROFILE_SCOPE("Hi-Z Build");
+        GLint viewport[4] = {};
+        GLint framebuffer = 0;
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+        if (viewport[2] <= 0 || viewport[3] <= 0) {
+            return;
+        }
+        if (viewport[2] != width_ || viewport[3] != height_) {
+            this->createTargets(viewport[2], viewport[3]);
+        }
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(framebuffer));
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, depthFramebuffer_);
+        glBlitFramebuffer(0, 0, width_, height_, 0, 0, width_, height_, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(framebuffer));
+
+        glUseProgram(pyramidProgram_);
+        glUniform1i(glGetUniformLocation(pyramidProgram_, "depth"), 0);
+        glUniform1i(glGetUniformLocation(pyramidProgram_, "source"), 1);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, depthTexture_);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, pyramid_);
+
+        GLint width = width_;
+        GLint height = height_;
+        for (GLint level = 0; level < levels_; ++level) {
+            glBindImageTexture(0, pyramid_, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+            glUniform1i(glGetUniformLocation(pyramidProgram_, "sourceLevel"), level - 1);
+            glUniform2i(glGetUniformLocation(pyramidProgram_, "destinationSize"), width, height);
+            glDispatchCompute((static_cast<GLuint>(width) + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE,
+                              (static_cast<GLuint>(height) + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE, 1);
+            glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+            width = std::max(width / 2, 1);
+            height = std::max(height / 2, 1);
+        }
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glUseProgram(0);
+        CMentalGLState::invalidate();
+        pyramidValid_ = true;
+    }
+};
+
+} // mentalsdk
@@ -0,0 +1,438 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "../Utils/Utils.hpp"
+#include "../Utils/Stats.hpp"
+#include "GLState.hpp"
+
+namespace mentalsdk
+{
+
+const uint32_t OFFSET_ALLOCATOR_NO_SPACE = 0xFFFFFFFFU;
+const uint32_t OFFSET_ALLOCATOR_BIN_COUNT = 256; // 32 exponents x 8 mantissa steps
+const uint32_t MESH_ARENA_DEFAULT_VERTICES = 1U << 20U; // 32 MB of Vertex per pool
+const uint32_t MESH_ARENA_DEFAULT_INDICES = 1U << 22U;  // 16 MB of indices per pool
+
+struct CMentalOffsetAllocation {
+    uint32_t offset = OFFSET_ALLOCATOR_NO_SPACE;
+    uint32_t node = OFFSET_ALLOCATOR_NO_SPACE;
+    uint32_t generation = 0; // Must match the node's, so a stale copy cannot free a reused range
+
+    [[nodiscard]] bool isValid() const { return offset != OFFSET_ALLOCATOR_NO_SPACE; }
+};
+
+// TLSF-style range allocator: free ranges sit in size-class bins on a small float scale
+// (3 mantissa bits), two bitmap levels find a fitting bin in O(1), and freed ranges merge
+// with free neighbours. It only hands out offsets, the memory lives elsewhere.
+class CMentalOffsetAllocator
+{
+private:
+    struct Node {
+        uint32_t offset = 0;
+        uint32_t size = 0;
+        uint32_t binPrev = OFFSET_ALLOCATOR_NO_SPACE;
+        uint32_t binNext = OFFSET_ALLOCATOR_NO_SPACE;
+        uint32_t neighborPrev = OFFSET_ALLOCATOR_NO_SPACE;
+        uint32_t neighborNext = OFFSET_ALLOCATOR_NO_SPACE;
+        uint32_t generation = 0;
+        bool used = false;
+    };
+
+    uint32_t capacity_ = 0;
+    uint32_t freeStorage_ = 0;
+    uint32_t usedBins_ = 0;        // Bit per exponent that has any non-empty bin
+    uint8_t usedLeafBins_[32] = {}; // Bit per mantissa step
+    uint32_t binHeads_[OFFSET_ALLOCATOR_BIN_COUNT] = {};
+    uint32_t generation_ = 0; // Not reset, handles from before a reset stay stale
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> freeNodes_;
+
+    static uint32_t highestBit(uint32_t value) {
+        uint32_t bit = 0;
+        while (value >>= 1U) {
+            ++bit;
+        }
+        return bit;
+    }
+
+    static uint32_t lowestBit(uint32_t value) {
+        uint32_t bit = 0;
+        while ((value & 1U) == 0) {
+            value >>= 1U;
+            ++bit;
+        }
+        return bit;
+    }
+
+    // Largest bin whose minimum size is <= size, used when filing a free range
+    static uint32_t binRoundDown(uint32_t size) {
+        if (size < 8) {
+            return size;
+        }
+        const uint32_t shift = highestBit(size) - 3;
+        return ((shift + 1) << 3U) | ((size >> shift) & 7U);
+    }
+
+    // Smallest bin whose every range is >= size, used when searching
+    static uint32_t binRoundUp(uint32_t size) {
+        if (size < 8) {
+            return size;
+        }
+        const uint32_t shift = highestBit(size) - 3;
+        uint32_t bin = ((shift + 1) << 3U) | ((size >> shift) & 7U);
+        if ((size & ((1U << shift) - 1)) != 0) {
+            ++bin;
+        }
+        return bin;
+    }
+
+    [[nodiscard]] uint32_t findBin(uint32_t minimumBin) const {
+        const uint32_t top = minimumBin >> 3U;
+        const uint32_t leafMask = usedLeafBins_[top] & (0xFFU << (minimumBin & 7U)) & 0xFFU;
+        if (leafMask != 0) {
+            return (top << 3U) | lowestBit(leafMask);
+        }
+        const uint64_t topMask = static_cast<uint64_t>(usedBins_) & (~uint64_t{ 0 } << (top + 1));
+        if (topMask == 0) {
+            return OFFSET_ALLOCATOR_NO_SPACE;
+        }
+        const uint32_t nextTop = lowestBit(static_cast<uint32_t>(topMask));
+        return (nextTop << 3U) | lowestBit(usedLeafBins_[nextTop]);
+    }
+
+    uint32_t newNode() {
+        if (!freeNodes_.empty()) {
+            const uint32_t index = freeNodes_.back();
+            freeNodes_.pop_back();
+            nodes_[index] = Node{};
+            return index;
+        }
+        nodes_.emplace_back();
+        return static_cast<uint32_t>(nodes_.size() - 1);
+    }
+
+    void insertFree(uint32_t index) {
+        Node& node = nodes_[index];
+        const uint32_t bin = binRoundDown(node.size);
+        node.used = false;
+        node.binPrev = OFFSET_ALLOCATOR_NO_SPACE;
+        node.binNext = binHeads_[bin];
+        if (node.binNext != OFFSET_ALLOCATOR_NO_SPACE) {
+            nodes_[node.binNext].binPrev = index;
+        }
+        binHeads_[bin] = index;
+        usedLeafBins_[bin >> 3U] |= static_cast<uint8_t>(1U << (bin & 7U));
+        usedBins_ |= 1U << (bin >> 3U);
+        freeStorage_ += node.size;
+    }
+
+    void removeFree(uint32_t index) {
+        Node& node = nodes_[index];
+        if (node.binPrev != OFFSET_ALLOCATOR_NO_SPACE) {
+            nodes_[node.binPrev].binNext = node.binNext;
+        } else {
+            const uint32_t bin = binRoundDown(node.size);
+            binHeads_[bin] = node.binNext;
+            if (node.binNext == OFFSET_ALLOCATOR_NO_SPACE) {
+                usedLeafBins_[bin >> 3U] &= static_cast<uint8_t>(~(1U << (bin & 7U)));
+                if (usedLeafBins_[bin >> 3U] == 0) {
+                    usedBins_ &= ~(1U << (bin >> 3U));
+                }
+            }
+        }
+        if (node.binNext != OFFSET_ALLOCATOR_NO_SPACE) {
+            nodes_[node.binNext].binPrev = node.binPrev;
+        }
+        freeStorage_ -= node.size;
+    }
+
+public:
+    explicit CMentalOffsetAllocator(uint32_t capacity = 0) { this->reset(capacity); }
+
+    void reset(uint32_t capacity) {
+        capacity_ = capacity;
+        freeStorage_ = 0;
+        usedBins_ = 0;
+        std::fill(std::begin(usedLeafBins_), std::end(usedLeafBins_), uint8_t{ 0 });
+        std::fill(std::begin(binHeads_), std::end(binHeads_), OFFSET_ALLOCATOR_NO_SPACE);
+        nodes_.clear();
+        freeNodes_.clear();
+        if (capacity > 0) {
+            const uint32_t index = this->newNode();
+            nodes_[index].size = capacity;
+            this->insertFree(index);
+        }
+    }
+
+    CMentalOffsetAllocation allocate(uint32_t size) {
+        if (size == 0 || size > freeStorage_) {
+            return {};
+        }
+        const uint32_t bin = this->findBin(binRoundUp(size));
+        if (bin == OFFSET_ALLOCATOR_NO_SPACE) {
+            return {};
+        }
+
+        const uint32_t index = binHeads_[bin];
+        this->removeFree(index);
+        Node& node = nodes_[index];
+        node.used = true;
+        node.generation = ++generation_;
+
+        // Return the tail as a new free range right after this one
+        if (node.size > size) {
+            const uint32_t remainderSize = node.size - size;
+            const uint32_t remainder = this->newNode();
+            Node& allocated = nodes_[index]; // newNode() may have grown the vector
+            nodes_[remainder].offset = allocated.offset + size;
+            nodes_[remainder].size = remainderSize;
+            nodes_[remainder].neighborPrev = index;
+            nodes_[remainder].neighborNext = allocated.neighborNext;
+            if (allocated.neighborNext != OFFSET_ALLOCATOR_NO_SPACE) {
+                nodes_[allocated.neighborNext].neighborPrev = remainder;
+            }
+            allocated.neighborNext = remainder;
+            allocated.size = size;
+            this->insertFree(remainder);
+        }
+        return { nodes_[index].offset, index, nodes_[index].generation };
+    }
+
+    void free(const CMentalOffsetAllocation& allocation) {
+        if (!this->owns(allocation)) {
+            return;
+        }
+        uint32_t index = allocation.node;
+
+        const uint32_t previous = nodes_[index].neighborPrev;
+        if (previous != OFFSET_ALLOCATOR_NO_SPACE && !nodes_[previous].used) {
+            this->removeFree(previous);
+            nodes_[previous].size += nodes_[index].size;
+            nodes_[previous].neighborNext = nodes_[index].neighborNext;
+            if (nodes_[index].neighborNext != OFFSET_ALLOCATOR_NO_SPACE) {
+                nodes_[nodes_[index].neighborNext].neighborPrev = previous;
+            }
+            nodes_[index].used = false;
+            freeNodes_.push_back(index);
+            index = previous;
+        }
+
+        const uint32_t next = nodes_[index].neighborNext;
+        if (next != OFFSET_ALLOCATOR_NO_SPACE && !nodes_[next].used) {
+            this->removeFree(next);
+            nodes_[index].size += nodes_[next].size;
+            nodes_[index].neighborNext = nodes_[next].neighborNext;
+            if (nodes_[next].neighborNext != OFFSET_ALLOCATOR_NO_SPACE) {
+                nodes_[nodes_[next].neighborNext].neighborPrev = index;
+            }
+            freeNodes_.push_back(next);
+        }
+        this->insertFree(index);
+    }
+
+    // False for handles already freed, including ones whose node has since been handed out again
+    [[nodiscard]] bool owns(const CMentalOffsetAllocation& allocation) const {
+        return allocation.isValid() && allocation.node < nodes_.size() && nodes_[allocation.node].used &&
+               nodes_[allocation.node].generation == allocation.generation;
+    }
+
+    // Capacity at which a fresh allocator is sure to fit one range of the given size
+    [[nodiscard]] static uint32_t roundUpCapacity(uint32_t size) {
+        const uint32_t bin = binRoundUp(size);
+        if (bin < 8) {
+            return bin;
+        }
+        const uint64_t capacity = static_cast<uint64_t>(8U | (bin & 7U)) << ((bin >> 3U) - 1);
+        return capacity > 0xFFFFFFFFU ? OFFSET_ALLOCATOR_NO_SPACE - 1 : static_cast<uint32_t>(capacity);
+    }
+
+    [[nodiscard]] uint32_t getCapacity() const { return capacity_; }
+    [[nodiscard]] uint32_t getFreeStorage() const { return freeStorage_; }
+};
+
+struct CMentalMeshAllocation {
+    uint32_t pool = OFFSET_ALLOCATOR_NO_SPACE;
+    uint32_t poolGeneration = 0;
+    CMentalOffsetAllocation vertices;
+    CMentalOffsetAllocation indices;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+
+    [[nodiscard]] bool isValid() const { return pool != OFFSET_ALLOCATOR_NO_SPACE; }
+    [[nodiscard]] GLint getBaseVertex() const { return static_cast<GLint>(vertices.offset); }
+    [[nodiscard]] uint32_t getFirstIndex() const { return indices.offset; }
+};
+
+// Shared vertex/index storage for every mesh in the Vertex format. Meshes are sub-allocated
+// from a few large pools, each pool has one VAO, and draws use glDrawElementsBaseVertex so
+// consecutive meshes from one pool need no VAO switch. All calls belong to the GL thread.
+class CMentalMeshArena
+{
+private:
+    struct Pool {
+        GLuint vao = 0;
+        GLuint vbo = 0;
+        GLuint ebo = 0;
+        uint32_t generation = 0; // Tells a pool apart from an earlier one at the same index
+        CMentalOffsetAllocator vertices;
+        CMentalOffsetAllocator indices;
+    };
+
+    std::vector<std::unique_ptr<Pool>> pools_;
+    uint32_t poolVertices_ = MESH_ARENA_DEFAULT_VERTICES;
+    uint32_t poolIndices_ = MESH_ARENA_DEFAULT_INDICES;
+    uint32_t poolGeneration_ = 0;
+
+    Pool& createPool(uint32_t vertexCapacity, uint32_t indexCapacity) {
+        auto pool = std::make_unique<Pool>();
+        pool->generation = ++poolGeneration_;
+        pool->vertices.reset(vertexCapacity);
+        pool->indices.reset(indexCapacity);
+
+        glGenVertexArrays(1, &pool->vao);
+        glGenBuffers(1, &pool->vbo);
+        glGenBuffers(1, &pool->ebo);
+        CMentalGLState::bindVertexArray(pool->vao);
+
+        glBindBuffer(GL_ARRAY_BUFFER, pool->vbo);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertexCapacity) * static_cast<GLsizeiptr>(sizeof(Vertex)), nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pool->ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indexCapacity) * static_cast<GLsizeiptr>(sizeof(unsigned int)), nullptr, GL_STATIC_DRAW);
+
+        // Same layout as CMentalObject::setupBuffers
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, position)));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, normal)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, texCoord)));
+        glEnableVertexAttribArray(2);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        CMentalStats::instance().addGpuMemory(MentalGpuResource::VertexBuffer, static_cast<int64_t>(vertexCapacity) * static_cast<int64_t>(sizeof(Vertex)));
+        CMentalStats::instance().addGpuMemory(MentalGpuResource::IndexBuffer, static_cast<int64_t>(indexCapacity) * static_cast<int64_t>(sizeof(unsigned int)));
+        pools_.push_back(std::move(pool));
+        return *pools_.back();
+    }
+
+    // Uploads through the copy target so no VAO's element binding is disturbed
+    static void upload(GLuint buffer, size_t offsetBytes, size_t sizeBytes, const void* data) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offsetBytes), static_cast<GLsizeiptr>(sizeBytes), data);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    bool place(uint32_t index, const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, CMentalMeshAllocation& allocation) {
+        Pool& pool = *pools_[index];
+        const auto vertexCount = static_cast<uint32_t>(vertices.size());
+        const auto indexCount = static_cast<uint32_t>(indices.size());
+        const CMentalOffsetAllocation vertexRange = pool.vertices.allocate(vertexCount);
+        if (!vertexRange.isValid()) {
+            return false;
+        }
+        const CMentalOffsetAllocation indexRange = pool.indices.allocate(indexCount);
+        if (!indexRange.isValid()) {
+            pool.vertices.free(vertexRange);
+            return false;
+        }
+        allocation.pool = index;
+        allocation.poolGeneration = pool.generation;
+        allocation.vertices = vertexRange;
+        allocation.indices = indexRange;
+        allocation.vertexCount = vertexCount;
+        allocation.indexCount = indexCount;
+        upload(pool.vbo, static_cast<size_t>(vertexRange.offset) * sizeof(Vertex), vertices.size() * sizeof(Vertex), vertices.data());
+        upload(pool.ebo, static_cast<size_t>(indexRange.offset) * sizeof(unsigned int), indices.size() * sizeof(unsigned int), indices.data());
+        return true;
+    }
+
+public:
+    explicit CMentalMeshArena(uint32_t poolVertices = MESH_ARENA_DEFAULT_VERTICES, uint32_t poolIndices = MESH_ARENA_DEFAULT_INDICES)
+    : poolVertices_(poolVertices), poolIndices_(poolIndices) {}
+    ~CMentalMeshArena() = default; // destroy() must run on the GL thread
+
+    CMentalMeshArena(const CMentalMeshArena&) = delete;
+    CMentalMeshArena& operator=(const CMentalMeshArena&) = delete;
+    CMentalMeshArena(CMentalMeshArena&&) = delete;
+    CMentalMeshArena& operator=(CMentalMeshArena&&) = delete;
+
+    // Copies the mesh into the first pool with room, opening one new pool when none has any
+    CMentalMeshAllocation allocate(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
+        CMentalMeshAllocation allocation;
+        if (vertices.empty() || indices.empty()) {
+            return allocation;
+        }
+        const auto vertexCount = static_cast<uint32_t>(vertices.size());
+        const auto indexCount = static_cast<uint32_t>(indices.size());
+
+        for (uint32_t index = 0; index < pools_.size(); ++index) {
+            if (place(index, vertices, indices, allocation)) {
+                return allocation;
+            }
+        }
+
+        // One fresh pool sized for the mesh; if even that cannot hold it nothing will
+        const auto index = static_cast<uint32_t>(pools_.size());
+        this->createPool(std::max(poolVertices_, CMentalOffsetAllocator::roundUpCapacity(vertexCount)),
+                         std::max(poolIndices_, CMentalOffsetAllocator::roundUpCapacity(indexCount)));
+        if (place(index, vertices, indices, allocation)) {
+            return allocation;
+        }
+        std::cerr << "Error: Mesh arena could not place a mesh of " << vertexCount << " vertices and " << indexCount << " indices\n";
+        return allocation;
+    }
+
+    // Clears the handle either way; stale handles from an earlier release or pool are ignored
+    void release(CMentalMeshAllocation& allocation) {
+        if (this->owns(allocation)) {
+            Pool& pool = *pools_[allocation.pool];
+            pool.vertices.free(allocation.vertices);
+            pool.indices.free(allocation.indices);
+        }
+        allocation = CMentalMeshAllocation{};
+    }
+
+    [[nodiscard]] bool owns(const CMentalMeshAllocation& allocation) const {
+        if (!allocation.isValid() || allocation.pool >= pools_.size()) {
+            return false;
+        }
+        const Pool& pool = *pools_[allocation.pool];
+        return pool.generation == allocation.poolGeneration && pool.vertices.owns(allocation.vertices) &&
+               pool.indices.owns(allocation.indices);
+    }
+
+    // Returns true when the VAO had to be switched
+    [[nodiscard]] bool bind(const CMentalMeshAllocation& allocation) const {
+        return CMentalGLState::bindVertexArray(pools_[allocation.pool]->vao);
+    }
+
+    static void draw(const CMentalMeshAllocation& allocation) {
+        glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(allocation.indexCount), GL_UNSIGNED_INT,
+                                 reinterpret_cast<void*>(static_cast<uintptr_t>(allocation.getFirstIndex()) * sizeof(unsigned int)),
+                                 allocation.getBaseVertex());
+    }
+
+    [[nodiscard]] GLuint getVertexArray(uint32_t pool) const { return pools_[pool]->vao; }
+    [[nodiscard]] GLuint getVertexBuffer(uint32_t pool) const { return pools_[pool]->vbo; }
+    [[nodiscard]] GLuint getIndexBuffer(uint32_t pool) const { return pools_[pool]->ebo; }
+    [[nodiscard]] size_t getPoolCount() const { return pools_.size(); }
+
+    void destroy() {
+        for (const auto& pool : pools_) {
+            CMentalGLState::onVertexArrayDeleted(pool->vao);
+            glDeleteVertexArrays(1, &pool->vao);
+            glDeleteBuffers(1, &pool->vbo);
+            glDeleteBuffers(1, &pool->ebo);
+            CMentalStats::instance().addGpuMemory(MentalGpuResource::VertexBuffer, -static_cast<int64_t>(pool->vertices.getCapacity()) * static_cast<int64_t>(sizeof(Vertex)));
+            CMentalStats::instance().addGpuMemory(MentalGpuResource::IndexBuffer, -static_cast<int64_t>(pool->indices.getCapacity()) * static_cast<int64_t>(sizeof(unsigned int)));
+        }
+        pools_.clear();
+    }
+};
+
+} // mentalsdk
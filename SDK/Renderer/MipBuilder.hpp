@@ -0,0 +1,300 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace mentalsdk
+{
+
+enum MentalMipFilter : uint8_t {
+    Box = 0,    // 2x2 average, the same footprint glGenerateMipmap uses on most drivers
+    Kaiser = 1, // 6-tap Kaiser-windowed sinc, keeps distant mips sharper
+};
+
+const size_t MIP_KAISER_TAPS = 6;
+const float MIP_KAISER_ALPHA = 4.0F;
+const size_t MIP_SRGB_ENCODE_STEPS = 4096;
+const size_t MIP_ROW_SLOTS = 8; // Covers the six source rows a Kaiser output row reads
+
+struct CMentalMipLevel {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels; // RGBA8
+};
+
+struct CMentalMipChain {
+    std::vector<CMentalMipLevel> levels; // Largest first
+
+    [[nodiscard]] int64_t getBytes() const {
+        int64_t bytes = 0;
+        for (const CMentalMipLevel& level : levels) {
+            bytes += static_cast<int64_t>(level.pixels.size());
+        }
+        return bytes;
+    }
+};
+
+// Builds RGBA8 mip chains on the CPU so they can be made on loader threads and come out
+// the same on every driver. Each level is filtered in linear light a few rows at a time,
+// which keeps 4K sources to a few row buffers instead of a float copy of the image.
+// With SSE2 one RGBA pixel is one register; other targets use the scalar fallback.
+class CMentalMipBuilder
+{
+private:
+#if defined(__SSE2__) || defined(_M_X64)
+    using Pixel = __m128;
+    static Pixel loadPixel(const float* source) { return _mm_loadu_ps(source); }
+    static void storePixel(float* target, Pixel value) { _mm_storeu_ps(target, value); }
+    static Pixel addPixels(Pixel lhs, Pixel rhs) { return _mm_add_ps(lhs, rhs); }
+    static Pixel scalePixel(Pixel value, float factor) { return _mm_mul_ps(value, _mm_set1_ps(factor)); }
+    static Pixel zeroPixel() { return _mm_setzero_ps(); }
+#else
+    struct Pixel {
+        float channels[4];
+    };
+    static Pixel loadPixel(const float* source) { return { { source[0], source[1], source[2], source[3] } }; }
+    static void storePixel(float* target, Pixel value) { std::copy(value.channels, value.channels + 4, target); }
+    static Pixel addPixels(Pixel lhs, Pixel rhs) {
+        return { { lhs.channels[0] + rhs.channels[0], lhs.channels[1] + rhs.channels[1],
+                   lhs.channels[2] + rhs.channels[2], lhs.channels[3] + rhs.channels[3] } };
+    }
+    static Pixel scalePixel(Pixel value, float factor) {
+        return { { value.channels[0] * factor, value.channels[1] * factor, value.channels[2] * factor, value.channels[3] * factor } };
+    }
+    static Pixel zeroPixel() { return { { 0.0F, 0.0F, 0.0F, 0.0F } }; }
+#endif
+
+    static const std::array<float, 256>& decodeTable() {
+        static const std::array<float, 256> table = [] {
+            std::array<float, 256> values{};
+            for (size_t index = 0; index < values.size(); ++index) {
+                const float value = static_cast<float>(index) / 255.0F;
+                values[index] = value <= 0.04045F ? value / 12.92F : std::pow((value + 0.055F) / 1.055F, 2.4F);
+            }
+            return values;
+        }();
+        return table;
+    }
+
+    static const std::array<uint8_t, MIP_SRGB_ENCODE_STEPS>& encodeTable() {
+        static const std::array<uint8_t, MIP_SRGB_ENCODE_STEPS> table = [] {
+            std::array<uint8_t, MIP_SRGB_ENCODE_STEPS> values{};
+            for (size_t index = 0; index < values.size(); ++index) {
+                const float value = static_cast<float>(index) / static_cast<float>(MIP_SRGB_ENCODE_STEPS - 1);
+                const float encoded = value <= 0.0031308F ? value * 12.92F : 1.055F * std::pow(value, 1.0F / 2.4F) - 0.055F;
+                values[index] = static_cast<uint8_t>(std::lround(std::clamp(encoded, 0.0F, 1.0F) * 255.0F));
+            }
+            return values;
+        }();
+        return table;
+    }
+
+    // Weights for source pixels 2x-2 .. 2x+3 of output pixel x, normalized to sum to one
+    static const std::array<float, MIP_KAISER_TAPS>& kaiserWeights() {
+        static const std::array<float, MIP_KAISER_TAPS> weights = [] {
+            const auto bessel = [](double value) { // Modified Bessel function of the first kind, order 0
+                double sum = 1.0;
+                double term = 1.0;
+                for (int step = 1; step < 32; ++step) {
+                    term *= (value / (2.0 * step)) * (value / (2.0 * step));
+                    sum += term;
+                }
+                return sum;
+            };
+            const double pi = 3.14159265358979323846;
+            const double radius = MIP_KAISER_TAPS / 2.0;
+            std::array<float, MIP_KAISER_TAPS> values{};
+            double total = 0.0;
+            for (size_t tap = 0; tap < MIP_KAISER_TAPS; ++tap) {
+                const double distance = static_cast<double>(tap) - radius + 0.5; // In source pixels from the output center
+                const double phase = pi * distance / 2.0;
+                const double sinc = std::sin(phase) / phase;
+                const double window = distance / radius;
+                const double kaiser = bessel(MIP_KAISER_ALPHA * std::sqrt(1.0 - window * window)) / bessel(MIP_KAISER_ALPHA);
+                values[tap] = static_cast<float>(sinc * kaiser);
+                total += values[tap];
+            }
+            for (float& value : values) {
+                value = static_cast<float>(value / total);
+            }
+            return values;
+        }();
+        return weights;
+    }
+
+    static void decodeRow(const uint8_t* source, size_t pixels, bool srgb, float* target) {
+        size_t index = 0;
+        if (srgb) {
+            const std::array<float, 256>& table = decodeTable();
+            for (; index < pixels; ++index) {
+                target[index * 4 + 0] = table[source[index * 4 + 0]];
+                target[index * 4 + 1] = table[source[index * 4 + 1]];
+                target[index * 4 + 2] = table[source[index * 4 + 2]];
+                target[index * 4 + 3] = static_cast<float>(source[index * 4 + 3]) / 255.0F;
+            }
+            return;
+        }
+#if defined(__SSE2__) || defined(_M_X64)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128 scale = _mm_set1_ps(1.0F / 255.0F);
+        for (; index + 4 <= pixels; index += 4) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index * 4));
+            const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+            const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+            float* out = target + index * 4;
+            _mm_storeu_ps(out + 0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), scale));
+            _mm_storeu_ps(out + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), scale));
+            _mm_storeu_ps(out + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), scale));
+            _mm_storeu_ps(out + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)), scale));
+        }
+#endif
+        for (index *= 4; index < pixels * 4; ++index) {
+            target[index] = static_cast<float>(source[index]) / 255.0F;
+        }
+    }
+
+    static void encodeRow(const float* source, size_t pixels, bool srgb, uint8_t* target) {
+        const auto quantize = [](float value, float steps) {
+            return static_cast<int>(std::clamp(value, 0.0F, 1.0F) * steps + 0.5F);
+        };
+        size_t index = 0;
+        if (srgb) {
+            const std::array<uint8_t, MIP_SRGB_ENCODE_STEPS>& table = encodeTable();
+            const float steps = static_cast<float>(MIP_SRGB_ENCODE_STEPS - 1);
+            for (; index < pixels; ++index) {
+                const float* pixel = source + index * 4;
+                target[index * 4 + 0] = table[quantize(pixel[0], steps)];
+                target[index * 4 + 1] = table[quantize(pixel[1], steps)];
+                target[index * 4 + 2] = table[quantize(pixel[2], steps)];
+                target[index * 4 + 3] = static_cast<uint8_t>(quantize(pixel[3], 255.0F));
+            }
+            return;
+        }
+#if defined(__SSE2__) || defined(_M_X64)
+        const __m128 lowest = _mm_setzero_ps();
+        const __m128 highest = _mm_set1_ps(1.0F);
+        const __m128 scale = _mm_set1_ps(255.0F);
+        const __m128 half = _mm_set1_ps(0.5F);
+        const auto convert = [&](const float* pixel) {
+            const __m128 clamped = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pixel), lowest), highest);
+            return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(clamped, scale), half));
+        };
+        for (; index + 4 <= pixels; index += 4) {
+            const float* pixel = source + index * 4;
+            const __m128i low = _mm_packs_epi32(convert(pixel), convert(pixel + 4));
+            const __m128i high = _mm_packs_epi32(convert(pixel + 8), convert(pixel + 12));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + index * 4), _mm_packus_epi16(low, high));
+        }
+#endif
+        for (index *= 4; index < pixels * 4; ++index) {
+            target[index] = static_cast<uint8_t>(quantize(source[index], 255.0F));
+        }
+    }
+
+    static void boxRow(const float* upper, const float* lower, int sourceWidth, int width, float* target) {
+        int x = 0;
+        for (; x < width; ++x) {
+            const size_t left = static_cast<size_t>(std::min(2 * x, sourceWidth - 1)) * 4;
+            const size_t right = static_cast<size_t>(std::min(2 * x + 1, sourceWidth - 1)) * 4;
+            const Pixel sum = addPixels(addPixels(loadPixel(upper + left), loadPixel(upper + right)),
+                                        addPixels(loadPixel(lower + left), loadPixel(lower + right)));
+            storePixel(target + static_cast<size_t>(x) * 4, scalePixel(sum, 0.25F));
+        }
+    }
+
+    static void kaiserRow(const float* source, int sourceWidth, int width, float* target) {
+        const std::array<float, MIP_KAISER_TAPS>& weights = kaiserWeights();
+        const int reach = static_cast<int>(MIP_KAISER_TAPS / 2) - 1;
+        for (int x = 0; x < width; ++x) {
+            Pixel sum = zeroPixel();
+            for (size_t tap = 0; tap < MIP_KAISER_TAPS; ++tap) {
+                const int column = std::clamp(2 * x - reach + static_cast<int>(tap), 0, sourceWidth - 1);
+                sum = addPixels(sum, scalePixel(loadPixel(source + static_cast<size_t>(column) * 4), weights[tap]));
+            }
+            storePixel(target + static_cast<size_t>(x) * 4, sum);
+        }
+    }
+
+    static CMentalMipLevel downsample(const CMentalMipLevel& source, MentalMipFilter filter, bool srgb) {
+        CMentalMipLevel target;
+        target.width = std::max(1, source.width / 2);
+        target.height = std::max(1, source.height / 2);
+        target.pixels.resize(static_cast<size_t>(target.width) * target.height * 4);
+
+        const size_t sourceRow = static_cast<size_t>(source.width) * 4;
+        const size_t targetRow = static_cast<size_t>(target.width) * 4;
+        std::vector<float> output(targetRow);
+
+        if (filter == Box) {
+            std::vector<float> upper(sourceRow);
+            std::vector<float> lower(sourceRow);
+            for (int y = 0; y < target.height; ++y) {
+                const int first = std::min(2 * y, source.height - 1);
+                const int second = std::min(2 * y + 1, source.height - 1);
+                decodeRow(source.pixels.data() + first * sourceRow, source.width, srgb, upper.data());
+                decodeRow(source.pixels.data() + second * sourceRow, source.width, srgb, lower.data());
+                boxRow(upper.data(), lower.data(), source.width, target.width, output.data());
+                encodeRow(output.data(), target.width, srgb, target.pixels.data() + y * targetRow);
+            }
+            return target;
+        }
+
+        // Separable: source rows are filtered horizontally once and reused by the next output rows
+        const std::array<float, MIP_KAISER_TAPS>& weights = kaiserWeights();
+        const int reach = static_cast<int>(MIP_KAISER_TAPS / 2) - 1;
+        std::vector<float> decoded(sourceRow);
+        std::vector<std::vector<float>> rows(MIP_ROW_SLOTS, std::vector<float>(targetRow));
+        std::array<int, MIP_ROW_SLOTS> tags;
+        tags.fill(-1);
+        const auto filteredRow = [&](int row) -> const float* {
+            std::vector<float>& slot = rows[static_cast<size_t>(row) % MIP_ROW_SLOTS];
+            int& tag = tags[static_cast<size_t>(row) % MIP_ROW_SLOTS];
+            if (tag != row) {
+                decodeRow(source.pixels.data() + row * sourceRow, source.width, srgb, decoded.data());
+                kaiserRow(decoded.data(), source.width, target.width, slot.data());
+                tag = row;
+            }
+            return slot.data();
+        };
+
+        std::array<const float*, MIP_KAISER_TAPS> taps{};
+        for (int y = 0; y < target.height; ++y) {
+            for (size_t tap = 0; tap < MIP_KAISER_TAPS; ++tap) {
+                taps[tap] = filteredRow(std::clamp(2 * y - reach + static_cast<int>(tap), 0, source.height - 1));
+            }
+            for (int x = 0; x < target.width; ++x) {
+                const size_t offset = static_cast<size_t>(x) * 4;
+                Pixel sum = zeroPixel();
+                for (size_t tap = 0; tap < MIP_KAISER_TAPS; ++tap) {
+                    sum = addPixels(sum, scalePixel(loadPixel(taps[tap] + offset), weights[tap]));
+                }
+                storePixel(output.data() + offset, sum);
+            }
+            encodeRow(output.data(), target.width, srgb, target.pixels.data() + y * targetRow);
+        }
+        return target;
+    }
+
+public:
+    // Takes the base level by value so callers can move decoded pixels in; safe on any thread
+    static CMentalMipChain build(std::vector<uint8_t> pixels, int width, int height, MentalMipFilter filter, bool srgb, bool mipmaps = true) {
+        CMentalMipChain chain;
+        chain.levels.push_back({ width, height, std::move(pixels) });
+        while (mipmaps && (chain.levels.back().width > 1 || chain.levels.back().height > 1)) {
+            CMentalMipLevel next = downsample(chain.levels.back(), filter, srgb);
+            chain.levels.push_back(std::move(next));
+        }
+        return chain;
+    }
+};
+
+} // mentalsdk
@@ -4,15 +4,23 @@
 #include <functional>
 #include <GL/glew.h>
 #include <iostream>
+#include <utility>
+#include "FramePacket.hpp"
 
 namespace mentalsdk
 {
 using RenderCommand = std::function<void()>;
+using FrameProducer = std::function<void(CMentalFramePacket&)>;
+using FrameConsumer = std::function<void(const CMentalFramePacket&)>;
+using FrameSync = std::function<void()>;
 
 class CMentalRenderer
 {
 private:
     std::shared_ptr<std::vector<RenderCommand>> command_pool_;
+    FrameProducer frame_producer_ = nullptr;
+    FrameConsumer frame_consumer_ = nullptr;
+    FrameSync frame_sync_ = nullptr;
 public:
     CMentalRenderer() : command_pool_(std::make_shared<std::vector<RenderCommand>>()) {
         this->initializeGL();
@@ -72,6 +80,28 @@ public:
             command();
         }
     }
+
+    // Split frame for threaded rendering: the producer runs on the simulation thread and
+    // must not touch GL, the consumer runs on the thread that owns the context
+    void setFrameStages(FrameProducer producer, FrameConsumer consumer) {
+        this->frame_producer_ = std::move(producer);
+        this->frame_consumer_ = std::move(consumer);
+    }
+
+    [[nodiscard]] bool hasFrameStages() const { return frame_producer_ && frame_consumer_; }
+    void produceFrame(CMentalFramePacket& packet) const { frame_producer_(packet); }
+    void consumeFrame(const CMentalFramePacket& packet) const { frame_consumer_(packet); }
+
+    // Once per frame at the frame boundary, on the GL thread while nothing is simulated or
+    // submitted: the place for work that needs GL and also changes the world, such as
+    // finishing loaded assets, streaming and shader hot reload
+    void setFrameSync(FrameSync sync) { this->frame_sync_ = std::move(sync); }
+    [[nodiscard]] const FrameSync& getFrameSync() const { return this->frame_sync_; }
+    void synchronizeFrame() const {
+        if (frame_sync_) {
+            frame_sync_();
+        }
+    }
 };
 
 } // namespace mentalsdk
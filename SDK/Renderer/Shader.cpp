@@ -2,10 +2,8 @@
 
 namespace mentalsdk {
 
-void CMentalShader::use() const {
-    if (programID_ != 0) {
-        glUseProgram(programID_);
-    }
+bool CMentalShader::use() const {
+    return programID_ != 0 && CMentalGLState::useProgram(programID_);
 }
 
 void CMentalShader::setMat4(const std::string& name, const glm::mat4& mat) const {
@@ -9,6 +9,8 @@
 #include <iostream>
 #include <sys/stat.h>
 #include <chrono>
+#include "GLState.hpp"
+#include "GLRelease.hpp"
 
 namespace mentalsdk
 {
@@ -72,6 +74,8 @@ private:
         return 0;
     }
     
+public:
+    // Touches no GL state, so asset loaders read sources on worker threads
     static std::string readFile(const std::string& filePath) {
         std::ifstream file(filePath);
         if (!file.is_open()) { return ""; }
@@ -81,7 +85,6 @@ private:
         return stream.str();
     }
 
-public:
     CMentalShader() = default;
     CMentalShader(const std::string& vertexPath, const std::string& fragmentPath) 
         : vertexPath_(vertexPath), fragmentPath_(fragmentPath) {
@@ -89,7 +92,10 @@ public:
     }
     ~CMentalShader() {
         if (programID_ != 0) {
-            glDeleteProgram(programID_);
+            CMentalGLReleaseQueue::instance().defer([program = programID_]() {
+                CMentalGLState::onProgramDeleted(program);
+                glDeleteProgram(program);
+            });
         }
     }
 
@@ -100,21 +106,22 @@ public:
 
     void loadFromFiles(const std::string& vertexPath, const std::string& fragmentPath) {
         std::cout << "Loading shaders: " << vertexPath << " and " << fragmentPath << "\n";
-        
-        // Store paths for hot reload
+        this->loadFromSources(vertexPath, fragmentPath, readFile(vertexPath), readFile(fragmentPath));
+    }
+
+    // Compiles sources already read from the given paths; the paths are kept for hot reload
+    bool loadFromSources(const std::string& vertexPath, const std::string& fragmentPath,
+                         const std::string& vertexData, const std::string& fragmentData) {
         vertexPath_ = vertexPath;
         fragmentPath_ = fragmentPath;
-        
-        const std::string& vertexData = this->readFile(vertexPath);
-        const std::string& fragmentData = this->readFile(fragmentPath);
-        
+
         if (vertexData.empty()) {
             std::cerr << "Error: Could not read vertex shader file: " << vertexPath << "\n";
-            return;
+            return false;
         }
         if (fragmentData.empty()) {
             std::cerr << "Error: Could not read fragment shader file: " << fragmentPath << "\n";
-            return;
+            return false;
         }
         
         std::cout << "Vertex shader loaded (" << vertexData.length() << " chars)\n";
@@ -122,6 +129,7 @@ public:
         
         // Delete old program if it exists
         if (programID_ != 0) {
+            CMentalGLState::onProgramDeleted(programID_);
             glDeleteProgram(programID_);
             programID_ = 0;
         }
@@ -137,9 +145,11 @@ public:
         } else {
             std::cerr << "Failed to create shader program\n";
         }
+        return this->isValid();
     }
 
-    void use() const;
+    // Returns true when the program actually changed
+    bool use() const;
     
     void enableHotReload(bool enable = true) { 
         hotReloadEnabled_ = enable; 
@@ -174,6 +184,8 @@ public:
     void setInt(const std::string& name, int value) const;
     
     [[nodiscard]] GLuint getProgramID() const { return programID_; }
+    [[nodiscard]] const std::string& getVertexPath() const { return vertexPath_; }
+    [[nodiscard]] const std::string& getFragmentPath() const { return fragmentPath_; }
     [[nodiscard]] bool isValid() const { return programID_ != 0; }
 };
 
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "../Utils/Profiler.hpp"
+#include "../Utils/Stats.hpp"
+
+namespace mentalsdk
+{
+
+const size_t STREAM_BUFFER_REGION_COUNT = 3; // Frames the CPU may run ahead of the GPU
+const size_t STREAM_BUFFER_DEFAULT_ALIGNMENT = 256; // Covers GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT on common drivers
+const GLuint64 STREAM_BUFFER_FENCE_TIMEOUT = 1000000; // 1 ms per wait attempt, in nanoseconds
+
+struct CMentalStreamAllocation {
+    void* data = nullptr;  // CPU-writable, valid until the region is reused
+    GLintptr offset = 0;   // Offset into getBuffer() for binding or vertex attribute pointers
+    GLsizeiptr size = 0;
+
+    [[nodiscard]] bool isValid() const { return data != nullptr; }
+};
+
+// Per-frame streaming memory. On GL 4.4 / ARB_buffer_storage the buffer is mapped once,
+// persistently and coherently, and split into frame regions guarded by fences, so any
+// thread can write straight into GPU-visible memory. Older contexts get a CPU staging copy
+// that flush() uploads with one glBufferSubData.
+//
+// Per frame: beginFrame(), allocate() from any thread, flush() once writes are done, issue
+// the draws, endFrame(). allocate() is lock-free; everything else belongs to the GL thread.
+class CMentalStreamBuffer
+{
+private:
+    GLenum target_ = GL_ARRAY_BUFFER;
+    GLuint buffer_ = 0;
+    size_t regionSize_ = 0;
+    size_t region_ = 0;
+    bool persistent_ = false;
+    unsigned char* mapped_ = nullptr;           // Whole buffer when persistent
+    std::vector<unsigned char> staging_;        // One region when not persistent
+    GLsync fences_[STREAM_BUFFER_REGION_COUNT] = {};
+    std::atomic<size_t> head_{ 0 };
+    std::atomic<uint64_t> failedAllocations_{ 0 };
+
+    [[nodiscard]] size_t totalSize() const { return regionSize_ * STREAM_BUFFER_REGION_COUNT; }
+
+    static void waitFence(GLsync& fence) {
+        if (fence == nullptr) {
+            return;
+        }
+        MENTAL_PROFILE_SCOPE("Stream Buffer Wait");
+        while (true) {
+            const GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, STREAM_BUFFER_FENCE_TIMEOUT);
+            if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+                break;
+            }
+            if (result == GL_WAIT_FAILED) {
+                std::cerr << "Error: Stream buffer fence wait failed\n";
+                break;
+            }
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+public:
+    CMentalStreamBuffer() = default;
+    ~CMentalStreamBuffer() = default; // destroy() must run on the GL thread before the context goes away
+
+    CMentalStreamBuffer(const CMentalStreamBuffer&) = delete;
+    CMentalStreamBuffer& operator=(const CMentalStreamBuffer&) = delete;
+    CMentalStreamBuffer(CMentalStreamBuffer&&) = delete;
+    CMentalStreamBuffer& operator=(CMentalStreamBuffer&&) = delete;
+
+    // regionSize is the budget of a single frame, the buffer holds three of them
+    bool create(size_t regionSize, GLenum target = GL_ARRAY_BUFFER) {
+        this->destroy();
+        target_ = target;
+        regionSize_ = (regionSize + STREAM_BUFFER_DEFAULT_ALIGNMENT - 1) / STREAM_BUFFER_DEFAULT_ALIGNMENT * STREAM_BUFFER_DEFAULT_ALIGNMENT;
+        region_ = 0;
+        head_.store(0, std::memory_order_relaxed);
+
+        glGenBuffers(1, &buffer_);
+        glBindBuffer(target_, buffer_);
+        const auto size = static_cast<GLsizeiptr>(this->totalSize());
+        persistent_ = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+        if (persistent_) {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(target_, size, nullptr, flags);
+            mapped_ = static_cast<unsigned char*>(glMapBufferRange(target_, 0, size, flags));
+            if (mapped_ == nullptr) {
+                std::cerr << "Warning: Persistent mapping failed, stream buffer falls back to uploads\n";
+                glBindBuffer(target_, 0);
+                glDeleteBuffers(1, &buffer_);
+                glGenBuffers(1, &buffer_);
+                glBindBuffer(target_, buffer_);
+                persistent_ = false;
+            }
+        }
+        if (!persistent_) {
+            glBufferData(target_, size, nullptr, GL_STREAM_DRAW);
+            staging_.resize(regionSize_);
+        }
+        glBindBuffer(target_, 0);
+
+        CMentalStats::instance().addGpuMemory(MentalGpuResource::StreamingBuffer, static_cast<int64_t>(this->totalSize()));
+        return true;
+    }
+
+    void destroy() {
+        if (buffer_ == 0) {
+            return;
+        }
+        for (GLsync& fence : fences_) {
+            if (fence != nullptr) {
+                glDeleteSync(fence);
+                fence = nullptr;
+            }
+        }
+        if (mapped_ != nullptr) {
+            glBindBuffer(target_, buffer_);
+            glUnmapBuffer(target_);
+            glBindBuffer(target_, 0);
+            mapped_ = nullptr;
+        }
+        glDeleteBuffers(1, &buffer_);
+        buffer_ = 0;
+        staging_.clear();
+        staging_.shrink_to_fit();
+        CMentalStats::instance().addGpuMemory(MentalGpuResource::StreamingBuffer, -static_cast<int64_t>(this->totalSize()));
+    }
+
+    // Moves to the next region, waiting only if the GPU still reads it from three frames ago
+    void beginFrame() {
+        region_ = (region_ + 1) % STREAM_BUFFER_REGION_COUNT;
+        waitFence(fences_[region_]);
+        head_.store(0, std::memory_order_relaxed);
+    }
+
+    // Returns an invalid allocation once the frame budget is used up
+    CMentalStreamAllocation allocate(size_t size, size_t alignment = 16) {
+        alignment = alignment == 0 ? 1 : alignment;
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t begin = 0;
+        do {
+            begin = (head + alignment - 1) / alignment * alignment;
+            if (begin + size > regionSize_) {
+                failedAllocations_.fetch_add(1, std::memory_order_relaxed);
+                return {};
+            }
+        } while (!head_.compare_exchange_weak(head, begin + size, std::memory_order_relaxed));
+
+        CMentalStreamAllocation allocation;
+        allocation.offset = static_cast<GLintptr>(region_ * regionSize_ + begin);
+        allocation.size = static_cast<GLsizeiptr>(size);
+        allocation.data = persistent_ ? mapped_ + allocation.offset : staging_.data() + begin;
+        return allocation;
+    }
+
+    // Convenience for the common copy-in case
+    CMentalStreamAllocation write(const void* data, size_t size, size_t alignment = 16) {
+        CMentalStreamAllocation allocation = this->allocate(size, alignment);
+        if (allocation.isValid()) {
+            std::memcpy(allocation.data, data, size);
+        }
+        return allocation;
+    }
+
+    // Makes this frame's writes visible to GL, call before the draws that read them.
+    // Coherent persistent memory needs nothing; the fallback uploads the staging copy.
+    void flush() {
+        const size_t used = head_.load(std::memory_order_acquire);
+        if (!persistent_ && used > 0) {
+            glBindBuffer(target_, buffer_);
+            glBufferSubData(target_, static_cast<GLintptr>(region_ * regionSize_), static_cast<GLsizeiptr>(used), staging_.data());
+            glBindBuffer(target_, 0);
+        }
+    }
+
+    // Call after every draw that reads this frame's region has been issued
+    void endFrame() {
+        fences_[region_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    [[nodiscard]] GLuint getBuffer() const { return buffer_; }
+    [[nodiscard]] GLenum getTarget() const { return target_; }
+    [[nodiscard]] bool isPersistent() const { return persistent_; }
+    [[nodiscard]] size_t getRegionSize() const { return regionSize_; }
+    [[nodiscard]] size_t getUsedBytes() const { return head_.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t getFailedAllocations() const { return failedAllocations_.load(std::memory_order_relaxed); }
+};
+
+} // mentalsdk
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace mentalsdk
+{
+
+using JobCounter = std::atomic<int>;
+using Job = std::function<void()>;
+
+const size_t DEFAULT_JOB_GRAIN_SIZE = 64;
+const auto JOB_WORKER_IDLE_TIMEOUT = std::chrono::milliseconds(2);
+
+enum MentalJobPriority : uint8_t {
+    Frame,      // Short jobs the submitter waits on, e.g. parallelFor ranges
+    Background  // Long jobs nobody waits on inline (file decodes), never run by wait()
+};
+
+// Work-stealing job system. Every worker owns a deque it pops LIFO from, idle workers
+// steal FIFO from the others. Threads that wait on a counter run jobs instead of blocking,
+// so nested parallelFor calls cannot deadlock. Background jobs sit in a separate FIFO that
+// only workers with no frame work take from, and only up to half the workers at a time,
+// so a frame never waits behind a decode.
+class CMentalJobSystem
+{
+private:
+    struct QueuedJob {
+        Job task;
+        JobCounter* counter = nullptr;
+    };
+
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<QueuedJob> jobs;
+    };
+
+    // Queue 0 is shared by all non-worker threads (main, render), workers use 1..N
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    WorkerQueue background_;
+    std::vector<std::thread> workers_;
+    std::atomic<bool> running_{ true };
+    std::atomic<int> queuedJobs_{ 0 };     // Frame jobs only
+    std::atomic<int> backgroundQueued_{ 0 };
+    std::atomic<int> backgroundRunning_{ 0 };
+    int backgroundLimit_ = 1;
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::mutex errorMutex_;
+    std::unordered_map<const JobCounter*, std::exception_ptr> errors_; // First throw per counter, rethrown by wait()
+
+    struct ThreadSlot {
+        const CMentalJobSystem* owner = nullptr;
+        size_t queue = 0;
+    };
+    static ThreadSlot& threadSlot() {
+        thread_local ThreadSlot slot;
+        return slot;
+    }
+
+    [[nodiscard]] size_t currentQueue() const {
+        const ThreadSlot& slot = threadSlot();
+        return slot.owner == this ? slot.queue : 0;
+    }
+
+    bool takeJob(size_t self, QueuedJob& job) {
+        {
+            WorkerQueue& own = *queues_[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.jobs.empty()) {
+                job = std::move(own.jobs.back());
+                own.jobs.pop_back();
+                queuedJobs_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        for (size_t offset = 1; offset < queues_.size(); ++offset) {
+            WorkerQueue& victim = *queues_[(self + offset) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.jobs.empty()) {
+                job = std::move(victim.jobs.front());
+                victim.jobs.pop_front();
+                queuedJobs_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    [[nodiscard]] bool backgroundAvailable() const {
+        return backgroundQueued_.load(std::memory_order_relaxed) > 0 &&
+               backgroundRunning_.load(std::memory_order_relaxed) < backgroundLimit_;
+    }
+
+    bool takeBackgroundJob(QueuedJob& job) {
+        // Reserve a running slot first so the limit holds under contention
+        if (backgroundRunning_.fetch_add(1, std::memory_order_acq_rel) >= backgroundLimit_) {
+            backgroundRunning_.fetch_sub(1, std::memory_order_acq_rel);
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(background_.mutex);
+        if (background_.jobs.empty()) {
+            backgroundRunning_.fetch_sub(1, std::memory_order_acq_rel);
+            return false;
+        }
+        job = std::move(background_.jobs.front());
+        background_.jobs.pop_front();
+        backgroundQueued_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // A throwing job still completes its counter, or its waiter would spin forever; the
+    // error is kept for wait() and the thread that ran the job carries on
+    void finish(QueuedJob& job) {
+        try {
+            job.task();
+        } catch (...) {
+            if (job.counter != nullptr) {
+                std::lock_guard<std::mutex> lock(errorMutex_);
+                errors_.emplace(job.counter, std::current_exception());
+            } else {
+                std::cerr << "Error: a job nobody waits on threw\n";
+            }
+        }
+        if (job.counter != nullptr) {
+            job.counter->fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    bool runOne(size_t self) {
+        QueuedJob job;
+        if (!this->takeJob(self, job)) {
+            return false;
+        }
+        this->finish(job);
+        return true;
+    }
+
+    bool runBackground() {
+        QueuedJob job;
+        if (!this->takeBackgroundJob(job)) {
+            return false;
+        }
+        this->finish(job);
+        backgroundRunning_.fetch_sub(1, std::memory_order_acq_rel);
+        wake_.notify_one(); // Another queued background job may start now
+        return true;
+    }
+
+    void workerLoop(size_t self) {
+        threadSlot() = ThreadSlot{ this, self };
+        while (running_.load(std::memory_order_acquire)) {
+            if (this->runOne(self) || this->runBackground()) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            wake_.wait_for(lock, JOB_WORKER_IDLE_TIMEOUT, [this]() {
+                return queuedJobs_.load(std::memory_order_relaxed) > 0 || this->backgroundAvailable() ||
+                       !running_.load(std::memory_order_relaxed);
+            });
+        }
+    }
+
+public:
+    // workerCount == 0 picks one worker per hardware thread besides the caller
+    explicit CMentalJobSystem(size_t workerCount = 0) {
+        if (workerCount == 0) {
+            const unsigned int hardware = std::thread::hardware_concurrency();
+            workerCount = hardware > 1 ? hardware - 1 : 0;
+        }
+        for (size_t index = 0; index <= workerCount; ++index) {
+            queues_.push_back(std::make_unique<WorkerQueue>());
+        }
+        backgroundLimit_ = static_cast<int>(std::max<size_t>(workerCount / 2, 1));
+        for (size_t index = 1; index <= workerCount; ++index) {
+            workers_.emplace_back([this, index]() { this->workerLoop(index); });
+        }
+    }
+
+    ~CMentalJobSystem() {
+        running_.store(false, std::memory_order_release);
+        wake_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    CMentalJobSystem(const CMentalJobSystem&) = delete;
+    CMentalJobSystem& operator=(const CMentalJobSystem&) = delete;
+    CMentalJobSystem(CMentalJobSystem&&) = delete;
+    CMentalJobSystem& operator=(CMentalJobSystem&&) = delete;
+
+    [[nodiscard]] size_t getWorkerCount() const { return workers_.size(); }
+    [[nodiscard]] size_t getThreadCount() const { return workers_.size() + 1; }
+
+    // Without workers background jobs run inline, nothing else would ever pick them up
+    void submit(Job task, JobCounter* counter = nullptr, MentalJobPriority priority = MentalJobPriority::Frame) {
+        if (counter != nullptr) {
+            counter->fetch_add(1, std::memory_order_relaxed);
+        }
+        if (priority == MentalJobPriority::Background) {
+            QueuedJob job{ std::move(task), counter };
+            if (workers_.empty()) {
+                this->finish(job);
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(background_.mutex);
+                background_.jobs.push_back(std::move(job));
+            }
+            backgroundQueued_.fetch_add(1, std::memory_order_relaxed);
+            wake_.notify_one();
+            return;
+        }
+        {
+            WorkerQueue& queue = *queues_[this->currentQueue()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.jobs.push_back(QueuedJob{ std::move(task), counter });
+        }
+        queuedJobs_.fetch_add(1, std::memory_order_relaxed);
+        wake_.notify_one();
+    }
+
+    // Helps running frame jobs until every job tied to the counter has finished. Background
+    // jobs are left to the workers, so waiting on one only yields. Rethrows the first
+    // exception a job tied to the counter threw, once all of them are done
+    void wait(const JobCounter& counter) {
+        const size_t self = this->currentQueue();
+        while (counter.load(std::memory_order_acquire) > 0) {
+            if (!this->runOne(self)) {
+                std::this_thread::yield();
+            }
+        }
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(errorMutex_);
+            const auto found = errors_.find(&counter);
+            if (found == errors_.end()) {
+                return;
+            }
+            error = found->second;
+            errors_.erase(found);
+        }
+        std::rethrow_exception(error);
+    }
+
+    // Splits [0, count) into grain-sized ranges and blocks until all of them ran
+    template <typename Function>
+    void parallelFor(size_t count, size_t grain, Function&& function) {
+        grain = std::max<size_t>(grain, 1);
+        if (workers_.empty() || count <= grain) {
+            if (count > 0) {
+                function(size_t{ 0 }, count);
+            }
+            return;
+        }
+
+        JobCounter counter{ 0 };
+        for (size_t begin = grain; begin < count; begin += grain) {
+            const size_t end = std::min(begin + grain, count);
+            this->submit([&function, begin, end]() { function(begin, end); }, &counter);
+        }
+        // The queued ranges reference function and counter, so they must finish before a
+        // throw from the first range leaves this frame
+        std::exception_ptr error;
+        try {
+            function(size_t{ 0 }, std::min(grain, count));
+        } catch (...) {
+            error = std::current_exception();
+        }
+        this->wait(counter);
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+} // mentalsdk
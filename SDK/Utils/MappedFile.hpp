@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mentalsdk
+{
+
+// Read-only view of a whole file. POSIX systems map it so loaders read straight from the
+// page cache; elsewhere the file is read into memory once.
+class CMentalMappedFile
+{
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<uint8_t> buffer_;
+
+public:
+    CMentalMappedFile() = default;
+    ~CMentalMappedFile() { this->close(); }
+
+    CMentalMappedFile(const CMentalMappedFile&) = delete;
+    CMentalMappedFile& operator=(const CMentalMappedFile&) = delete;
+    CMentalMappedFile(CMentalMappedFile&&) = delete;
+    CMentalMappedFile& operator=(CMentalMappedFile&&) = delete;
+
+    bool open(const std::string& filePath) {
+        this->close();
+#if defined(__linux__) || defined(__APPLE__)
+        const int descriptor = ::open(filePath.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            return false;
+        }
+        struct stat status {};
+        if (fstat(descriptor, &status) != 0 || status.st_size <= 0) {
+            ::close(descriptor);
+            return false;
+        }
+        void* mapping = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+        ::close(descriptor); // The mapping keeps the file alive
+        if (mapping == MAP_FAILED) {
+            return false;
+        }
+        data_ = static_cast<const uint8_t*>(mapping);
+        size_ = static_cast<size_t>(status.st_size);
+        mapped_ = true;
+        return true;
+#else
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+        if (!file.is_open() || file.tellg() <= 0) {
+            return false;
+        }
+        buffer_.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()))) {
+            buffer_.clear();
+            return false;
+        }
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+        return true;
+#endif
+    }
+
+    void close() {
+#if defined(__linux__) || defined(__APPLE__)
+        if (mapped_) {
+            munmap(const_cast<uint8_t*>(data_), size_);
+        }
+#endif
+        buffer_ = std::vector<uint8_t>();
+        data_ = nullptr;
+        size_ = 0;
+        mapped_ = false;
+    }
+
+    [[nodiscard]] const uint8_t* getData() const { return data_; }
+    [[nodiscard]] size_t getSize() const { return size_; }
+    [[nodiscard]] bool isOpen() const { return data_ != nullptr; }
+};
+
+// Bytes of one file handed to a loader: borrowed from a mapping that owner keeps alive, or
+// held in storage when they had to be produced (decompressed). Move-only, data follows storage
+struct CMentalFileBytes {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    std::shared_ptr<const void> owner;
+    std::vector<uint8_t> storage;
+
+    CMentalFileBytes() = default;
+    CMentalFileBytes(const CMentalFileBytes&) = delete;
+    CMentalFileBytes& operator=(const CMentalFileBytes&) = delete;
+    CMentalFileBytes(CMentalFileBytes&&) = default;
+    CMentalFileBytes& operator=(CMentalFileBytes&&) = default;
+    ~CMentalFileBytes() = default;
+
+    static CMentalFileBytes map(const std::string& filePath) {
+        CMentalFileBytes bytes;
+        auto file = std::make_shared<CMentalMappedFile>();
+        if (file->open(filePath)) {
+            bytes.data = file->getData();
+            bytes.size = file->getSize();
+            bytes.owner = std::move(file);
+        }
+        return bytes;
+    }
+
+    [[nodiscard]] bool isValid() const { return data != nullptr; }
+};
+
+} // mentalsdk
@@ -0,0 +1,357 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mentalsdk
+{
+
+const size_t PROFILER_THREAD_BUFFER_SIZE = 16384; // Events per thread between two endFrame() calls, power of two
+const size_t PROFILER_STATS_WINDOW = 120; // Frames kept for rolling statistics
+const uint64_t PROFILER_GPU_QUERY_LATENCY = 3; // Frames before a GPU query is read back
+
+struct CMentalProfileEvent {
+    const char* name = nullptr; // Must outlive the profiler, string literals in practice
+    uint64_t startNs = 0;
+    uint64_t durationNs = 0;
+};
+
+struct CMentalZoneStats {
+    std::string name;
+    bool gpu = false;
+    uint32_t calls = 0; // Calls in the last frame
+    double lastMs = 0.0; // Total time in the last frame
+    double averageMs = 0.0;
+    double minMs = 0.0;
+    double maxMs = 0.0;
+};
+
+// Frame profiler. CPU zones go to per-thread single-producer rings that the frame owner
+// drains in endFrame(); GPU zones are GL_TIME_ELAPSED queries read back a few frames later
+// so the CPU never waits on the GPU. Captures can be written as Chrome/Perfetto JSON.
+class CMentalProfiler
+{
+private:
+    struct ThreadBuffer {
+        uint32_t threadId = 0;
+        std::vector<CMentalProfileEvent> events = std::vector<CMentalProfileEvent>(PROFILER_THREAD_BUFFER_SIZE);
+        std::atomic<uint64_t> head{ 0 }; // Written by the owning thread only
+        std::atomic<uint64_t> tail{ 0 }; // Written by the collector only
+        std::atomic<uint64_t> dropped{ 0 };
+    };
+
+    struct TraceEvent {
+        CMentalProfileEvent event;
+        uint32_t threadId = 0;
+    };
+
+    struct ZoneHistory {
+        bool gpu = false;
+        uint32_t calls = 0;
+        uint64_t frameNs = 0;
+        std::vector<double> samplesMs; // Ring of per-frame totals
+        size_t next = 0;
+    };
+
+    struct GpuQuery {
+        GLuint query = 0;
+        const char* name = nullptr;
+        uint64_t startNs = 0;
+        uint64_t frame = 0;
+    };
+
+    std::atomic<bool> enabled_{ true };
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadBuffer>> threads_;
+    std::map<std::string, ZoneHistory> zones_;
+    std::atomic<uint64_t> frame_{ 0 };
+
+    bool capturing_ = false;
+    std::vector<TraceEvent> capture_;
+
+    // Touched only on the thread that owns the GL context
+    std::vector<GpuQuery> gpuPending_;
+    std::vector<GLuint> gpuFreeQueries_;
+    ThreadBuffer* gpuBuffer_ = nullptr; // Produced by the GL thread in resolveGpu()
+    GLuint gpuActiveQuery_ = 0;
+
+    CMentalProfiler() { gpuBuffer_ = this->registerThread(); }
+
+    ThreadBuffer* registerThread() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        threads_.push_back(std::make_unique<ThreadBuffer>());
+        threads_.back()->threadId = static_cast<uint32_t>(threads_.size());
+        return threads_.back().get();
+    }
+
+    ThreadBuffer* currentThreadBuffer() {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (buffer == nullptr) {
+            buffer = this->registerThread();
+        }
+        return buffer;
+    }
+
+    static void push(ThreadBuffer& buffer, const CMentalProfileEvent& event) {
+        const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+        if (head - buffer.tail.load(std::memory_order_acquire) >= PROFILER_THREAD_BUFFER_SIZE) {
+            buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        buffer.events[head & (PROFILER_THREAD_BUFFER_SIZE - 1)] = event;
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+
+    void accumulate(const CMentalProfileEvent& event, bool gpu) {
+        ZoneHistory& zone = zones_[event.name];
+        zone.gpu = gpu;
+        zone.calls += 1;
+        zone.frameNs += event.durationNs;
+    }
+
+    static void writeJsonString(std::ostream& stream, const char* text) {
+        stream << '"';
+        for (const char* character = text; *character != '\0'; ++character) {
+            if (*character == '"' || *character == '\\') {
+                stream << '\\';
+            }
+            stream << *character;
+        }
+        stream << '"';
+    }
+
+public:
+    ~CMentalProfiler() = default;
+
+    CMentalProfiler(const CMentalProfiler&) = delete;
+    CMentalProfiler& operator=(const CMentalProfiler&) = delete;
+    CMentalProfiler(CMentalProfiler&&) = delete;
+    CMentalProfiler& operator=(CMentalProfiler&&) = delete;
+
+    static CMentalProfiler& instance() {
+        static CMentalProfiler profiler;
+        return profiler;
+    }
+
+    static uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    [[nodiscard]] bool isEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    void recordCpu(const char* name, uint64_t startNs, uint64_t endNs) {
+        push(*this->currentThreadBuffer(), CMentalProfileEvent{ name, startNs, endNs - startNs });
+    }
+
+    // GPU zones use GL_TIME_ELAPSED and therefore cannot nest; inner zones are ignored
+    void beginGpu(const char* name) {
+        if (gpuActiveQuery_ != 0 || !this->isEnabled()) {
+            return;
+        }
+        GLuint query = 0;
+        if (!gpuFreeQueries_.empty()) {
+            query = gpuFreeQueries_.back();
+            gpuFreeQueries_.pop_back();
+        } else {
+            glGenQueries(1, &query);
+        }
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        gpuActiveQuery_ = query;
+        gpuPending_.push_back(GpuQuery{ query, name, now(), frame_.load(std::memory_order_relaxed) });
+    }
+
+    void endGpu() {
+        if (gpuActiveQuery_ == 0) {
+            return;
+        }
+        glEndQuery(GL_TIME_ELAPSED);
+        gpuActiveQuery_ = 0;
+    }
+
+    // Call once per frame on the GL thread, right after swapping buffers
+    void resolveGpu() {
+        const uint64_t frame = frame_.load(std::memory_order_relaxed);
+        size_t kept = 0;
+        for (const GpuQuery& pending : gpuPending_) {
+            GLint available = 0;
+            if (pending.frame + PROFILER_GPU_QUERY_LATENCY <= frame && pending.query != gpuActiveQuery_) {
+                glGetQueryObjectiv(pending.query, GL_QUERY_RESULT_AVAILABLE, &available);
+            }
+            if (available == 0) {
+                gpuPending_[kept++] = pending;
+                continue;
+            }
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(pending.query, GL_QUERY_RESULT, &elapsed);
+            push(*gpuBuffer_, CMentalProfileEvent{ pending.name, pending.startNs, static_cast<uint64_t>(elapsed) });
+            gpuFreeQueries_.push_back(pending.query);
+        }
+        gpuPending_.resize(kept);
+    }
+
+    // Drains every thread ring into the rolling statistics and the active capture
+    void endFrame() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [name, zone] : zones_) {
+            zone.calls = 0;
+            zone.frameNs = 0;
+        }
+
+        for (const auto& thread : threads_) {
+            const uint64_t head = thread->head.load(std::memory_order_acquire);
+            uint64_t tail = thread->tail.load(std::memory_order_relaxed);
+            for (; tail < head; ++tail) {
+                const CMentalProfileEvent& event = thread->events[tail & (PROFILER_THREAD_BUFFER_SIZE - 1)];
+                this->accumulate(event, thread.get() == gpuBuffer_);
+                if (capturing_) {
+                    capture_.push_back(TraceEvent{ event, thread->threadId });
+                }
+            }
+            thread->tail.store(tail, std::memory_order_release);
+        }
+
+        for (auto& [name, zone] : zones_) {
+            if (zone.samplesMs.size() < PROFILER_STATS_WINDOW) {
+                zone.samplesMs.push_back(0.0);
+                zone.next = zone.samplesMs.size() - 1;
+            }
+            zone.samplesMs[zone.next] = static_cast<double>(zone.frameNs) / 1e6;
+            zone.next = (zone.next + 1) % PROFILER_STATS_WINDOW;
+        }
+        ++frame_;
+    }
+
+    [[nodiscard]] std::vector<CMentalZoneStats> getStats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<CMentalZoneStats> stats;
+        stats.reserve(zones_.size());
+        for (const auto& [name, zone] : zones_) {
+            CMentalZoneStats entry;
+            entry.name = name;
+            entry.gpu = zone.gpu;
+            entry.calls = zone.calls;
+            entry.lastMs = static_cast<double>(zone.frameNs) / 1e6;
+            if (!zone.samplesMs.empty()) {
+                const auto [low, high] = std::minmax_element(zone.samplesMs.begin(), zone.samplesMs.end());
+                double sum = 0.0;
+                for (const double sample : zone.samplesMs) {
+                    sum += sample;
+                }
+                entry.averageMs = sum / static_cast<double>(zone.samplesMs.size());
+                entry.minMs = *low;
+                entry.maxMs = *high;
+            }
+            stats.push_back(entry);
+        }
+        return stats;
+    }
+
+    [[nodiscard]] uint64_t getDroppedEvents() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t dropped = 0;
+        for (const auto& thread : threads_) {
+            dropped += thread->dropped.load(std::memory_order_relaxed);
+        }
+        return dropped;
+    }
+
+    void beginCapture() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capture_.clear();
+        capturing_ = true;
+    }
+
+    // Writes the capture in Chrome trace event format, loadable by chrome://tracing and Perfetto
+    bool endCapture(const std::string& filePath) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capturing_ = false;
+
+        std::ofstream file(filePath);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not write profiler trace: " << filePath << "\n";
+            return false;
+        }
+
+        file << "{\"traceEvents\":[\n";
+        bool first = true;
+        for (const auto& thread : threads_) {
+            const std::string label = thread.get() == gpuBuffer_ ? "GPU" : "Thread " + std::to_string(thread->threadId);
+            file << (first ? "" : ",\n") << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << thread->threadId
+                 << R"(,"args":{"name":")" << label << "\"}}";
+            first = false;
+        }
+        for (const TraceEvent& trace : capture_) {
+            file << (first ? "" : ",\n") << "{\"name\":";
+            writeJsonString(file, trace.event.name);
+            file << R"(,"ph":"X","pid":1,"tid":)" << trace.threadId
+                 << ",\"ts\":" << static_cast<double>(trace.event.startNs) / 1e3
+                 << ",\"dur\":" << static_cast<double>(trace.event.durationNs) / 1e3 << "}";
+            first = false;
+        }
+        file << "\n]}\n";
+        capture_.clear();
+        std::cout << "Profiler trace written: " << filePath << "\n";
+        return true;
+    }
+};
+
+class CMentalProfileScope
+{
+private:
+    const char* name_;
+    uint64_t start_ = 0;
+
+public:
+    explicit CMentalProfileScope(const char* name) : name_(name) {
+        if (CMentalProfiler::instance().isEnabled()) {
+            start_ = CMentalProfiler::now();
+        }
+    }
+    ~CMentalProfileScope() {
+        if (start_ != 0) {
+            CMentalProfiler::instance().recordCpu(name_, start_, CMentalProfiler::now());
+        }
+    }
+
+    CMentalProfileScope(const CMentalProfileScope&) = delete;
+    CMentalProfileScope& operator=(const CMentalProfileScope&) = delete;
+    CMentalProfileScope(CMentalProfileScope&&) = delete;
+    CMentalProfileScope& operator=(CMentalProfileScope&&) = delete;
+};
+
+class CMentalGpuProfileScope
+{
+public:
+    explicit CMentalGpuProfileScope(const char* name) { CMentalProfiler::instance().beginGpu(name); }
+    ~CMentalGpuProfileScope() { CMentalProfiler::instance().endGpu(); }
+
+    CMentalGpuProfileScope(const CMentalGpuProfileScope&) = delete;
+    CMentalGpuProfileScope& operator=(const CMentalGpuProfileScope&) = delete;
+    CMentalGpuProfileScope(CMentalGpuProfileScope&&) = delete;
+    CMentalGpuProfileScope& operator=(CMentalGpuProfileScope&&) = delete;
+};
+
+} // mentalsdk
+
+#define MENTAL_PROFILE_CONCAT_INNER(first, second) first##second
+#define MENTAL_PROFILE_CONCAT(first, second) MENTAL_PROFILE_CONCAT_INNER(first, second)
+
+#if defined(MENTAL_PROFILER_DISABLED)
+#define MENTAL_PROFILE_SCOPE(name)
+#define MENTAL_PROFILE_GPU_SCOPE(name)
+#else
+#define MENTAL_PROFILE_SCOPE(name) const mentalsdk::CMentalProfileScope MENTAL_PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#define MENTAL_PROFILE_GPU_SCOPE(name) const mentalsdk::CMentalGpuProfileScope MENTAL_PROFILE_CONCAT(gpuProfileScope_, __LINE__)(name)
+#endif
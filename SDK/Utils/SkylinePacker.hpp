@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace mentalsdk
+{
+
+// Skyline bottom-left rectangle packer: the used area is kept as a list of horizontal
+// segments, and each rectangle goes where its top edge ends up lowest. Good fill for the
+// many similar small rectangles an atlas gets, in O(segments) per insert.
+class CMentalSkylinePacker
+{
+private:
+    struct Segment {
+        int x = 0;
+        int y = 0;
+        int width = 0;
+    };
+
+    int width_ = 0;
+    int height_ = 0;
+    std::vector<Segment> skyline_;
+    size_t usedArea_ = 0;
+
+    // Height at which a rectangle starting at segment `index` rests, or -1 when it does not fit
+    [[nodiscard]] int fitAt(size_t index, int width, int height) const {
+        if (skyline_[index].x + width > width_) {
+            return -1;
+        }
+        int remaining = width;
+        int y = 0;
+        for (size_t cursor = index; remaining > 0; ++cursor) {
+            if (cursor == skyline_.size()) {
+                return -1;
+            }
+            y = std::max(y, skyline_[cursor].y);
+            if (y + height > height_) {
+                return -1;
+            }
+            remaining -= skyline_[cursor].width;
+        }
+        return y;
+    }
+
+    void place(size_t index, int x, int y, int width, int height) {
+        skyline_.insert(skyline_.begin() + static_cast<std::ptrdiff_t>(index), Segment{ x, y + height, width });
+        // Trim or remove the segments the new one now covers
+        for (size_t cursor = index + 1; cursor < skyline_.size();) {
+            Segment& segment = skyline_[cursor];
+            const int covered = x + width - segment.x;
+            if (covered <= 0) {
+                break;
+            }
+            if (covered < segment.width) {
+                segment.x += covered;
+                segment.width -= covered;
+                break;
+            }
+            skyline_.erase(skyline_.begin() + static_cast<std::ptrdiff_t>(cursor));
+        }
+        for (size_t cursor = 0; cursor + 1 < skyline_.size();) {
+            if (skyline_[cursor].y == skyline_[cursor + 1].y) {
+                skyline_[cursor].width += skyline_[cursor + 1].width;
+                skyline_.erase(skyline_.begin() + static_cast<std::ptrdiff_t>(cursor + 1));
+            } else {
+                ++cursor;
+            }
+        }
+    }
+
+public:
+    CMentalSkylinePacker() = default;
+    CMentalSkylinePacker(int width, int height) { this->reset(width, height); }
+
+    void reset(int width, int height) {
+        width_ = width;
+        height_ = height;
+        usedArea_ = 0;
+        skyline_.assign(1, Segment{ 0, 0, width });
+    }
+
+    // Returns false when the rectangle does not fit anywhere
+    bool pack(int width, int height, int& x, int& y) {
+        if (width <= 0 || height <= 0) {
+            return false;
+        }
+        size_t bestIndex = skyline_.size();
+        int bestTop = std::numeric_limits<int>::max();
+        int bestWidth = std::numeric_limits<int>::max();
+        for (size_t index = 0; index < skyline_.size(); ++index) {
+            const int resting = this->fitAt(index, width, height);
+            if (resting < 0) {
+                continue;
+            }
+            const int top = resting + height;
+            if (top < bestTop || (top == bestTop && skyline_[index].width < bestWidth)) {
+                bestIndex = index;
+                bestTop = top;
+                bestWidth = skyline_[index].width;
+            }
+        }
+        if (bestIndex == skyline_.size()) {
+            return false;
+        }
+        x = skyline_[bestIndex].x;
+        y = bestTop - height;
+        this->place(bestIndex, x, y, width, height);
+        usedArea_ += static_cast<size_t>(width) * static_cast<size_t>(height);
+        return true;
+    }
+
+    [[nodiscard]] float getOccupancy() const {
+        return width_ > 0 && height_ > 0 ? static_cast<float>(usedArea_) / (static_cast<float>(width_) * static_cast<float>(height_)) : 0.0F;
+    }
+    [[nodiscard]] int getWidth() const { return width_; }
+    [[nodiscard]] int getHeight() const { return height_; }
+};
+
+} // mentalsdk
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mentalsdk
+{
+
+enum MentalGpuResource : uint8_t {
+    VertexBuffer = 0,
+    IndexBuffer = 1,
+    TextureMemory = 2,
+    StreamingBuffer = 3,
+};
+
+const size_t GPU_RESOURCE_TYPE_COUNT = 4;
+const size_t STATS_FRAME_HISTORY = 240; // Frame times kept for the overlay histogram
+
+inline const char* gpuResourceName(MentalGpuResource resource)
+{
+    switch (resource) {
+        case MentalGpuResource::VertexBuffer: return "Vertex buffers";
+        case MentalGpuResource::IndexBuffer: return "Index buffers";
+        case MentalGpuResource::TextureMemory: return "Textures";
+        case MentalGpuResource::StreamingBuffer: return "Streaming buffers";
+    }
+    return "Unknown";
+}
+
+struct CMentalScriptTime {
+    std::string file;
+    uint32_t objects = 0;
+    double milliseconds = 0.0;
+};
+
+// Values of one finished frame, copied out so readers never race the counters
+struct CMentalFrameStats {
+    uint64_t frameIndex = 0;
+    uint64_t drawCalls = 0;
+    uint64_t stateChanges = 0;
+    uint64_t savedBinds = 0; // Binds the GL state cache found redundant
+    uint64_t triangles = 0;
+    uint64_t visibleObjects = 0;
+    uint64_t culledObjects = 0;
+    uint64_t assetQueueDepth = 0;
+    std::array<int64_t, GPU_RESOURCE_TYPE_COUNT> gpuMemory{};
+    std::vector<CMentalScriptTime> scriptTimes;
+};
+
+// Engine-wide counters. Draw counters are bumped by the GL thread, culling and script
+// timings are published by the simulation, endFrame() turns the running values into a
+// snapshot. Everything is relaxed atomics so counting costs next to nothing.
+class CMentalStats
+{
+private:
+    std::atomic<uint64_t> drawCalls_{ 0 };
+    std::atomic<uint64_t> stateChanges_{ 0 };
+    std::atomic<uint64_t> savedBinds_{ 0 };
+    std::atomic<uint64_t> triangles_{ 0 };
+    std::atomic<uint64_t> visibleObjects_{ 0 };
+    std::atomic<uint64_t> culledObjects_{ 0 };
+    std::atomic<uint64_t> assetQueueDepth_{ 0 };
+    std::array<std::atomic<int64_t>, GPU_RESOURCE_TYPE_COUNT> gpuMemory_{};
+    std::atomic<bool> scriptTiming_{ false };
+
+    std::mutex mutex_;
+    std::vector<CMentalScriptTime> scriptTimes_;
+    CMentalFrameStats lastFrame_;
+    std::array<float, STATS_FRAME_HISTORY> frameTimes_{};
+    size_t frameCursor_ = 0;
+    uint64_t frameIndex_ = 0;
+
+    CMentalStats() = default;
+
+public:
+    ~CMentalStats() = default;
+
+    CMentalStats(const CMentalStats&) = delete;
+    CMentalStats& operator=(const CMentalStats&) = delete;
+    CMentalStats(CMentalStats&&) = delete;
+    CMentalStats& operator=(CMentalStats&&) = delete;
+
+    static CMentalStats& instance() {
+        static CMentalStats stats;
+        return stats;
+    }
+
+    void addDrawCall(uint64_t triangles) {
+        drawCalls_.fetch_add(1, std::memory_order_relaxed);
+        triangles_.fetch_add(triangles, std::memory_order_relaxed);
+    }
+    void addStateChanges(uint64_t count) { stateChanges_.fetch_add(count, std::memory_order_relaxed); }
+    void addSavedBinds(uint64_t count) { savedBinds_.fetch_add(count, std::memory_order_relaxed); }
+
+    void setCulling(uint64_t visible, uint64_t culled) {
+        visibleObjects_.store(visible, std::memory_order_relaxed);
+        culledObjects_.store(culled, std::memory_order_relaxed);
+    }
+
+    // Positive on upload, negative on release
+    void addGpuMemory(MentalGpuResource resource, int64_t bytes) {
+        gpuMemory_[resource].fetch_add(bytes, std::memory_order_relaxed);
+    }
+    [[nodiscard]] int64_t getGpuMemory(MentalGpuResource resource) const {
+        return gpuMemory_[resource].load(std::memory_order_relaxed);
+    }
+
+    void setAssetQueueDepth(uint64_t depth) { assetQueueDepth_.store(depth, std::memory_order_relaxed); }
+
+    // Per-script timing needs a clock read per object, so it only runs while someone looks
+    void setScriptTimingEnabled(bool enabled) { scriptTiming_.store(enabled, std::memory_order_relaxed); }
+    [[nodiscard]] bool isScriptTimingEnabled() const { return scriptTiming_.load(std::memory_order_relaxed); }
+
+    void setScriptTimes(std::vector<CMentalScriptTime> times) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        scriptTimes_ = std::move(times);
+    }
+
+    // Call once per presented frame on the thread that swaps buffers
+    void endFrame(float frameMs) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lastFrame_.frameIndex = frameIndex_++;
+        lastFrame_.drawCalls = drawCalls_.exchange(0, std::memory_order_relaxed);
+        lastFrame_.stateChanges = stateChanges_.exchange(0, std::memory_order_relaxed);
+        lastFrame_.savedBinds = savedBinds_.exchange(0, std::memory_order_relaxed);
+        lastFrame_.triangles = triangles_.exchange(0, std::memory_order_relaxed);
+        lastFrame_.visibleObjects = visibleObjects_.load(std::memory_order_relaxed);
+        lastFrame_.culledObjects = culledObjects_.load(std::memory_order_relaxed);
+        lastFrame_.assetQueueDepth = assetQueueDepth_.load(std::memory_order_relaxed);
+        for (size_t resource = 0; resource < GPU_RESOURCE_TYPE_COUNT; ++resource) {
+            lastFrame_.gpuMemory[resource] = gpuMemory_[resource].load(std::memory_order_relaxed);
+        }
+        if (this->isScriptTimingEnabled()) {
+            lastFrame_.scriptTimes = scriptTimes_;
+        } else {
+            lastFrame_.scriptTimes.clear();
+        }
+
+        frameTimes_[frameCursor_] = frameMs;
+        frameCursor_ = (frameCursor_ + 1) % STATS_FRAME_HISTORY;
+    }
+
+    [[nodiscard]] CMentalFrameStats getLastFrame() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return lastFrame_;
+    }
+
+    // Oldest sample first, ready to plot
+    void getFrameTimes(std::array<float, STATS_FRAME_HISTORY>& result) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::rotate_copy(frameTimes_.begin(), frameTimes_.begin() + static_cast<std::ptrdiff_t>(frameCursor_),
+                         frameTimes_.end(), result.begin());
+    }
+};
+
+} // mentalsdk
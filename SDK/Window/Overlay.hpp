@@ -0,0 +1,177 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <imgui.h>
+#include <imgui_impl_opengl3.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include "../Utils/Profiler.hpp"
+#include "../Utils/Stats.hpp"
+#include "../Renderer/GLState.hpp"
+
+namespace mentalsdk
+{
+
+const char* const OVERLAY_GLSL_VERSION = "#version 330";
+const float OVERLAY_MARGIN = 10.0F;
+const float OVERLAY_BACKGROUND_ALPHA = 0.75F;
+const float OVERLAY_HISTOGRAM_HEIGHT = 60.0F;
+const size_t OVERLAY_MAX_SCRIPT_ROWS = 8;
+
+// Read-only performance overlay drawn with ImGui on top of the frame. Only the OpenGL3
+// backend is used and display size is fed in by the window, so it can render from the
+// render thread while GLFW input stays on the main thread. Hidden, render() is one load.
+class CMentalOverlay
+{
+private:
+    std::atomic<bool> visible_{ false };
+    std::atomic<int> displayWidth_{ 0 };
+    std::atomic<int> displayHeight_{ 0 };
+
+    // Touched only on the thread that owns the GL context
+    bool initialized_ = false;
+    std::chrono::steady_clock::time_point lastRender_;
+    std::array<float, STATS_FRAME_HISTORY> frameTimes_{};
+    std::vector<CMentalZoneStats> zones_;
+
+    void initialize() {
+        IMGUI_CHECKVERSION();
+        ImGui::CreateContext();
+        ImGui::GetIO().IniFilename = nullptr;
+        ImGui::StyleColorsDark();
+        ImGui_ImplOpenGL3_Init(OVERLAY_GLSL_VERSION);
+        lastRender_ = std::chrono::steady_clock::now();
+        initialized_ = true;
+    }
+
+    static void formatBytes(const char* label, int64_t bytes) {
+        const double megabytes = static_cast<double>(bytes) / (1024.0 * 1024.0);
+        ImGui::Text("%-18s %8.2f MB", label, megabytes);
+    }
+
+    void drawWindow() {
+        CMentalStats& stats = CMentalStats::instance();
+        const CMentalFrameStats frame = stats.getLastFrame();
+        stats.getFrameTimes(frameTimes_);
+
+        float total = 0.0F;
+        float worst = 0.0F;
+        for (const float sample : frameTimes_) {
+            total += sample;
+            worst = std::max(worst, sample);
+        }
+        const float average = total / static_cast<float>(STATS_FRAME_HISTORY);
+
+        ImGui::SetNextWindowPos(ImVec2(OVERLAY_MARGIN, OVERLAY_MARGIN), ImGuiCond_Always);
+        ImGui::SetNextWindowBgAlpha(OVERLAY_BACKGROUND_ALPHA);
+        const ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize |
+                                       ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing |
+                                       ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoInputs;
+        if (!ImGui::Begin("Mental Performance", nullptr, flags)) {
+            ImGui::End();
+            return;
+        }
+
+        ImGui::Text("Frame %.2f ms avg, %.2f ms max (%.0f FPS)", average, worst, average > 0.0F ? 1000.0F / average : 0.0F);
+        ImGui::PlotHistogram("##frametimes", frameTimes_.data(), static_cast<int>(frameTimes_.size()), 0, nullptr,
+                             0.0F, std::max(worst, 1000.0F / 60.0F), ImVec2(0.0F, OVERLAY_HISTOGRAM_HEIGHT));
+
+        ImGui::Separator();
+        ImGui::Text("Draw calls      %8llu", static_cast<unsigned long long>(frame.drawCalls));
+        ImGui::Text("State changes   %8llu", static_cast<unsigned long long>(frame.stateChanges));
+        ImGui::Text("Saved binds     %8llu", static_cast<unsigned long long>(frame.savedBinds));
+        ImGui::Text("Triangles       %8llu", static_cast<unsigned long long>(frame.triangles));
+        ImGui::Text("Visible objects %8llu", static_cast<unsigned long long>(frame.visibleObjects));
+        ImGui::Text("Culled objects  %8llu", static_cast<unsigned long long>(frame.culledObjects));
+        ImGui::Text("Asset queue     %8llu", static_cast<unsigned long long>(frame.assetQueueDepth));
+
+        ImGui::Separator();
+        ImGui::TextUnformatted("GPU memory");
+        int64_t totalBytes = 0;
+        for (size_t resource = 0; resource < GPU_RESOURCE_TYPE_COUNT; ++resource) {
+            formatBytes(gpuResourceName(static_cast<MentalGpuResource>(resource)), frame.gpuMemory[resource]);
+            totalBytes += frame.gpuMemory[resource];
+        }
+        formatBytes("Total", totalBytes);
+
+        ImGui::Separator();
+        ImGui::TextUnformatted("Scripts");
+        std::vector<CMentalScriptTime> scripts = frame.scriptTimes;
+        std::sort(scripts.begin(), scripts.end(), [](const CMentalScriptTime& lhs, const CMentalScriptTime& rhs) {
+            return lhs.milliseconds > rhs.milliseconds;
+        });
+        for (size_t index = 0; index < std::min(scripts.size(), OVERLAY_MAX_SCRIPT_ROWS); ++index) {
+            ImGui::Text("%7.3f ms  x%-5u %s", scripts[index].milliseconds, scripts[index].objects, scripts[index].file.c_str());
+        }
+
+        zones_ = CMentalProfiler::instance().getStats();
+        if (!zones_.empty()) {
+            ImGui::Separator();
+            ImGui::TextUnformatted("Profiler zones");
+            for (const CMentalZoneStats& zone : zones_) {
+                ImGui::Text("%s %-20s %7.3f ms", zone.gpu ? "GPU" : "CPU", zone.name.c_str(), zone.averageMs);
+            }
+        }
+        ImGui::End();
+    }
+
+public:
+    CMentalOverlay() = default;
+    ~CMentalOverlay() = default; // GL objects are released by shutdown() on the GL thread
+
+    CMentalOverlay(const CMentalOverlay&) = delete;
+    CMentalOverlay& operator=(const CMentalOverlay&) = delete;
+    CMentalOverlay(CMentalOverlay&&) = delete;
+    CMentalOverlay& operator=(CMentalOverlay&&) = delete;
+
+    void setVisible(bool visible) {
+        visible_.store(visible, std::memory_order_relaxed);
+        CMentalStats::instance().setScriptTimingEnabled(visible);
+    }
+    void toggle() { this->setVisible(!this->isVisible()); }
+    [[nodiscard]] bool isVisible() const { return visible_.load(std::memory_order_relaxed); }
+
+    void setDisplaySize(int width, int height) {
+        displayWidth_.store(width, std::memory_order_relaxed);
+        displayHeight_.store(height, std::memory_order_relaxed);
+    }
+
+    // Call on the GL thread after the scene was drawn and before swapping buffers
+    void render() {
+        if (!this->isVisible()) {
+            return;
+        }
+        MENTAL_PROFILE_SCOPE("Overlay");
+        if (!initialized_) {
+            this->initialize();
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        ImGuiIO& io = ImGui::GetIO();
+        io.DisplaySize = ImVec2(static_cast<float>(displayWidth_.load(std::memory_order_relaxed)),
+                                static_cast<float>(displayHeight_.load(std::memory_order_relaxed)));
+        io.DeltaTime = std::max(std::chrono::duration<float>(now - lastRender_).count(), 1e-4F);
+        lastRender_ = now;
+
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui::NewFrame();
+        this->drawWindow();
+        ImGui::Render();
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        CMentalGLState::invalidate(); // The backend binds its own program, texture and VAO
+    }
+
+    void shutdown() {
+        if (!initialized_) {
+            return;
+        }
+        ImGui_ImplOpenGL3_Shutdown();
+        ImGui::DestroyContext();
+        initialized_ = false;
+    }
+};
+
+} // mentalsdk
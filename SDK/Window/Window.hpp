@@ -7,6 +7,19 @@
 #include <memory>
 #include <stdexcept>
 #include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include "../Renderer/FramePacket.hpp"
+#include "../Utils/Profiler.hpp"
+#include "../Utils/Stats.hpp"
+#include "Overlay.hpp"
+#include "../Renderer/GLDebug.hpp"
+#include "../Renderer/GLState.hpp"
+#include "../Renderer/GLRelease.hpp"
 #include "../Math/Math.hpp"
 
 namespace mentalsdk
@@ -17,6 +30,20 @@ const int DEFAULT_WINDOW_HEIGHT = 600;
 
 const int DEFAULT_GLFW_CONTEXT_VERSION_MAJOR = 3;
 const int DEFAULT_GLFW_CONTEXT_VERSION_MINOR = 3;
+const int PREFERRED_GLFW_CONTEXT_VERSION_MAJOR = 4; // Multi-draw indirect and compute, 3.3 is the fallback
+const int PREFERRED_GLFW_CONTEXT_VERSION_MINOR = 3;
+
+const int OVERLAY_TOGGLE_KEY = GLFW_KEY_F1;
+
+enum MentalWindowMode : uint8_t {
+    Windowed = 0,
+    Headless = 1, // No display needed, renders into an offscreen framebuffer
+};
+
+enum MentalImageFormat : uint8_t {
+    PPM = 0,     // Binary P6, readable by most image tools
+    RawRGBA = 1, // Tightly packed 8-bit RGBA, top row first
+};
 
 struct GLFWWindowDeleter {
     void operator()(GLFWwindow* window) const {
@@ -31,19 +58,163 @@ class CMentalWindow
 {
 private:
     std::unique_ptr<GLFWwindow, GLFWWindowDeleter> window_ = nullptr;
-    std::shared_ptr<Vector2<int>> sizes_ = mentalsdk::vec2(DEFAULT_WINDOW_WIDTH, DEFAULT_WINDOW_HEIGHT);
+    Vector2<int> sizes_ = mentalsdk::vec2(DEFAULT_WINDOW_WIDTH, DEFAULT_WINDOW_HEIGHT);
+    MentalWindowMode mode_ = MentalWindowMode::Windowed;
     std::shared_ptr<R> render_pool_ = nullptr;
+    bool threaded_rendering_ = false;
+    CMentalFrameQueue frame_queue_;
+    CMentalOverlay overlay_;
+    bool overlay_key_down_ = false;
+    std::chrono::steady_clock::time_point last_present_;
+
+    // Offscreen target used in headless mode instead of the default framebuffer
+    GLuint offscreen_framebuffer_ = 0;
+    GLuint offscreen_color_ = 0;
+    GLuint offscreen_depth_ = 0;
+
+    uint64_t frame_limit_ = 0;       // 0 runs until the window is closed
+    uint64_t frames_started_ = 0;    // Counted where frames are produced
+    uint64_t frames_presented_ = 0;  // Counted on the GL thread
+    std::string readback_path_;
+    MentalImageFormat readback_format_ = MentalImageFormat::PPM;
+    uint64_t readback_interval_ = 0; // 0 reads back only the final frame of a limited run
+
+    void runThreaded();
+
+    // Null platform first so no X11/Wayland display is required, then every context API
+    // that can live without one: EGL (surfaceless on Mesa) and OSMesa
+    GLFWwindow* createHeadlessWindow() {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        const int contextApis[] = { GLFW_EGL_CONTEXT_API, GLFW_OSMESA_CONTEXT_API, GLFW_NATIVE_CONTEXT_API };
+        for (const int contextApi : contextApis) {
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, contextApi);
+            GLFWwindow* window = glfwCreateWindow(this->sizes_.x, this->sizes_.y, "Mental Engine", nullptr, nullptr);
+            if (window != nullptr) {
+                return window;
+            }
+        }
+        return nullptr;
+    }
+
+    void createOffscreenTarget() {
+        glGenFramebuffers(1, &offscreen_framebuffer_);
+        glGenRenderbuffers(1, &offscreen_color_);
+        glGenRenderbuffers(1, &offscreen_depth_);
+
+        glBindRenderbuffer(GL_RENDERBUFFER, offscreen_color_);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, this->sizes_.x, this->sizes_.y);
+        glBindRenderbuffer(GL_RENDERBUFFER, offscreen_depth_);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, this->sizes_.x, this->sizes_.y);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, offscreen_framebuffer_);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, offscreen_color_);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, offscreen_depth_);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            throw std::runtime_error("Failed to create offscreen framebuffer");
+        }
+        glViewport(0, 0, this->sizes_.x, this->sizes_.y);
+
+        const int64_t bytes = static_cast<int64_t>(this->sizes_.x) * this->sizes_.y * 8; // RGBA8 + D24S8
+        CMentalStats::instance().addGpuMemory(MentalGpuResource::TextureMemory, bytes);
+    }
+
+    void destroyOffscreenTarget() {
+        if (offscreen_framebuffer_ == 0) {
+            return;
+        }
+        glDeleteFramebuffers(1, &offscreen_framebuffer_);
+        glDeleteRenderbuffers(1, &offscreen_color_);
+        glDeleteRenderbuffers(1, &offscreen_depth_);
+        offscreen_framebuffer_ = offscreen_color_ = offscreen_depth_ = 0;
+        const int64_t bytes = static_cast<int64_t>(this->sizes_.x) * this->sizes_.y * 8;
+        CMentalStats::instance().addGpuMemory(MentalGpuResource::TextureMemory, -bytes);
+    }
+
+    static std::string numberedPath(const std::string& path, uint64_t frame) {
+        std::string number = std::to_string(frame);
+        number.insert(0, number.size() < 6 ? 6 - number.size() : 0, '0');
+        const size_t dot = path.find_last_of('.');
+        const size_t slash = path.find_last_of("/\\");
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+            return path + "_" + number;
+        }
+        return path.substr(0, dot) + "_" + number + path.substr(dot);
+    }
+
+    // GL thread: readback if one is due, then swap (or just flush when offscreen)
+    void presentFrame() {
+        ++frames_presented_;
+        if (!readback_path_.empty()) {
+            if (readback_interval_ > 0 && frames_presented_ % readback_interval_ == 0) {
+                this->saveFramebuffer(numberedPath(readback_path_, frames_presented_), readback_format_);
+            } else if (readback_interval_ == 0 && frame_limit_ > 0 && frames_presented_ == frame_limit_) {
+                this->saveFramebuffer(readback_path_, readback_format_);
+            }
+        }
+
+        MENTAL_PROFILE_SCOPE("SwapBuffers");
+        if (mode_ == MentalWindowMode::Headless) {
+            glFlush();
+        } else {
+            this->swapBuffers();
+        }
+    }
+
+    static void framebufferSizeCallback(GLFWwindow* window, int width, int height) {
+        auto* owner = static_cast<CMentalWindow*>(glfwGetWindowUserPointer(window));
+        if (owner != nullptr) {
+            owner->overlay_.setDisplaySize(width, height);
+        }
+    }
+
+    // Main thread only, edge-triggered so holding the key does not flicker
+    void pollOverlayToggle() {
+        const bool down = glfwGetKey(this->window_.get(), OVERLAY_TOGGLE_KEY) == GLFW_PRESS;
+        if (down && !overlay_key_down_) {
+            overlay_.toggle();
+        }
+        overlay_key_down_ = down;
+    }
+
+    // GL thread, right after the swap
+    void finishFrame() {
+#if defined(MENTAL_GL_DEBUG)
+        if (!CMentalGLDebug::isInstalled()) {
+            CMentalGLDebug::checkErrors("frame");
+        }
+#endif
+        const auto now = std::chrono::steady_clock::now();
+        CMentalStats::instance().endFrame(std::chrono::duration<float, std::milli>(now - last_present_).count());
+        last_present_ = now;
+    }
 public:
-    explicit CMentalWindow() {
+    explicit CMentalWindow(MentalWindowMode mode = MentalWindowMode::Windowed,
+                           int width = DEFAULT_WINDOW_WIDTH, int height = DEFAULT_WINDOW_HEIGHT)
+    : sizes_(mentalsdk::vec2(width, height)), mode_(mode) {
+        const bool headless = mode_ == MentalWindowMode::Headless;
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+        glfwInitHint(GLFW_PLATFORM, headless ? GLFW_PLATFORM_NULL : GLFW_ANY_PLATFORM);
+#endif
         if (glfwInit() == GLFW_FALSE) {
             throw std::runtime_error("Failed to initialize GLFW");
         }
 
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, DEFAULT_GLFW_CONTEXT_VERSION_MAJOR);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, DEFAULT_GLFW_CONTEXT_VERSION_MINOR);
-        
-        GLFWwindow* window = glfwCreateWindow(this->sizes_.get()->x, this->sizes_.get()->y, 
-                                            "Mental Engine", nullptr, nullptr);
+#if defined(MENTAL_GL_DEBUG)
+        glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
+        const int contextVersions[][2] = { { PREFERRED_GLFW_CONTEXT_VERSION_MAJOR, PREFERRED_GLFW_CONTEXT_VERSION_MINOR },
+                                           { DEFAULT_GLFW_CONTEXT_VERSION_MAJOR, DEFAULT_GLFW_CONTEXT_VERSION_MINOR } };
+        GLFWwindow* window = nullptr;
+        for (const auto& version : contextVersions) {
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, version[0]);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, version[1]);
+            window = headless ? this->createHeadlessWindow()
+                              : glfwCreateWindow(this->sizes_.x, this->sizes_.y, "Mental Engine", nullptr, nullptr);
+            if (window != nullptr) {
+                break;
+            }
+        }
         if (window == nullptr) {
             const char* description = nullptr;
             int code = glfwGetError(&description);
@@ -54,16 +225,42 @@ public:
         
         window_.reset(window);
         glfwMakeContextCurrent(window);
+
+        int framebufferWidth = 0;
+        int framebufferHeight = 0;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        overlay_.setDisplaySize(framebufferWidth, framebufferHeight);
+        glfwSetWindowUserPointer(window, this);
+        glfwSetFramebufferSizeCallback(window, &CMentalWindow::framebufferSizeCallback);
         
         // Initialize GLEW after creating OpenGL context
-        if (glewInit() != GLEW_OK) {
+        const GLenum glewStatus = glewInit();
+#if defined(GLEW_ERROR_NO_GLX_DISPLAY)
+        // GLX builds of GLEW report this for EGL/OSMesa contexts even though loading succeeded
+        const bool glewLoaded = glewStatus == GLEW_OK || (headless && glewStatus == GLEW_ERROR_NO_GLX_DISPLAY);
+#else
+        const bool glewLoaded = glewStatus == GLEW_OK;
+#endif
+        if (!glewLoaded) {
             throw std::runtime_error("Failed to initialize GLEW");
         }
+#if defined(MENTAL_GL_DEBUG)
+        if (!CMentalGLDebug::install()) {
+            std::cerr << "Warning: No KHR_debug, GL errors are checked once per frame\n";
+        }
+#endif
         
+        if (headless) {
+            this->createOffscreenTarget();
+        }
         glEnable(GL_DEPTH_TEST);
     }
 
     ~CMentalWindow() {
+        if (window_ != nullptr && glfwGetCurrentContext() == window_.get()) {
+            CMentalGLReleaseQueue::instance().collect(); // Whatever died after the last frame
+            this->destroyOffscreenTarget();
+        }
         window_.reset();
         glfwTerminate();
     }
@@ -82,8 +279,10 @@ public:
     static void pollEvents() { glfwPollEvents(); }
     void swapBuffers() { glfwSwapBuffers(this->window_.get()); }
     
-    [[nodiscard]] bool shouldClose() const { return glfwWindowShouldClose(this->window_.get()) != 0;};
-    [[nodiscard]] std::shared_ptr<Vector2<int>> getWindowSize() const { return this->sizes_; }
+    [[nodiscard]] bool shouldClose() const {
+        return glfwWindowShouldClose(this->window_.get()) != 0 || (frame_limit_ > 0 && frames_started_ >= frame_limit_);
+    }
+    [[nodiscard]] Vector2<int> getWindowSize() const { return this->sizes_; }
     [[nodiscard]] GLFWwindow* getWindow() const { return this->window_.get(); }
 
     void setWindow(GLFWwindow* pWindow) { 
@@ -91,20 +290,165 @@ public:
     }
     std::shared_ptr<R> getRenderPool() { return this->render_pool_; }
     void setRenderPool(std::shared_ptr<R> render_pool) { this->render_pool_ = render_pool; }
+
+    // Hands the GL context to a dedicated render thread during run(). Needs frame stages on
+    // the render pool; GL resources must be created before run() is called.
+    void setThreadedRendering(bool enabled) { this->threaded_rendering_ = enabled; }
+    [[nodiscard]] bool isThreadedRendering() const { return this->threaded_rendering_; }
+
+    [[nodiscard]] MentalWindowMode getMode() const { return this->mode_; }
+
+    // Stops run() after this many frames, 0 runs until the window is closed
+    void setFrameLimit(uint64_t frames) { this->frame_limit_ = frames; }
+    [[nodiscard]] uint64_t getFrameLimit() const { return this->frame_limit_; }
+    [[nodiscard]] uint64_t getFramesPresented() const { return this->frames_presented_; }
+
+    // Reads frames back to disk during run(). With interval 0 only the last frame of a
+    // limited run is written, otherwise every interval-th frame gets its number appended.
+    void setReadback(const std::string& path, MentalImageFormat format = MentalImageFormat::PPM, uint64_t interval = 0) {
+        this->readback_path_ = path;
+        this->readback_format_ = format;
+        this->readback_interval_ = interval;
+    }
+
+    // Writes the current color buffer, must be called on the thread that owns the context
+    bool saveFramebuffer(const std::string& path, MentalImageFormat format = MentalImageFormat::PPM) const {
+        const int width = this->sizes_.x;
+        const int height = this->sizes_.y;
+        const size_t rowBytes = static_cast<size_t>(width) * 4;
+        std::vector<unsigned char> pixels(rowBytes * static_cast<size_t>(height));
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadBuffer(offscreen_framebuffer_ != 0 ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not write framebuffer image: " << path << "\n";
+            return false;
+        }
+        if (format == MentalImageFormat::PPM) {
+            file << "P6\n" << width << " " << height << "\n255\n";
+        }
+        // GL rows start at the bottom, images are written top row first
+        std::vector<unsigned char> row(format == MentalImageFormat::PPM ? static_cast<size_t>(width) * 3 : rowBytes);
+        for (int y = height - 1; y >= 0; --y) {
+            const unsigned char* source = pixels.data() + static_cast<size_t>(y) * rowBytes;
+            if (format == MentalImageFormat::PPM) {
+                for (int x = 0; x < width; ++x) {
+                    row[static_cast<size_t>(x) * 3 + 0] = source[x * 4 + 0];
+                    row[static_cast<size_t>(x) * 3 + 1] = source[x * 4 + 1];
+                    row[static_cast<size_t>(x) * 3 + 2] = source[x * 4 + 2];
+                }
+                file.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+            } else {
+                file.write(reinterpret_cast<const char*>(source), static_cast<std::streamsize>(rowBytes));
+            }
+        }
+        return file.good();
+    }
+
+    // Performance overlay, toggled with F1 while run() is active
+    [[nodiscard]] CMentalOverlay& getOverlay() { return this->overlay_; }
     void run();
 };
 
 template <typename R>
 void CMentalWindow<R>::run() {
+    if (threaded_rendering_ && render_pool_ && render_pool_->hasFrameStages()) {
+        this->runThreaded();
+        return;
+    }
+
+    last_present_ = std::chrono::steady_clock::now();
+    frames_started_ = 0;
+    frames_presented_ = 0;
     while (!this->shouldClose()) {
+        ++frames_started_;
+        {
+            MENTAL_PROFILE_SCOPE("Frame");
+            {
+                MENTAL_PROFILE_GPU_SCOPE("GPU Frame");
+                if (render_pool_) {
+                    render_pool_->synchronizeFrame();
+                    render_pool_->render();
+                }
+            }
+            overlay_.render();
+
+            this->pollEvents();
+            this->pollOverlayToggle();
+            this->presentFrame();
+            CMentalProfiler::instance().resolveGpu();
+            this->finishFrame();
+            CMentalGLReleaseQueue::instance().collect();
+        }
+        CMentalProfiler::instance().endFrame();
+    }
+    overlay_.shutdown();
+}
+
+template <typename R>
+void CMentalWindow<R>::runThreaded() {
+    frame_queue_.reset();
+    frames_started_ = 0;
+    frames_presented_ = 0;
+    // The first frame's sync stage runs here while the context is still on this thread,
+    // every later one on the render thread as it takes the frame before
+    const FrameSync sync = render_pool_->getFrameSync() ? FrameSync([this]() {
+        MENTAL_PROFILE_SCOPE("Frame Sync");
+        render_pool_->synchronizeFrame();
+    }) : nullptr;
+    if (sync) {
+        sync();
+    }
+    glfwMakeContextCurrent(nullptr);
 
-        if (render_pool_) {
-            render_pool_->render();
+    std::thread renderThread([this]() {
+        glfwMakeContextCurrent(this->window_.get());
+        last_present_ = std::chrono::steady_clock::now();
+        while (const CMentalFramePacket* packet = frame_queue_.acquire()) {
+            MENTAL_PROFILE_SCOPE("Render Frame");
+            {
+                MENTAL_PROFILE_GPU_SCOPE("GPU Frame");
+                render_pool_->consumeFrame(*packet);
+            }
+            overlay_.render();
+            this->presentFrame();
+            CMentalProfiler::instance().resolveGpu();
+            this->finishFrame();
+            CMentalGLReleaseQueue::instance().collect(); // Objects the simulation thread let go of
         }
+        overlay_.shutdown();
+        CMentalGLReleaseQueue::instance().collect();
+        glfwMakeContextCurrent(nullptr);
+    });
 
-        this->pollEvents();
-        this->swapBuffers();
+    const auto stopRenderThread = [this, &renderThread]() {
+        frame_queue_.stop();
+        renderThread.join();
+        glfwMakeContextCurrent(this->window_.get());
+    };
+
+    // Events stay on the main thread as GLFW requires; simulating frame N+1 here
+    // overlaps the render thread submitting frame N
+    try {
+        while (!this->shouldClose()) {
+            ++frames_started_;
+            {
+                MENTAL_PROFILE_SCOPE("Simulation Frame");
+                this->pollEvents();
+                this->pollOverlayToggle();
+                render_pool_->produceFrame(frame_queue_.getBackPacket());
+                MENTAL_PROFILE_SCOPE("Wait For Render");
+                frame_queue_.publish(sync); // Sync for the next frame runs as this one is taken
+            }
+            CMentalProfiler::instance().endFrame();
+        }
+    } catch (...) {
+        stopRenderThread();
+        throw;
     }
+    stopRenderThread();
 }
 
 } // namespace mentalsdk
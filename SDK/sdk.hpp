@@ -1,12 +1,33 @@
 #pragma once
 
 #include "Utils/Utils.hpp"
+#include "Utils/JobSystem.hpp"
+#include "Utils/MappedFile.hpp"
+#include "Utils/SkylinePacker.hpp"
 
 
 #include "Renderer/Renderer.hpp"
 #include "Renderer/Shader.hpp"
+#include "Renderer/StreamBuffer.hpp"
+#include "Renderer/GLState.hpp"
+#include "Renderer/GLRelease.hpp"
+#include "Renderer/GLDebug.hpp"
+#include "Renderer/MeshArena.hpp"
+#include "Renderer/GpuCuller.hpp"
+#include "Renderer/BatchRenderer.hpp"
+#include "Renderer/BlockCompression.hpp"
+#include "Renderer/DDS.hpp"
+#include "Renderer/MipBuilder.hpp"
 #include "Objects/Object.hpp"
+#include "Objects/MeshOptimizer.hpp"
+#include "Objects/TextureStreamer.hpp"
+#include "Objects/TextureAtlas.hpp"
 #include "Objects/World.hpp"
+#include "Assets/Archive.hpp"
+#include "Assets/AssetManager.hpp"
+#include "Assets/SceneFormat.hpp"
+#include "Assets/Scene.hpp"
+#include "Assets/WorldStreamer.hpp"
 #include "Window/Window.hpp"
 
 
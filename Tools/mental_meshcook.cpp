@@ -0,0 +1,102 @@
+#include "Assets/Archive.hpp"
+#include "Objects/Mesh.hpp"
+#include "Objects/MeshOptimizer.hpp"
+#include "Utils/MappedFile.hpp"
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Offline mesh cooker. Runs the import-time optimizations on OBJ files and writes the result
+// as INPUT.mmsh, the name the mesh loader looks for next to its source. Cooking before
+// packing puts the cooked meshes in the archive too, where the loader cannot write them.
+
+namespace
+{
+
+struct CookOptions {
+    std::string output;
+    std::vector<std::string> inputs;
+};
+
+bool cook(const std::string& input, const std::string& output)
+{
+    const mentalsdk::CMentalFileBytes bytes = mentalsdk::CMentalFileBytes::map(input);
+    mentalsdk::CMentalMeshData mesh;
+    if (!bytes.isValid() || !mesh.loadObj(bytes.data, bytes.size, input)) {
+        std::cerr << "Error: Could not load " << input << "\n";
+        return false;
+    }
+    const mentalsdk::CMentalMeshReport report = mentalsdk::CMentalMeshOptimizer::optimize(mesh);
+    const uint64_t sourceHash =
+        mentalsdk::CMentalArchiveFormat::hash(std::string_view(reinterpret_cast<const char*>(bytes.data), bytes.size));
+    if (!mesh.saveBinary(output, sourceHash, mentalsdk::MESH_BINARY_OPTIMIZED, mentalsdk::MESH_OPTIMIZER_VERSION)) {
+        std::cerr << "Error: Could not write " << output << "\n";
+        return false;
+    }
+    std::cout << input << " -> " << output << " (" << report.vertices << " -> " << report.optimizedVertices
+              << " vertices, " << mesh.indices.size() / 3 << " triangles, ACMR " << report.acmr << " -> "
+              << report.optimizedAcmr << ")\n";
+    return true;
+}
+
+void printUsage()
+{
+    std::cout << "Usage: mental_meshcook [options] INPUT...\n"
+                 "  --output FILE    output for a single input (default INPUT.mmsh)\n";
+}
+
+bool parseOptions(int argc, char** argv, CookOptions& options)
+{
+    for (int index = 1; index < argc; ++index) {
+        const std::string argument = argv[index];
+        if (argument == "--help" || argument == "-h") {
+            printUsage();
+            return false;
+        }
+        if (argument.rfind("--", 0) != 0) {
+            options.inputs.push_back(argument);
+            continue;
+        }
+        if (index + 1 >= argc) {
+            std::cerr << "Error: Missing value for " << argument << "\n";
+            return false;
+        }
+        const std::string value = argv[++index];
+        if (argument == "--output") {
+            options.output = value;
+        } else {
+            std::cerr << "Error: Unknown option " << argument << "\n";
+            printUsage();
+            return false;
+        }
+    }
+    if (options.inputs.empty()) {
+        printUsage();
+        return false;
+    }
+    if (!options.output.empty() && options.inputs.size() > 1) {
+        std::cerr << "Error: --output needs exactly one input\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    CookOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    int failures = 0;
+    for (const std::string& input : options.inputs) {
+        if (!cook(input, options.output.empty() ? input + ".mmsh" : options.output)) {
+            ++failures;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
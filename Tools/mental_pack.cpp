@@ -0,0 +1,163 @@
+#include "Assets/Archive.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Offline archive packer. Collects files into one .mpak whose entries start aligned, so the
+// runtime maps the archive once and hands stored entries to loaders without copying them.
+
+namespace
+{
+
+struct PackOptions {
+    std::string output;
+    std::string prefix;
+    uint32_t alignment = mentalsdk::ARCHIVE_DEFAULT_ALIGNMENT;
+    mentalsdk::MentalArchiveCodec codec = mentalsdk::Stored;
+    std::vector<std::string> inputs;
+};
+
+bool readFile(const std::filesystem::path& path, std::vector<uint8_t>& data)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+}
+
+// Directories contribute their files relative to themselves, single files by their name
+bool collect(const std::string& input, const std::string& prefix, std::vector<std::pair<std::string, std::filesystem::path>>& files)
+{
+    const std::filesystem::path root(input);
+    std::error_code error;
+    if (std::filesystem::is_regular_file(root, error)) {
+        files.emplace_back(prefix + root.filename().generic_string(), root);
+        return true;
+    }
+    if (!std::filesystem::is_directory(root, error)) {
+        std::cerr << "Error: " << input << " is neither a file nor a directory\n";
+        return false;
+    }
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(root, error)) {
+        if (entry.is_regular_file()) {
+            files.emplace_back(prefix + entry.path().lexically_relative(root).generic_string(), entry.path());
+        }
+    }
+    return !error;
+}
+
+void printUsage()
+{
+    std::cout << "Usage: mental_pack [options] --output FILE INPUT...\n"
+                 "  --output FILE    archive to write\n"
+                 "  --compress NAME  none, lz4 or zstd; entries that do not shrink are stored (default none)\n"
+                 "  --align N        entry alignment in bytes, a power of two (default 64)\n"
+                 "  --prefix P       prepended to every entry name, e.g. common/\n"
+                 "Directories are packed recursively with names relative to the directory.\n";
+}
+
+bool parseOptions(int argc, char** argv, PackOptions& options)
+{
+    for (int index = 1; index < argc; ++index) {
+        const std::string argument = argv[index];
+        if (argument == "--help" || argument == "-h") {
+            printUsage();
+            return false;
+        }
+        if (argument.rfind("--", 0) != 0) {
+            options.inputs.push_back(argument);
+            continue;
+        }
+        if (index + 1 >= argc) {
+            std::cerr << "Error: Missing value for " << argument << "\n";
+            return false;
+        }
+        const std::string value = argv[++index];
+        if (argument == "--output") {
+            options.output = value;
+        } else if (argument == "--prefix") {
+            options.prefix = value;
+        } else if (argument == "--align") {
+            const long alignment = std::atol(value.c_str());
+            if (alignment < 8 || alignment > 65536 || (alignment & (alignment - 1)) != 0) {
+                std::cerr << "Error: Alignment must be a power of two between 8 and 65536\n";
+                return false;
+            }
+            options.alignment = static_cast<uint32_t>(alignment);
+        } else if (argument == "--compress") {
+            if (value == "none") {
+                options.codec = mentalsdk::Stored;
+            } else if (value == "lz4") {
+                options.codec = mentalsdk::LZ4;
+            } else if (value == "zstd") {
+                options.codec = mentalsdk::Zstd;
+            } else {
+                std::cerr << "Error: Unknown compression " << value << "\n";
+                return false;
+            }
+            if (!mentalsdk::CMentalArchiveFormat::isCodecAvailable(options.codec)) {
+                std::cerr << "Error: This build has no " << value << " support\n";
+                return false;
+            }
+        } else {
+            std::cerr << "Error: Unknown option " << argument << "\n";
+            printUsage();
+            return false;
+        }
+    }
+    if (options.output.empty() || options.inputs.empty()) {
+        printUsage();
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    PackOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    std::vector<std::pair<std::string, std::filesystem::path>> files;
+    for (const std::string& input : options.inputs) {
+        if (!collect(input, options.prefix, files)) {
+            return 1;
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    mentalsdk::CMentalArchiveWriter writer;
+    for (const auto& [name, path] : files) {
+        std::vector<uint8_t> data;
+        if (!readFile(path, data)) {
+            std::cerr << "Error: Could not read " << path.string() << "\n";
+            return 1;
+        }
+        if (!writer.add(name, std::move(data), options.codec)) {
+            std::cerr << "Error: Duplicate or invalid entry name " << name << "\n";
+            return 1;
+        }
+    }
+
+    std::ofstream file(options.output, std::ios::binary);
+    if (!file.is_open() || !writer.write(file, options.alignment)) {
+        std::cerr << "Error: Could not write " << options.output << "\n";
+        return 1;
+    }
+    std::cout << options.output << ": " << writer.getEntryCount() << " entries, " << writer.getOriginalBytes() / 1024 << " KB -> "
+              << writer.getStoredBytes() / 1024 << " KB\n";
+    return 0;
+}
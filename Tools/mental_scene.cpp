@@ -0,0 +1,129 @@
+#include "Assets/SceneFormat.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Scene file inspector. Prints what a .mscn holds and how long it takes to open, exports it
+// as JSON for diffing, and can write a synthetic scene of any size to measure loading with.
+
+namespace
+{
+
+// CMentalTextureParams defaults, spelled out so the tool needs no GL headers
+const int32_t GL_REPEAT_VALUE = 0x2901;
+const int32_t GL_LINEAR_MIPMAP_LINEAR_VALUE = 0x2703;
+const int32_t GL_LINEAR_VALUE = 0x2601;
+
+struct SceneOptions {
+    std::string scene;
+    std::string json;
+    uint32_t generate = 0;
+};
+
+// A grid of static objects sharing a handful of meshes, textures and one shader
+bool generate(const std::string& path, uint32_t count)
+{
+    mentalsdk::CMentalSceneWriter writer;
+    const uint32_t shader = writer.addResource(mentalsdk::SceneShader, "common/Shaders/default_vertex.glsl",
+                                               "common/Shaders/default_fragment.glsl");
+    const uint32_t side = static_cast<uint32_t>(std::sqrt(static_cast<double>(count))) + 1;
+    for (uint32_t index = 0; index < count; ++index) {
+        mentalsdk::CMentalSceneObject object;
+        const std::string name = "Object" + std::to_string(index);
+        object.name = writer.addString(name);
+        object.node = object.name;
+        object.type = 3; // ObjModel
+        object.flags = mentalsdk::SCENE_OBJECT_STATIC;
+        object.position[0] = static_cast<float>(index % side) * 2.0F;
+        object.position[2] = static_cast<float>(index / side) * 2.0F;
+        object.mesh = writer.addResource(mentalsdk::SceneMesh, "common/Meshes/mesh" + std::to_string(index % 8) + ".obj");
+        object.texture = writer.addResource(mentalsdk::SceneTexture, "common/Textures/texture" + std::to_string(index % 16) + ".png",
+                                            {}, GL_REPEAT_VALUE, GL_LINEAR_MIPMAP_LINEAR_VALUE, GL_LINEAR_VALUE);
+        object.shader = shader;
+        writer.addObject(object);
+    }
+    return writer.write(path);
+}
+
+void printUsage()
+{
+    std::cout << "Usage: mental_scene [options] SCENE\n"
+                 "  --json FILE      export the scene as JSON, - for stdout\n"
+                 "  --generate N     first write a synthetic scene of N objects to SCENE\n";
+}
+
+bool parseOptions(int argc, char** argv, SceneOptions& options)
+{
+    for (int index = 1; index < argc; ++index) {
+        const std::string argument = argv[index];
+        if (argument == "--help" || argument == "-h") {
+            printUsage();
+            return false;
+        }
+        if (argument.rfind("--", 0) != 0) {
+            options.scene = argument;
+            continue;
+        }
+        if (index + 1 >= argc) {
+            std::cerr << "Error: Missing value for " << argument << "\n";
+            return false;
+        }
+        const std::string value = argv[++index];
+        if (argument == "--json") {
+            options.json = value;
+        } else if (argument == "--generate") {
+            options.generate = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+        } else {
+            std::cerr << "Error: Unknown option " << argument << "\n";
+            printUsage();
+            return false;
+        }
+    }
+    if (options.scene.empty()) {
+        printUsage();
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    SceneOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+    if (options.generate > 0 && !generate(options.scene, options.generate)) {
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    mentalsdk::CMentalSceneView scene;
+    if (!scene.open(options.scene)) {
+        return 1;
+    }
+    const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (options.json.empty()) {
+        std::cout << options.scene << ": " << scene.getObjectCount() << " objects, " << scene.getResourceCount()
+                  << " resources, opened in " << milliseconds << " ms\n";
+        return 0;
+    }
+    if (options.json == "-") {
+        scene.exportJson(std::cout);
+        return 0;
+    }
+    std::ofstream file(options.json);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not write " << options.json << "\n";
+        return 1;
+    }
+    scene.exportJson(file);
+    return file ? 0 : 1;
+}
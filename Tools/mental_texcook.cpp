@@ -0,0 +1,168 @@
+#include "Renderer/BlockCompression.hpp"
+#include "Renderer/DDS.hpp"
+#include "Renderer/MipBuilder.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image/stb_image.h"
+
+// Offline texture cooker. Decodes source images once, builds the full mip chain and writes
+// it block compressed into a DDS file that CMentalTexture uploads without any decoding.
+
+namespace
+{
+
+struct CookOptions {
+    std::string format = "auto";
+    mentalsdk::MentalMipFilter filter = mentalsdk::Kaiser;
+    bool srgb = false;
+    bool mipmaps = true;
+    std::string output;
+    std::vector<std::string> inputs;
+};
+
+bool hasTranslucency(const std::vector<uint8_t>& pixels)
+{
+    for (size_t index = 3; index < pixels.size(); index += 4) {
+        if (pixels[index] != 255) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool cook(const std::string& input, const std::string& output, const CookOptions& options)
+{
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    stbi_set_flip_vertically_on_load(1); // Bottom row first, like the runtime loader
+    unsigned char* pixels = stbi_load(input.c_str(), &width, &height, &channels, 4);
+    if (pixels == nullptr) {
+        std::cerr << "Error: Could not load " << input << ": " << stbi_failure_reason() << "\n";
+        return false;
+    }
+    std::vector<uint8_t> base(pixels, pixels + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(pixels);
+
+    mentalsdk::MentalBlockFormat format = mentalsdk::BC1;
+    if (options.format == "bc3" || (options.format == "auto" && hasTranslucency(base))) {
+        format = mentalsdk::BC3;
+    } else if (options.format == "bc5") {
+        format = mentalsdk::BC5;
+    }
+
+    const mentalsdk::CMentalMipChain chain =
+        mentalsdk::CMentalMipBuilder::build(std::move(base), width, height, options.filter, options.srgb, options.mipmaps);
+    std::vector<std::vector<uint8_t>> levels;
+    for (const mentalsdk::CMentalMipLevel& level : chain.levels) {
+        levels.push_back(mentalsdk::CMentalBlockCompressor::compress(level.pixels.data(), level.width, level.height, format));
+    }
+
+    std::ofstream file(output, std::ios::binary);
+    if (!file.is_open() || !mentalsdk::CMentalDDS::write(file, format, width, height, levels)) {
+        std::cerr << "Error: Could not write " << output << "\n";
+        return false;
+    }
+
+    size_t cookedBytes = 0;
+    for (const std::vector<uint8_t>& level : levels) {
+        cookedBytes += level.size();
+    }
+    const char* const names[] = { "BC1", "BC3", "BC5" };
+    std::cout << input << " -> " << output << " (" << width << "x" << height << ", " << names[format] << ", "
+              << levels.size() << " mips, " << chain.getBytes() / 1024 << " KB -> " << cookedBytes / 1024 << " KB)\n";
+    return true;
+}
+
+void printUsage()
+{
+    std::cout << "Usage: mental_texcook [options] INPUT...\n"
+                 "  --format NAME    bc1, bc3, bc5 or auto: bc3 when any texel is translucent, else bc1 (default auto)\n"
+                 "  --filter NAME    mip filter, box or kaiser (default kaiser)\n"
+                 "  --srgb 0|1       filter mips in linear space for color textures (default 0)\n"
+                 "  --mips 0|1       write the full mip chain (default 1)\n"
+                 "  --output FILE    output for a single input (default INPUT with a .dds extension)\n";
+}
+
+bool parseOptions(int argc, char** argv, CookOptions& options)
+{
+    for (int index = 1; index < argc; ++index) {
+        const std::string argument = argv[index];
+        if (argument == "--help" || argument == "-h") {
+            printUsage();
+            return false;
+        }
+        if (argument.rfind("--", 0) != 0) {
+            options.inputs.push_back(argument);
+            continue;
+        }
+        if (index + 1 >= argc) {
+            std::cerr << "Error: Missing value for " << argument << "\n";
+            return false;
+        }
+        const std::string value = argv[++index];
+        if (argument == "--format") {
+            options.format = value;
+        } else if (argument == "--filter") {
+            if (value != "box" && value != "kaiser") {
+                std::cerr << "Error: Unknown filter " << value << "\n";
+                return false;
+            }
+            options.filter = value == "box" ? mentalsdk::Box : mentalsdk::Kaiser;
+        } else if (argument == "--srgb") {
+            options.srgb = std::atoi(value.c_str()) != 0;
+        } else if (argument == "--mips") {
+            options.mipmaps = std::atoi(value.c_str()) != 0;
+        } else if (argument == "--output") {
+            options.output = value;
+        } else {
+            std::cerr << "Error: Unknown option " << argument << "\n";
+            printUsage();
+            return false;
+        }
+    }
+    if (options.format != "auto" && options.format != "bc1" && options.format != "bc3" && options.format != "bc5") {
+        std::cerr << "Error: Unknown format " << options.format << "\n";
+        return false;
+    }
+    if (options.inputs.empty()) {
+        printUsage();
+        return false;
+    }
+    if (!options.output.empty() && options.inputs.size() > 1) {
+        std::cerr << "Error: --output needs exactly one input\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    CookOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    int failures = 0;
+    for (const std::string& input : options.inputs) {
+        const std::string output = options.output.empty()
+                                       ? std::filesystem::path(input).replace_extension(".dds").string()
+                                       : options.output;
+        if (!cook(input, output, options)) {
+            ++failures;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}